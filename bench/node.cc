@@ -10,6 +10,10 @@
 #include <sstream>
 #include "xpbase/base/top_string_util.h"
 #include "xpbase/base/endpoint_util.h"
+#include "xkad/routing_table/lock_stats.h"
+#include "xkad/routing_table/heartbeat_state.h"
+#include "xkad/routing_table/hop_trace.h"
+#include "xkad/routing_table/memory_stats.h"
 
 namespace top {
 namespace kadmlia {
@@ -118,6 +122,36 @@ bool MyRoutingTable::Init(const std::string& name_prefix, const std::string& sup
         auto cb = std::bind(&MyRoutingTable::OnCommandAutoTest, this, _1);
         BenchCommand::Instance()->RegisterCommand("autotest", cb);
     }
+    {
+        using namespace std::placeholders;
+        auto cb = std::bind(&MyRoutingTable::OnCommandLockStats, this, _1);
+        BenchCommand::Instance()->RegisterCommand("lockstats", cb);
+    }
+    {
+        using namespace std::placeholders;
+        auto cb = std::bind(&MyRoutingTable::OnCommandTraffic, this, _1);
+        BenchCommand::Instance()->RegisterCommand("traffic", cb);
+    }
+    {
+        using namespace std::placeholders;
+        auto cb = std::bind(&MyRoutingTable::OnCommandRpcStats, this, _1);
+        BenchCommand::Instance()->RegisterCommand("rpcstats", cb);
+    }
+    {
+        using namespace std::placeholders;
+        auto cb = std::bind(&MyRoutingTable::OnCommandHopTrace, this, _1);
+        BenchCommand::Instance()->RegisterCommand("hoptrace", cb);
+    }
+    {
+        using namespace std::placeholders;
+        auto cb = std::bind(&MyRoutingTable::OnCommandRoutingEvents, this, _1);
+        BenchCommand::Instance()->RegisterCommand("rtevents", cb);
+    }
+    {
+        using namespace std::placeholders;
+        auto cb = std::bind(&MyRoutingTable::OnCommandMemStats, this, _1);
+        BenchCommand::Instance()->RegisterCommand("memstats", cb);
+    }
 
     return true;
 }
@@ -583,6 +617,65 @@ void MyRoutingTable::OnCommandRtsize(const BenchCommand::Arguments& args) {
     TOP_FATAL("last rt_diff_count: %d", rt_diff_count_);
 }
 
+void MyRoutingTable::OnCommandLockStats(const BenchCommand::Arguments& args) {
+    if (args.size() >= 1 && args[0] == "reset") {
+        LockStats::Instance()->Reset();
+        TOP_FATAL("lock stats reset");
+        return;
+    }
+
+#ifndef XKAD_LOCK_STATS
+    TOP_FATAL("lock stats disabled, build with -DXKAD_LOCK_STATS=ON");
+#endif
+    std::cout << LockStats::Instance()->Dump() << std::endl;
+}
+
+void MyRoutingTable::OnCommandTraffic(const BenchCommand::Arguments& args) {
+    if (args.size() >= 1 && args[0] == "reset") {
+        HeartbeatState::Instance()->Reset();
+        TOP_FATAL("traffic stats reset");
+        return;
+    }
+
+    std::cout << HeartbeatState::Instance()->Dump() << std::endl;
+}
+
+void MyRoutingTable::OnCommandRpcStats(const BenchCommand::Arguments& args) {
+    auto& rpc_stats = CallbackManager::Instance()->rpc_stats();
+    if (args.size() >= 1 && args[0] == "reset") {
+        rpc_stats.Reset();
+        TOP_FATAL("rpc stats reset");
+        return;
+    }
+
+    std::cout << rpc_stats.Dump() << std::endl;
+}
+
+void MyRoutingTable::OnCommandHopTrace(const BenchCommand::Arguments& args) {
+    if (args.size() >= 1) {
+        int one_in = ParseArg(args[0], 0);
+        HopTracer::Instance()->set_sample_rate(std::max(one_in, 0));
+        TOP_FATAL("hop trace one message in %d(0: off)", std::max(one_in, 0));
+        return;
+    }
+
+    std::cout << HopTracer::Instance()->Dump() << std::endl;
+}
+
+void MyRoutingTable::OnCommandRoutingEvents(const BenchCommand::Arguments& args) {
+    std::cout << routing_events()->Dump() << std::endl;
+}
+
+void MyRoutingTable::OnCommandMemStats(const BenchCommand::Arguments& args) {
+    if (args.size() >= 1 && args[0] == "reset") {
+        MemoryStats::Instance()->ResetPeaks();
+        TOP_FATAL("memory high-water marks reset");
+        return;
+    }
+
+    std::cout << MemoryStats::Instance()->Dump() << std::endl;
+}
+
 int MyRoutingTable::ParseArg(const std::string& arg, int default_value) {
     int value = default_value;
     try {
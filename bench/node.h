@@ -157,6 +157,24 @@ public:
     bool AutoTestAllGetrt2();
     void SleepWait(int seconds);
 
+    // ---------------- lockstats
+    void OnCommandLockStats(const BenchCommand::Arguments& args);
+
+    // ---------------- traffic
+    void OnCommandTraffic(const BenchCommand::Arguments& args);
+
+    // ---------------- rpcstats
+    void OnCommandRpcStats(const BenchCommand::Arguments& args);
+
+    // ---------------- hoptrace
+    void OnCommandHopTrace(const BenchCommand::Arguments& args);
+
+    // ---------------- rtevents
+    void OnCommandRoutingEvents(const BenchCommand::Arguments& args);
+
+    // ---------------- memstats
+    void OnCommandMemStats(const BenchCommand::Arguments& args);
+
 private:
     std::string GetDumpNodes(std::vector<NodeInfoPtr> nodes, int max_detail);  // columns: id/dis/pub/local/nat(3.3KB)
     std::string GetDumpNodesSimple(std::vector<NodeInfoPtr> nodes, int max_detail);  // columns: id/dis(1.16KB)
@@ -3,10 +3,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #pragma once
+#include <atomic>
+
 #include "xpbase/base/contain_template.h"
 #include "xtransport/proto/transport.pb.h"
 #include "xkad/proto/kadmlia.pb.h"
 #include "xkad/gossip/rumor_def.h"
+#include "xkad/routing_table/memory_stats.h"
 
 namespace top {
 namespace gossip {
@@ -18,11 +21,16 @@ class RumorFilter :
     kRepeatedValueNum>{
 public:
     static RumorFilter* Instance();
-    ~RumorFilter() {}
+    ~RumorFilter();
     bool FiltMessage(
         transport::protobuf::RoutingMessage&);
+    // the slots are sized for kDefaultFilterSize values up front
+    void GetMemoryUsage(kadmlia::MemoryUsage& usage);
 private:
-    RumorFilter() {}
+    RumorFilter();
+
+    std::atomic<uint64_t> added_count_{0};
+    uint32_t memory_reporter_id_{0};
 };
 
 typedef std::shared_ptr<RumorFilter> RumorFilterPtr;
@@ -6,12 +6,15 @@
 
 #include <mutex>
 #include <vector>
+#include <map>
+#include <string>
 
 #include "xkad/proto/kadmlia.pb.h"
 #include "xkad/gossip/rumor_message_manager.h"
 #include "xkad/gossip/rumor_def.h"
 #include "xkad/routing_table/node_info.h"
 #include "xkad/routing_table/local_node_info.h"
+#include "xkad/routing_table/node_event.h"
 
 namespace top {
 
@@ -28,13 +31,17 @@ public:
         :inited_(false),
         just_root_(false),
         kad_routing_table_(),
-        message_manager_ptr_(std::make_shared<RumorMessageManager>()) {}
+        message_manager_ptr_(std::make_shared<RumorMessageManager>()),
+        neighbors_(),
+        node_events_subscription_(0) {}
 
     RumorHandler(bool just_root)
         :inited_(false),
          just_root_(just_root),
          kad_routing_table_(),
-         message_manager_ptr_(std::make_shared<RumorMessageManager>()) {}
+         message_manager_ptr_(std::make_shared<RumorMessageManager>()),
+         neighbors_(),
+         node_events_subscription_(0) {}
     ~RumorHandler() {}
     bool Init(
         kadmlia::RoutingTablePtr);
@@ -57,13 +64,22 @@ public:
     void SpreadNeighborsRapid(
         transport::protobuf::RoutingMessage&);
     void SpreadNeighborsSelfMessage();
+    // from a view kept by the routing table's node events, not a copy of its nodes
     void GetAllNeighborNodes(
         std::vector<kadmlia::NodeInfoPtr>&);
 private:
+    void OnNodeEvent(const kadmlia::NodeEvent& event);
+    // root nodes only if just_root_
+    bool IsNeighbor(kadmlia::NodeInfoPtr node);
+    void ResyncNeighbors();
+
     bool inited_;
     bool just_root_;
     kadmlia::RoutingTablePtr kad_routing_table_;
     RumorMessageManagerSptr message_manager_ptr_;
+    std::map<std::string, kadmlia::NodeInfoPtr> neighbors_;  // node id -> node
+    std::mutex neighbors_mutex_;
+    uint32_t node_events_subscription_;
 
     DISALLOW_COPY_AND_ASSIGN(RumorHandler);
 };
@@ -0,0 +1,314 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <assert.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <iostream>
+
+#include "xpbase/base/top_log.h"
+#include "xpbase/base/top_config.h"
+#include "xpbase/base/args_parser.h"
+#include "xpbase/base/line_parser.h"
+#include "xpbase/base/uint64_bloomfilter.h"
+#include "xpbase/base/kad_key/get_kadmlia_key.h"
+#include "xkad/routing_table/routing_utils.h"
+#include "xkad/nat_detect/nat_manager_intf.h"
+#include "xkad/proto/kadmlia.pb.h"
+#include "micro_harness.h"
+#include "micro_table.h"
+
+using namespace top::kadmlia;
+using namespace top::kadmlia::test;
+
+namespace top {
+    uint32_t gloabl_platform_type = kPlatform;
+    std::shared_ptr<top::base::KadmliaKey> global_xid;
+    std::string global_node_id = RandomString(kNodeIdSize);
+    std::string global_node_id_hash("");
+}
+
+static const uint32_t kMicroTargets = 1024;  // random target ids, reused round robin
+static const uint32_t kMicroCandidates = 256;  // nodes not in the table, per thread
+static const uint32_t kMicroWriterNodes = 64;
+
+struct MicroOptions {
+    std::vector<uint32_t> sizes{ 16, 64, 256, 1024, 4096 };
+    uint32_t max_threads{ 4 };
+    uint64_t min_time_ms{ 200 };
+    std::string filter;
+    bool writer{ false };  // readers run next to a thread adding and dropping nodes
+    uint32_t seed{ 1 };
+};
+
+// the cases of one table size
+class MicroCases {
+public:
+    MicroCases(const MicroOptions& options, MicroTable& table)
+            : options_(options), table_(table), harness_(options.min_time_ms) {}
+    void Run();
+
+private:
+    bool Selected(const std::string& name) {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+    // 1, 2, 4 .. max_threads
+    void RunReader(const std::string& name, MicroOp op);
+    void RunWriter(const std::string& name, MicroOp op);
+    void WriterLoop(std::atomic<bool>& stop);
+    void FindNodesResponse(const std::string& target_id, std::string& data);
+
+    const MicroOptions& options_;
+    MicroTable& table_;
+    MicroHarness harness_;
+    std::vector<std::string> targets_;
+    std::vector<std::vector<NodeInfoPtr>> candidates_;  // per thread
+    std::vector<NodeInfoPtr> writer_nodes_;
+    std::vector<uint64_t> bloomfilter_;
+};
+
+void MicroCases::Run() {
+    auto rt = table_.routing_table();
+    for (uint32_t i = 0; i < kMicroTargets; ++i) {
+        targets_.push_back(table_.RandomId());
+    }
+    candidates_.resize(options_.max_threads);
+    for (auto& thread_candidates : candidates_) {
+        for (uint32_t i = 0; i < kMicroCandidates; ++i) {
+            thread_candidates.push_back(table_.NewNode());
+        }
+    }
+    for (uint32_t i = 0; i < kMicroWriterNodes; ++i) {
+        writer_nodes_.push_back(table_.NewNode());
+    }
+    rt->GetExistsNodesBloomfilter(table_.nodes(), bloomfilter_);
+
+    RunReader("GetClosestNodes", [this, rt](MicroState& state, uint64_t iteration) {
+        rt->GetClosestNodes(targets_[iteration % kMicroTargets], kKadParamK);
+    });
+    RunReader("ClosestToTarget", [this, rt](MicroState& state, uint64_t iteration) {
+        bool closest = false;
+        rt->ClosestToTarget(targets_[iteration % kMicroTargets], closest);
+    });
+    RunReader("GetRangeNodes", [rt](MicroState& state, uint64_t iteration) {
+        std::vector<NodeInfoPtr> nodes;
+        rt->GetRangeNodes(0u, (uint32_t)(kNodeIdSize * 8), nodes);
+    });
+    RunReader("GetExistsNodesBloomfilter", [this, rt](MicroState& state, uint64_t iteration) {
+        std::vector<uint64_t> bloomfilter;
+        rt->GetExistsNodesBloomfilter(table_.nodes(), bloomfilter);
+    });
+    RunReader("IsNewNodeCandidate", [this, rt](MicroState& state, uint64_t iteration) {
+        NodeInfoPtr node = candidates_[state.thread_index()][iteration % kMicroCandidates];
+        rt->IsNewNodeCandidate(node->node_id, node->nat_type);
+    });
+    RunReader("SetNodeBucket", [this, rt](MicroState& state, uint64_t iteration) {
+        rt->SetNodeBucket(candidates_[state.thread_index()][iteration % kMicroCandidates]);
+    });
+
+    // what HandleFindNodesRequest/Response do besides the routing table calls
+    RunReader("FindNodesRequestSerialize", [this, rt](MicroState& state, uint64_t iteration) {
+        protobuf::FindClosestNodesRequest find_nodes_req;
+        find_nodes_req.set_count(rt->GetFindNodesMaxSize());
+        find_nodes_req.set_target_id(targets_[iteration % kMicroTargets]);
+        for (auto value : bloomfilter_) {
+            find_nodes_req.add_bloomfilter(value);
+        }
+        std::string data;
+        find_nodes_req.SerializeToString(&data);
+    });
+    std::string req_data;
+    {
+        protobuf::FindClosestNodesRequest find_nodes_req;
+        find_nodes_req.set_count(rt->GetFindNodesMaxSize());
+        find_nodes_req.set_target_id(targets_[0]);
+        for (auto value : bloomfilter_) {
+            find_nodes_req.add_bloomfilter(value);
+        }
+        find_nodes_req.SerializeToString(&req_data);
+    }
+    RunReader("FindNodesRequestParse", [&req_data](MicroState& state, uint64_t iteration) {
+        protobuf::FindClosestNodesRequest find_nodes_req;
+        find_nodes_req.ParseFromString(req_data);
+        std::vector<uint64_t> bloomfilter_vec(
+                find_nodes_req.bloomfilter().begin(),
+                find_nodes_req.bloomfilter().end());
+        base::Uint64BloomFilter bloomfilter(bloomfilter_vec, kFindNodesBloomfilterHashNum);
+    });
+    RunReader("FindNodesResponseSerialize", [this](MicroState& state, uint64_t iteration) {
+        std::string data;
+        FindNodesResponse(targets_[iteration % kMicroTargets], data);
+    });
+    std::string res_data;
+    FindNodesResponse(targets_[0], res_data);
+    RunReader("FindNodesResponseParse", [&res_data](MicroState& state, uint64_t iteration) {
+        protobuf::FindClosestNodesResponse find_nodes_res;
+        find_nodes_res.ParseFromString(res_data);
+    });
+
+    // a node of the table is dropped and added back, only one side is timed
+    RunWriter("AddNode", [this, rt](MicroState& state, uint64_t iteration) {
+        NodeInfoPtr node = table_.nodes()[iteration % table_.nodes().size()];
+        state.PauseTiming();
+        rt->DropNode(node);
+        state.ResumeTiming();
+        rt->AddNode(node);
+    });
+    RunWriter("DropNode", [this, rt](MicroState& state, uint64_t iteration) {
+        NodeInfoPtr node = table_.nodes()[iteration % table_.nodes().size()];
+        rt->DropNode(node);
+        state.PauseTiming();
+        rt->AddNode(node);
+        state.ResumeTiming();
+    });
+    // caches the candidate for replacement when its bucket is full
+    RunWriter("CanAddNode", [this, rt](MicroState& state, uint64_t iteration) {
+        rt->CanAddNode(candidates_[0][iteration % kMicroCandidates]);
+    });
+}
+
+void MicroCases::RunReader(const std::string& name, MicroOp op) {
+    if (!Selected(name)) {
+        return;
+    }
+
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t threads = 1; threads < options_.max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(options_.max_threads);
+    for (auto threads : thread_counts) {
+        std::atomic<bool> stop(false);
+        std::thread writer;
+        if (options_.writer) {
+            writer = std::thread(&MicroCases::WriterLoop, this, std::ref(stop));
+        }
+        auto result = harness_.Run(options_.writer ? name + "/writer" : name, table_.size(), threads, op);
+        stop = true;
+        if (writer.joinable()) {
+            writer.join();
+        }
+        MicroHarness::Print(result);
+    }
+}
+
+void MicroCases::RunWriter(const std::string& name, MicroOp op) {
+    if (!Selected(name) || table_.nodes().empty()) {
+        return;
+    }
+    MicroHarness::Print(harness_.Run(name, table_.size(), 1, op));
+}
+
+void MicroCases::WriterLoop(std::atomic<bool>& stop) {
+    auto rt = table_.routing_table();
+    uint32_t index = 0;
+    while (!stop) {
+        NodeInfoPtr node = writer_nodes_[index++ % writer_nodes_.size()];
+        rt->AddNode(node);
+        rt->DropNode(node);
+    }
+}
+
+void MicroCases::FindNodesResponse(const std::string& target_id, std::string& data) {
+    auto rt = table_.routing_table();
+    protobuf::FindClosestNodesResponse find_nodes_res;
+    rt->GetClosestNodesResponse(target_id, kJoinResponseClosestNodesMaxBytes, find_nodes_res);
+    find_nodes_res.SerializeToString(&data);
+}
+
+static void PrintUsage() {
+    std::cout << "Allowed options:" << std::endl;
+    std::cout << "\t-h [help]            print help info" << std::endl;
+    std::cout << "\t-s [sizes]           table sizes, default 16,64,256,1024,4096" << std::endl;
+    std::cout << "\t-t [threads]         max reader threads, default 4" << std::endl;
+    std::cout << "\t-m [min_time_ms]     time of one case, default 200" << std::endl;
+    std::cout << "\t-f [filter]          only cases whose name contains filter" << std::endl;
+    std::cout << "\t-w [writer]          1: readers run next to a writer thread" << std::endl;
+    std::cout << "\t-r [seed]            random seed, default 1" << std::endl;
+}
+
+static bool ParseOptions(int argc, char** argv, MicroOptions& options) {
+    top::ArgsParser args_parser;
+    args_parser.AddArgType('h', "help", top::kNoValue);
+    args_parser.AddArgType('s', "sizes", top::kMustValue);
+    args_parser.AddArgType('t', "threads", top::kMustValue);
+    args_parser.AddArgType('m', "min_time_ms", top::kMustValue);
+    args_parser.AddArgType('f', "filter", top::kMustValue);
+    args_parser.AddArgType('w', "writer", top::kMustValue);
+    args_parser.AddArgType('r', "seed", top::kMustValue);
+
+    std::string tmp_params = "";
+    for (int i = 1; i < argc; i++) {
+        if (strlen(argv[i]) == 0) {
+            tmp_params += static_cast<char>(31);
+        } else {
+            tmp_params += argv[i];
+        }
+        tmp_params += " ";
+    }
+
+    std::string err_pos;
+    if (args_parser.Parse(tmp_params, err_pos) != kKadSuccess) {
+        std::cout << "parse params failed!" << std::endl;
+        return false;
+    }
+    if (args_parser.HasParam("h")) {
+        PrintUsage();
+        exit(0);
+    }
+
+    std::string sizes;
+    if (args_parser.GetParam("s", sizes) == kKadSuccess && !sizes.empty()) {
+        options.sizes.clear();
+        top::base::LineParser line_split(sizes.c_str(), ',', sizes.size());
+        for (uint32_t i = 0; i < line_split.Count(); ++i) {
+            options.sizes.push_back(strtoul(line_split[i], nullptr, 10));
+        }
+    }
+    int value = 0;
+    if (args_parser.GetParam("t", value) == kKadSuccess && value > 0) {
+        options.max_threads = value;
+    }
+    if (args_parser.GetParam("m", value) == kKadSuccess && value > 0) {
+        options.min_time_ms = value;
+    }
+    if (args_parser.GetParam("w", value) == kKadSuccess) {
+        options.writer = value == 1;
+    }
+    if (args_parser.GetParam("r", value) == kKadSuccess) {
+        options.seed = value;
+    }
+    args_parser.GetParam("f", options.filter);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    MicroOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    xinit_log("./xkad_microbench.log", true, true);
+    xset_log_level(enum_xlog_level_error);
+    top::base::Config config;
+    config.Set("node", "zone_id", 1);
+    if (!CreateGlobalXid(config)) {
+        assert(0);
+    }
+    NatManagerIntf::Instance()->SetNatType(kNatTypePublic);
+
+    MicroHarness::PrintHeader();
+    for (auto size : options.sizes) {
+        MicroTable table(size, options.seed);
+        if (!table.Init()) {
+            std::cout << "init table of " << size << " nodes failed" << std::endl;
+            return 1;
+        }
+        MicroCases cases(options, table);
+        cases.Run();
+    }
+    return 0;
+}
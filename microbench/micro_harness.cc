@@ -0,0 +1,97 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "micro_harness.h"
+
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+static const uint64_t kMicroBatch = 64;  // iterations between two clock checks
+
+MicroHarness::MicroHarness(uint64_t min_time_ms) : min_time_ms_(min_time_ms) {}
+
+MicroResult MicroHarness::Run(const std::string& name, uint32_t table_size, uint32_t threads, MicroOp op) {
+    std::vector<uint64_t> iterations(threads, 0);
+    std::vector<uint64_t> elapsed_ns(threads, 0);
+    std::atomic<uint32_t> ready(0);
+    std::atomic<bool> start(false);
+    std::atomic<bool> stop(false);
+
+    auto worker = [&](uint32_t thread_index) {
+        MicroState state(thread_index);
+        ++ready;
+        while (!start) {
+            std::this_thread::yield();
+        }
+        uint64_t iteration = 0;
+        while (!stop) {
+            state.ResumeTiming();
+            for (uint64_t i = 0; i < kMicroBatch; ++i) {
+                op(state, iteration++);
+            }
+            state.PauseTiming();
+        }
+        iterations[thread_index] = iteration;
+        elapsed_ns[thread_index] = state.elapsed_ns();
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(worker, i));
+    }
+    while (ready < threads) {
+        std::this_thread::yield();
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(min_time_ms_));
+    stop = true;
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    const double wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+
+    MicroResult result;
+    result.name = name;
+    result.table_size = table_size;
+    result.threads = threads;
+    double ns_per_op_sum = 0.0;
+    for (uint32_t i = 0; i < threads; ++i) {
+        result.iterations += iterations[i];
+        if (iterations[i] > 0) {
+            ns_per_op_sum += (double)elapsed_ns[i] / iterations[i];
+        }
+    }
+    result.ns_per_op = ns_per_op_sum / threads;
+    result.ops_per_second = wall_ns > 0 ? result.iterations * 1e9 / wall_ns : 0.0;
+    return result;
+}
+
+void MicroHarness::PrintHeader() {
+    printf("%-32s %8s %8s %14s %12s %14s\n",
+            "name", "size", "threads", "iterations", "ns/op", "ops/s");
+}
+
+void MicroHarness::Print(const MicroResult& result) {
+    printf("%-32s %8u %8u %14llu %12.1f %14.0f\n",
+            result.name.c_str(),
+            result.table_size,
+            result.threads,
+            (unsigned long long)result.iterations,
+            result.ns_per_op,
+            result.ops_per_second);
+    fflush(stdout);
+}
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
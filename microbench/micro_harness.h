@@ -0,0 +1,66 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <chrono>
+#include <functional>
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+// timing of one thread, an op excludes its setup work with Pause/Resume
+class MicroState {
+public:
+    explicit MicroState(uint32_t thread_index) : thread_index_(thread_index) {}
+    uint32_t thread_index() const {
+        return thread_index_;
+    }
+    void PauseTiming() {
+        elapsed_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - begin_).count();
+    }
+    void ResumeTiming() {
+        begin_ = std::chrono::steady_clock::now();
+    }
+    uint64_t elapsed_ns() const {
+        return elapsed_ns_;
+    }
+
+private:
+    uint32_t thread_index_;
+    uint64_t elapsed_ns_{ 0 };
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// one call of the measured operation, iteration counts per thread from 0
+typedef std::function<void(MicroState& state, uint64_t iteration)> MicroOp;
+
+struct MicroResult {
+    std::string name;
+    uint32_t table_size{ 0 };
+    uint32_t threads{ 0 };
+    uint64_t iterations{ 0 };  // all threads
+    double ns_per_op{ 0.0 };  // timed time of a thread / its iterations, averaged
+    double ops_per_second{ 0.0 };  // all threads, by wall time
+};
+
+// runs an op on threads threads in batches until min_time_ms has passed
+class MicroHarness {
+public:
+    explicit MicroHarness(uint64_t min_time_ms);
+    MicroResult Run(const std::string& name, uint32_t table_size, uint32_t threads, MicroOp op);
+    static void PrintHeader();
+    static void Print(const MicroResult& result);
+
+private:
+    uint64_t min_time_ms_;
+};
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
@@ -0,0 +1,142 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "micro_table.h"
+
+#include "xbase/xhash.h"
+#include "xpbase/base/top_log.h"
+#include "xpbase/base/kad_key/platform_kadmlia_key.h"
+#include "xkad/routing_table/bucket_capacity.h"
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+class MicroKadkey : public base::PlatformKadmliaKey {
+public:
+    MicroKadkey(const std::string& str_for_hash, bool hash_tag)
+            : PlatformKadmliaKey(str_for_hash, hash_tag) {
+        node_id_ = str_for_hash;
+    }
+
+    virtual std::string Get() override {
+        return node_id_;
+    }
+
+private:
+    std::string node_id_;
+};
+
+static std::string HostIp(uint32_t host) {
+    return "10." + std::to_string((host >> 16) & 0xff) + "."
+            + std::to_string((host >> 8) & 0xff) + "." + std::to_string(host & 0xff);
+}
+
+MicroTable::MicroTable(uint32_t size, uint32_t seed)
+        : size_(size),
+          buckets_(0),
+          random_(seed),
+          next_host_(2),
+          network_(),
+          scheduler_(),
+          transport_(),
+          local_node_(),
+          routing_table_(),
+          nodes_() {}
+
+MicroTable::~MicroTable() {
+    if (routing_table_) {
+        routing_table_->UnInit();
+    }
+    if (transport_) {
+        transport_->Stop();
+    }
+}
+
+bool MicroTable::Init() {
+    const std::string local_ip = HostIp(1);
+    const uint16_t local_port = 9000;
+    network_ = std::make_shared<LoopbackNetwork>(random_(), []() {
+        return (uint64_t)0;
+    });
+    scheduler_ = std::make_shared<SimScheduler>(random_());
+    transport_ = std::make_shared<LoopbackTransport>(network_, local_ip, local_port, kNatTypePublic);
+    if (transport_->Start(local_ip, local_port, nullptr) != kKadSuccess) {
+        return false;
+    }
+
+    auto kad_key = std::make_shared<MicroKadkey>(RandomId(), true);
+    local_node_ = std::make_shared<LocalNodeInfo>();
+    if (!local_node_->Init(local_ip, local_port, true, false, "", kad_key, kad_key->xnetwork_id(), kRoleInvalid)) {
+        TOP_ERROR("microbench local_node_info init failed");
+        return false;
+    }
+    local_node_->set_service_type(kRoot);
+
+    routing_table_ = std::make_shared<RoutingTable>(transport_, kNodeIdSize, local_node_);
+    routing_table_->set_sim_scheduler(scheduler_);
+    if (!routing_table_->Init()) {
+        TOP_ERROR("microbench routing table init failed");
+        return false;
+    }
+    BucketCapacityPolicy policy;
+    policy.near_k = kMicroBucketK;
+    policy.far_k = kMicroBucketK;
+    routing_table_->set_bucket_capacity_policy(policy);
+
+    // one slot of every bucket stays free, so NewNode can always be added
+    buckets_ = (size_ + kMicroBucketK - 2) / (kMicroBucketK - 1);
+    for (uint32_t i = 0; i < size_; ++i) {
+        auto node = NewNode();
+        node->node_id = IdInBucket(kNodeIdSize * 8 - i % buckets_);
+        if (routing_table_->AddNode(node) != kKadSuccess) {
+            TOP_ERROR("microbench add node %u failed", i);
+            return false;
+        }
+        nodes_.push_back(node);
+    }
+    return true;
+}
+
+NodeInfoPtr MicroTable::NewNode() {
+    const uint32_t bucket_index = kNodeIdSize * 8 - random_() % std::max(buckets_, 1u);
+    NodeInfoPtr node = NewNodeInfo(IdInBucket(bucket_index));
+    const uint32_t host = next_host_++;
+    node->public_ip = HostIp(host);
+    node->public_port = 9000;
+    node->local_ip = node->public_ip;
+    node->local_port = node->public_port;
+    node->nat_type = kNatTypePublic;
+    node->xid = RandomId();
+    node->hash64 = base::xhash64_t::digest(node->xid);
+    return node;
+}
+
+std::string MicroTable::RandomId() {
+    std::string id(kNodeIdSize, '\0');
+    for (auto& c : id) {
+        c = static_cast<char>(random_() & 0xff);
+    }
+    return id;
+}
+
+std::string MicroTable::IdInBucket(uint32_t bucket_index) {
+    // inverse of RoutingTable::SetNodeBucket: the first differing bit decides the bucket
+    const uint32_t bit_index = (8 - bucket_index % 8) % 8;
+    const uint32_t byte_index = kNodeIdSize - (bucket_index + bit_index) / 8;
+    std::string id = local_node_->id();
+    const uint8_t flip = 0x80 >> bit_index;
+    const uint8_t lower = flip - 1;
+    uint8_t byte = static_cast<uint8_t>(id[byte_index]);
+    byte = ((byte ^ flip) & ~lower) | (random_() & lower);
+    id[byte_index] = static_cast<char>(byte);
+    for (uint32_t i = byte_index + 1; i < kNodeIdSize; ++i) {
+        id[i] = static_cast<char>(random_() & 0xff);
+    }
+    return id;
+}
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
@@ -0,0 +1,75 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <random>
+#include <memory>
+
+#include "xpbase/base/top_utils.h"
+#include "xkad/sim/loopback_network.h"
+#include "xkad/sim/sim_scheduler.h"
+#include "xkad/sim/loopback_transport.h"
+
+#define private public
+#define protected public
+#include "xkad/routing_table/routing_table.h"
+#include "xkad/routing_table/local_node_info.h"
+#undef private
+#undef protected
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+// bucket k of the fixture, buckets of kKadParamK could not hold 4096 nodes
+static const uint32_t kMicroBucketK = 32;
+
+// a routing table filled with size nodes. it runs on a sim scheduler that is
+// never advanced and a loopback transport, so no timer or socket disturbs the
+// measured calls
+class MicroTable {
+public:
+    MicroTable(uint32_t size, uint32_t seed);
+    ~MicroTable();
+    bool Init();
+    // a node not in the table, in one of the filled buckets
+    NodeInfoPtr NewNode();
+    std::string RandomId();
+
+    std::shared_ptr<RoutingTable> routing_table() {
+        return routing_table_;
+    }
+    // nodes added at Init, benchmarks that drop one add it back
+    const std::vector<NodeInfoPtr>& nodes() const {
+        return nodes_;
+    }
+    uint32_t size() const {
+        return size_;
+    }
+
+private:
+    // id in bucket_index relative to the local id, the lower bits random
+    std::string IdInBucket(uint32_t bucket_index);
+
+    uint32_t size_;
+    uint32_t buckets_;  // filled buckets, counted down from the farthest
+    std::mt19937 random_;
+    uint32_t next_host_;
+    LoopbackNetworkPtr network_;
+    SimSchedulerPtr scheduler_;
+    LoopbackTransportPtr transport_;
+    std::shared_ptr<LocalNodeInfo> local_node_;
+    std::shared_ptr<RoutingTable> routing_table_;
+    std::vector<NodeInfoPtr> nodes_;
+
+    DISALLOW_COPY_AND_ASSIGN(MicroTable);
+};
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
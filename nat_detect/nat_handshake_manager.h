@@ -5,6 +5,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -15,6 +16,7 @@
 #include "xpbase/base/top_timer.h"
 #include "xkad/routing_table/routing_utils.h"
 #include "xkad/routing_table/node_info.h"
+#include "xkad/routing_table/endpoint_key.h"
 
 namespace top {
 namespace kadmlia {
@@ -55,7 +57,7 @@ private:
 
     std::string name_{"<bluenat>"};
     std::atomic<bool> started_{false};
-    std::map<std::string, std::shared_ptr<NatDetectStruct>> peers_;
+    std::unordered_map<EndpointKey, std::shared_ptr<NatDetectStruct>, EndpointKeyHash> peers_;
     std::mutex mutex_;
     base::TimerManager* timer_manager_{nullptr};
     std::shared_ptr<base::TimerRepeated> timer_;
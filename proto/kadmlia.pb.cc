@@ -886,13 +886,17 @@ const ::google::protobuf::uint32 TableStruct::offsets[] GOOGLE_PROTOBUF_ATTRIBUT
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::BootstrapJoinResponse, xid_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::BootstrapJoinResponse, xip_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::BootstrapJoinResponse, dxip_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::BootstrapJoinResponse, closest_nodes_),
+  GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::BootstrapJoinResponse, retry_after_ms_),
   0,
-  5,
-  1,
   6,
+  1,
+  7,
   2,
   3,
   4,
+  5,
+  8,
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::NatDetectRequest, _has_bits_),
   GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(::top::kadmlia::protobuf::NatDetectRequest, _internal_metadata_),
   ~0u,  // no _extensions_
@@ -1238,39 +1242,39 @@ static const ::google::protobuf::internal::MigrationSchema schemas[] GOOGLE_PROT
   { 14, 25, sizeof(::top::kadmlia::protobuf::ConnectReq)},
   { 31, 41, sizeof(::top::kadmlia::protobuf::ConnectRes)},
   { 46, 57, sizeof(::top::kadmlia::protobuf::BootstrapJoinRequest)},
-  { 63, 75, sizeof(::top::kadmlia::protobuf::BootstrapJoinResponse)},
-  { 82, 89, sizeof(::top::kadmlia::protobuf::NatDetectRequest)},
-  { 91, 98, sizeof(::top::kadmlia::protobuf::NatDetectResponse)},
-  { 100, 106, sizeof(::top::kadmlia::protobuf::NatDetectFinish)},
-  { 107, 113, sizeof(::top::kadmlia::protobuf::NatDetectHandshake2Node)},
-  { 114, 120, sizeof(::top::kadmlia::protobuf::NatDetectHandshake2Boot)},
-  { 121, 134, sizeof(::top::kadmlia::protobuf::Handshake)},
-  { 142, 155, sizeof(::top::kadmlia::protobuf::NodeInfo)},
-  { 163, 170, sizeof(::top::kadmlia::protobuf::Heartbeat_ExtinfoMapEntry_DoNotUse)},
-  { 172, 178, sizeof(::top::kadmlia::protobuf::Heartbeat)},
-  { 179, 188, sizeof(::top::kadmlia::protobuf::FindClosestNodesRequest)},
-  { 192, 198, sizeof(::top::kadmlia::protobuf::FindClosestNodesResponse)},
-  { 199, 206, sizeof(::top::kadmlia::protobuf::GetNearestNodesRequest)},
-  { 208, 214, sizeof(::top::kadmlia::protobuf::GetNearestNodesResponse)},
-  { 215, 221, sizeof(::top::kadmlia::protobuf::UdpNatDetectRequest)},
-  { 222, 229, sizeof(::top::kadmlia::protobuf::UdpNatDetectResponse)},
-  { 231, 238, sizeof(::top::kadmlia::protobuf::EdgeNodesRequest)},
-  { 240, 246, sizeof(::top::kadmlia::protobuf::EdgeNodesResponse)},
-  { 247, 257, sizeof(::top::kadmlia::protobuf::AddressInfo)},
-  { 262, 269, sizeof(::top::kadmlia::protobuf::EdgeInfoRequest_ClientInfoEntry_DoNotUse)},
-  { 271, 278, sizeof(::top::kadmlia::protobuf::EdgeInfoRequest)},
-  { 280, 287, sizeof(::top::kadmlia::protobuf::EdgeInfoResponse_EdgeInfoEntry_DoNotUse)},
-  { 289, 296, sizeof(::top::kadmlia::protobuf::EdgeInfoResponse)},
-  { 298, 305, sizeof(::top::kadmlia::protobuf::GetAllNodesFromBootRequest)},
-  { 307, 313, sizeof(::top::kadmlia::protobuf::GetAllNodesFromBootResponse)},
-  { 314, 329, sizeof(::top::kadmlia::protobuf::SmartObjectData)},
-  { 339, 351, sizeof(::top::kadmlia::protobuf::SmartObjectTuple)},
-  { 358, 365, sizeof(::top::kadmlia::protobuf::SmartObjectRefreshData)},
-  { 367, 375, sizeof(::top::kadmlia::protobuf::SmartObjectDataBlock)},
-  { 378, 389, sizeof(::top::kadmlia::protobuf::SmartObjectSyncData)},
-  { 395, 402, sizeof(::top::kadmlia::protobuf::RootGetNodesRequest)},
-  { 404, 410, sizeof(::top::kadmlia::protobuf::RootGetNodesResponse)},
-  { 411, 418, sizeof(::top::kadmlia::protobuf::RootMessage)},
+  { 63, 77, sizeof(::top::kadmlia::protobuf::BootstrapJoinResponse)},
+  { 86, 93, sizeof(::top::kadmlia::protobuf::NatDetectRequest)},
+  { 95, 102, sizeof(::top::kadmlia::protobuf::NatDetectResponse)},
+  { 104, 110, sizeof(::top::kadmlia::protobuf::NatDetectFinish)},
+  { 111, 117, sizeof(::top::kadmlia::protobuf::NatDetectHandshake2Node)},
+  { 118, 124, sizeof(::top::kadmlia::protobuf::NatDetectHandshake2Boot)},
+  { 125, 138, sizeof(::top::kadmlia::protobuf::Handshake)},
+  { 146, 159, sizeof(::top::kadmlia::protobuf::NodeInfo)},
+  { 167, 174, sizeof(::top::kadmlia::protobuf::Heartbeat_ExtinfoMapEntry_DoNotUse)},
+  { 176, 182, sizeof(::top::kadmlia::protobuf::Heartbeat)},
+  { 183, 192, sizeof(::top::kadmlia::protobuf::FindClosestNodesRequest)},
+  { 196, 202, sizeof(::top::kadmlia::protobuf::FindClosestNodesResponse)},
+  { 203, 210, sizeof(::top::kadmlia::protobuf::GetNearestNodesRequest)},
+  { 212, 218, sizeof(::top::kadmlia::protobuf::GetNearestNodesResponse)},
+  { 219, 225, sizeof(::top::kadmlia::protobuf::UdpNatDetectRequest)},
+  { 226, 233, sizeof(::top::kadmlia::protobuf::UdpNatDetectResponse)},
+  { 235, 242, sizeof(::top::kadmlia::protobuf::EdgeNodesRequest)},
+  { 244, 250, sizeof(::top::kadmlia::protobuf::EdgeNodesResponse)},
+  { 251, 261, sizeof(::top::kadmlia::protobuf::AddressInfo)},
+  { 266, 273, sizeof(::top::kadmlia::protobuf::EdgeInfoRequest_ClientInfoEntry_DoNotUse)},
+  { 275, 282, sizeof(::top::kadmlia::protobuf::EdgeInfoRequest)},
+  { 284, 291, sizeof(::top::kadmlia::protobuf::EdgeInfoResponse_EdgeInfoEntry_DoNotUse)},
+  { 293, 300, sizeof(::top::kadmlia::protobuf::EdgeInfoResponse)},
+  { 302, 309, sizeof(::top::kadmlia::protobuf::GetAllNodesFromBootRequest)},
+  { 311, 317, sizeof(::top::kadmlia::protobuf::GetAllNodesFromBootResponse)},
+  { 318, 333, sizeof(::top::kadmlia::protobuf::SmartObjectData)},
+  { 343, 355, sizeof(::top::kadmlia::protobuf::SmartObjectTuple)},
+  { 362, 369, sizeof(::top::kadmlia::protobuf::SmartObjectRefreshData)},
+  { 371, 379, sizeof(::top::kadmlia::protobuf::SmartObjectDataBlock)},
+  { 382, 393, sizeof(::top::kadmlia::protobuf::SmartObjectSyncData)},
+  { 399, 406, sizeof(::top::kadmlia::protobuf::RootGetNodesRequest)},
+  { 408, 414, sizeof(::top::kadmlia::protobuf::RootGetNodesResponse)},
+  { 415, 422, sizeof(::top::kadmlia::protobuf::RootMessage)},
 };
 
 static ::google::protobuf::Message const * const file_default_instances[] = {
@@ -1347,81 +1351,83 @@ void AddDescriptorsImpl() {
       "\001(\005\"}\n\024BootstrapJoinRequest\022\020\n\010local_ip\030"
       "\001 \001(\014\022\022\n\nlocal_port\030\002 \001(\005\022\023\n\013client_mode"
       "\030\003 \001(\010\022\020\n\010nat_type\030\004 \001(\005\022\013\n\003xid\030\005 \001(\014\022\013\n"
-      "\003xip\030\006 \001(\014\"\217\001\n\025BootstrapJoinResponse\022\021\n\t"
+      "\003xip\030\006 \001(\014\"\276\001\n\025BootstrapJoinResponse\022\021\n\t"
       "public_ip\030\001 \001(\014\022\023\n\013public_port\030\002 \001(\005\022\024\n\014"
       "bootstrap_id\030\003 \001(\014\022\020\n\010nat_type\030\004 \001(\005\022\013\n\003"
-      "xid\030\005 \001(\014\022\013\n\003xip\030\006 \001(\014\022\014\n\004dxip\030\007 \001(\014\"8\n\020"
-      "NatDetectRequest\022\020\n\010local_ip\030\001 \001(\014\022\022\n\nlo"
-      "cal_port\030\002 \001(\005\":\n\021NatDetectResponse\022\020\n\010n"
-      "at_type\030\001 \001(\005\022\023\n\013detect_port\030\002 \001(\005\"\037\n\017Na"
-      "tDetectFinish\022\014\n\004resv\030\001 \001(\005\"\'\n\027NatDetect"
-      "Handshake2Node\022\014\n\004resv\030\001 \001(\005\"\'\n\027NatDetec"
-      "tHandshake2Boot\022\014\n\004resv\030\001 \001(\005\"\223\001\n\tHandsh"
-      "ake\022\020\n\010local_ip\030\001 \001(\014\022\022\n\nlocal_port\030\002 \001("
-      "\005\022\014\n\004type\030\003 \001(\005\022\021\n\tpublic_ip\030\004 \001(\014\022\023\n\013pu"
-      "blic_port\030\005 \001(\005\022\020\n\010nat_type\030\006 \001(\005\022\013\n\003xid"
-      "\030\007 \001(\014\022\013\n\003xip\030\010 \001(\014\"\220\001\n\010NodeInfo\022\021\n\tpubl"
-      "ic_ip\030\001 \001(\014\022\023\n\013public_port\030\002 \001(\005\022\020\n\010loca"
-      "l_ip\030\003 \001(\014\022\022\n\nlocal_port\030\004 \001(\005\022\n\n\002id\030\005 \001"
-      "(\014\022\020\n\010nat_type\030\006 \001(\005\022\013\n\003xip\030\007 \001(\014\022\013\n\003xid"
-      "\030\010 \001(\014\"\204\001\n\tHeartbeat\022D\n\013extinfo_map\030\001 \003("
-      "\0132/.top.kadmlia.protobuf.Heartbeat.Extin"
-      "foMapEntry\0321\n\017ExtinfoMapEntry\022\013\n\003key\030\001 \001"
-      "(\t\022\r\n\005value\030\002 \001(\t:\0028\001\"\206\001\n\027FindClosestNod"
-      "esRequest\022\r\n\005count\030\001 \001(\r\022\021\n\ttarget_id\030\002 "
-      "\001(\014\022\023\n\013bloomfilter\030\003 \003(\004\0224\n\014src_nodeinfo"
-      "\030\004 \001(\0132\036.top.kadmlia.protobuf.NodeInfo\"I"
-      "\n\030FindClosestNodesResponse\022-\n\005nodes\030\001 \003("
-      "\0132\036.top.kadmlia.protobuf.NodeInfo\":\n\026Get"
-      "NearestNodesRequest\022\021\n\ttarget_id\030\001 \001(\014\022\r"
-      "\n\005count\030\002 \001(\r\"H\n\027GetNearestNodesResponse"
-      "\022-\n\005nodes\030\001 \003(\0132\036.top.kadmlia.protobuf.N"
-      "odeInfo\"#\n\023UdpNatDetectRequest\022\014\n\004resv\030\001"
-      " \001(\r\">\n\024UdpNatDetectResponse\022\021\n\tpublic_i"
-      "p\030\001 \001(\014\022\023\n\013public_port\030\002 \001(\005\"4\n\020EdgeNode"
-      "sRequest\022\021\n\ttarget_id\030\001 \001(\014\022\r\n\005count\030\002 \001"
-      "(\r\"B\n\021EdgeNodesResponse\022-\n\005nodes\030\001 \003(\0132\036"
-      ".top.kadmlia.protobuf.NodeInfo\"}\n\013Addres"
-      "sInfo\022\021\n\tpublic_ip\030\001 \001(\014\022\023\n\013public_port\030"
-      "\002 \001(\r\022\022\n\nlocal_port\030\003 \001(\r\022\027\n\017detect_loca"
-      "l_ip\030\004 \001(\014\022\031\n\021detect_local_port\030\005 \001(\r\"\305\001"
-      "\n\017EdgeInfoRequest\022J\n\013client_info\030\001 \003(\01325"
-      ".top.kadmlia.protobuf.EdgeInfoRequest.Cl"
-      "ientInfoEntry\022\020\n\010nat_type\030\002 \001(\005\032T\n\017Clien"
-      "tInfoEntry\022\013\n\003key\030\001 \001(\r\0220\n\005value\030\002 \001(\0132!"
-      ".top.kadmlia.protobuf.AddressInfo:\0028\001\"\301\001"
-      "\n\020EdgeInfoResponse\022G\n\tedge_info\030\001 \003(\01324."
-      "top.kadmlia.protobuf.EdgeInfoResponse.Ed"
-      "geInfoEntry\022\020\n\010nat_type\030\002 \001(\005\032R\n\rEdgeInf"
-      "oEntry\022\013\n\003key\030\001 \001(\r\0220\n\005value\030\002 \001(\0132!.top"
-      ".kadmlia.protobuf.AddressInfo:\0028\001\"<\n\032Get"
-      "AllNodesFromBootRequest\022\021\n\tstart_pos\030\001 \001"
-      "(\005\022\013\n\003len\030\002 \001(\005\"L\n\033GetAllNodesFromBootRe"
-      "sponse\022-\n\005nodes\030\001 \003(\0132\036.top.kadmlia.prot"
-      "obuf.NodeInfo\"\264\001\n\017SmartObjectData\022\014\n\004typ"
-      "e\030\001 \001(\r\022\014\n\004oper\030\002 \001(\r\022\013\n\003key\030\003 \001(\014\022\r\n\005va"
-      "lue\030\004 \001(\014\022\r\n\005field\030\005 \001(\014\022\022\n\nlist_value\030\006"
-      " \003(\014\022\013\n\003ttl\030\007 \001(\r\022\022\n\npublic_key\030\010 \001(\014\022\017\n"
-      "\007aes_key\030\t \001(\014\022\024\n\014encrypt_mode\030\n \001(\r\"\177\n\020"
-      "SmartObjectTuple\022\014\n\004type\030\001 \001(\r\022\013\n\003key\030\002 "
-      "\001(\014\022\r\n\005value\030\003 \001(\014\022\r\n\005field\030\004 \001(\014\022\022\n\nlis"
-      "t_value\030\005 \003(\014\022\021\n\tsave_time\030\006 \001(\004\022\013\n\003ttl\030"
-      "\007 \001(\r\"b\n\026SmartObjectRefreshData\022\014\n\004oper\030"
-      "\001 \001(\r\022:\n\nlist_tuple\030\002 \003(\0132&.top.kadmlia."
-      "protobuf.SmartObjectTuple\"D\n\024SmartObject"
-      "DataBlock\022\n\n\002id\030\001 \001(\r\022\022\n\nblock_hash\030\002 \001("
-      "\014\022\014\n\004data\030\003 \001(\014\"\247\001\n\023SmartObjectSyncData\022"
-      "\014\n\004type\030\001 \001(\r\022\013\n\003key\030\002 \001(\014\022\017\n\007version\030\003 "
-      "\001(\014\022\021\n\troot_hash\030\004 \001(\014\022\021\n\tsync_node\030\005 \001("
-      "\014\022>\n\nlist_block\030\006 \003(\0132*.top.kadmlia.prot"
-      "obuf.SmartObjectDataBlock\"0\n\023RootGetNode"
-      "sRequest\022\n\n\002id\030\001 \001(\014\022\r\n\005count\030\002 \001(\r\"E\n\024R"
-      "ootGetNodesResponse\022-\n\005nodes\030\001 \003(\0132\036.top"
-      ".kadmlia.protobuf.NodeInfo\"1\n\013RootMessag"
-      "e\022\024\n\014message_type\030\001 \001(\r\022\014\n\004data\030\002 \001(\014"
+      "xid\030\005 \001(\014\022\013\n\003xip\030\006 \001(\014\022\014\n\004dxip\030\007 \001(\014\022\025\n\r"
+      "closest_nodes\030\010 \001(\014\022\026\n\016retry_after_ms\030\t "
+      "\001(\r\"8\n\020NatDetectRequest\022\020\n\010local_ip\030\001 \001("
+      "\014\022\022\n\nlocal_port\030\002 \001(\005\":\n\021NatDetectRespon"
+      "se\022\020\n\010nat_type\030\001 \001(\005\022\023\n\013detect_port\030\002 \001("
+      "\005\"\037\n\017NatDetectFinish\022\014\n\004resv\030\001 \001(\005\"\'\n\027Na"
+      "tDetectHandshake2Node\022\014\n\004resv\030\001 \001(\005\"\'\n\027N"
+      "atDetectHandshake2Boot\022\014\n\004resv\030\001 \001(\005\"\223\001\n"
+      "\tHandshake\022\020\n\010local_ip\030\001 \001(\014\022\022\n\nlocal_po"
+      "rt\030\002 \001(\005\022\014\n\004type\030\003 \001(\005\022\021\n\tpublic_ip\030\004 \001("
+      "\014\022\023\n\013public_port\030\005 \001(\005\022\020\n\010nat_type\030\006 \001(\005"
+      "\022\013\n\003xid\030\007 \001(\014\022\013\n\003xip\030\010 \001(\014\"\220\001\n\010NodeInfo\022"
+      "\021\n\tpublic_ip\030\001 \001(\014\022\023\n\013public_port\030\002 \001(\005\022"
+      "\020\n\010local_ip\030\003 \001(\014\022\022\n\nlocal_port\030\004 \001(\005\022\n\n"
+      "\002id\030\005 \001(\014\022\020\n\010nat_type\030\006 \001(\005\022\013\n\003xip\030\007 \001(\014"
+      "\022\013\n\003xid\030\010 \001(\014\"\204\001\n\tHeartbeat\022D\n\013extinfo_m"
+      "ap\030\001 \003(\0132/.top.kadmlia.protobuf.Heartbea"
+      "t.ExtinfoMapEntry\0321\n\017ExtinfoMapEntry\022\013\n\003"
+      "key\030\001 \001(\t\022\r\n\005value\030\002 \001(\t:\0028\001\"\206\001\n\027FindClo"
+      "sestNodesRequest\022\r\n\005count\030\001 \001(\r\022\021\n\ttarge"
+      "t_id\030\002 \001(\014\022\023\n\013bloomfilter\030\003 \003(\004\0224\n\014src_n"
+      "odeinfo\030\004 \001(\0132\036.top.kadmlia.protobuf.Nod"
+      "eInfo\"I\n\030FindClosestNodesResponse\022-\n\005nod"
+      "es\030\001 \003(\0132\036.top.kadmlia.protobuf.NodeInfo"
+      "\":\n\026GetNearestNodesRequest\022\021\n\ttarget_id\030"
+      "\001 \001(\014\022\r\n\005count\030\002 \001(\r\"H\n\027GetNearestNodesR"
+      "esponse\022-\n\005nodes\030\001 \003(\0132\036.top.kadmlia.pro"
+      "tobuf.NodeInfo\"#\n\023UdpNatDetectRequest\022\014\n"
+      "\004resv\030\001 \001(\r\">\n\024UdpNatDetectResponse\022\021\n\tp"
+      "ublic_ip\030\001 \001(\014\022\023\n\013public_port\030\002 \001(\005\"4\n\020E"
+      "dgeNodesRequest\022\021\n\ttarget_id\030\001 \001(\014\022\r\n\005co"
+      "unt\030\002 \001(\r\"B\n\021EdgeNodesResponse\022-\n\005nodes\030"
+      "\001 \003(\0132\036.top.kadmlia.protobuf.NodeInfo\"}\n"
+      "\013AddressInfo\022\021\n\tpublic_ip\030\001 \001(\014\022\023\n\013publi"
+      "c_port\030\002 \001(\r\022\022\n\nlocal_port\030\003 \001(\r\022\027\n\017dete"
+      "ct_local_ip\030\004 \001(\014\022\031\n\021detect_local_port\030\005"
+      " \001(\r\"\305\001\n\017EdgeInfoRequest\022J\n\013client_info\030"
+      "\001 \003(\01325.top.kadmlia.protobuf.EdgeInfoReq"
+      "uest.ClientInfoEntry\022\020\n\010nat_type\030\002 \001(\005\032T"
+      "\n\017ClientInfoEntry\022\013\n\003key\030\001 \001(\r\0220\n\005value\030"
+      "\002 \001(\0132!.top.kadmlia.protobuf.AddressInfo"
+      ":\0028\001\"\301\001\n\020EdgeInfoResponse\022G\n\tedge_info\030\001"
+      " \003(\01324.top.kadmlia.protobuf.EdgeInfoResp"
+      "onse.EdgeInfoEntry\022\020\n\010nat_type\030\002 \001(\005\032R\n\r"
+      "EdgeInfoEntry\022\013\n\003key\030\001 \001(\r\0220\n\005value\030\002 \001("
+      "\0132!.top.kadmlia.protobuf.AddressInfo:\0028\001"
+      "\"<\n\032GetAllNodesFromBootRequest\022\021\n\tstart_"
+      "pos\030\001 \001(\005\022\013\n\003len\030\002 \001(\005\"L\n\033GetAllNodesFro"
+      "mBootResponse\022-\n\005nodes\030\001 \003(\0132\036.top.kadml"
+      "ia.protobuf.NodeInfo\"\264\001\n\017SmartObjectData"
+      "\022\014\n\004type\030\001 \001(\r\022\014\n\004oper\030\002 \001(\r\022\013\n\003key\030\003 \001("
+      "\014\022\r\n\005value\030\004 \001(\014\022\r\n\005field\030\005 \001(\014\022\022\n\nlist_"
+      "value\030\006 \003(\014\022\013\n\003ttl\030\007 \001(\r\022\022\n\npublic_key\030\010"
+      " \001(\014\022\017\n\007aes_key\030\t \001(\014\022\024\n\014encrypt_mode\030\n "
+      "\001(\r\"\177\n\020SmartObjectTuple\022\014\n\004type\030\001 \001(\r\022\013\n"
+      "\003key\030\002 \001(\014\022\r\n\005value\030\003 \001(\014\022\r\n\005field\030\004 \001(\014"
+      "\022\022\n\nlist_value\030\005 \003(\014\022\021\n\tsave_time\030\006 \001(\004\022"
+      "\013\n\003ttl\030\007 \001(\r\"b\n\026SmartObjectRefreshData\022\014"
+      "\n\004oper\030\001 \001(\r\022:\n\nlist_tuple\030\002 \003(\0132&.top.k"
+      "admlia.protobuf.SmartObjectTuple\"D\n\024Smar"
+      "tObjectDataBlock\022\n\n\002id\030\001 \001(\r\022\022\n\nblock_ha"
+      "sh\030\002 \001(\014\022\014\n\004data\030\003 \001(\014\"\247\001\n\023SmartObjectSy"
+      "ncData\022\014\n\004type\030\001 \001(\r\022\013\n\003key\030\002 \001(\014\022\017\n\007ver"
+      "sion\030\003 \001(\014\022\021\n\troot_hash\030\004 \001(\014\022\021\n\tsync_no"
+      "de\030\005 \001(\014\022>\n\nlist_block\030\006 \003(\0132*.top.kadml"
+      "ia.protobuf.SmartObjectDataBlock\"0\n\023Root"
+      "GetNodesRequest\022\n\n\002id\030\001 \001(\014\022\r\n\005count\030\002 \001"
+      "(\r\"E\n\024RootGetNodesResponse\022-\n\005nodes\030\001 \003("
+      "\0132\036.top.kadmlia.protobuf.NodeInfo\"1\n\013Roo"
+      "tMessage\022\024\n\014message_type\030\001 \001(\r\022\014\n\004data\030\002"
+      " \001(\014"
   };
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-      descriptor, 3357);
+      descriptor, 3404);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "kadmlia.proto", &protobuf_RegisterTypes);
 }
@@ -3262,6 +3268,8 @@ const int BootstrapJoinResponse::kNatTypeFieldNumber;
 const int BootstrapJoinResponse::kXidFieldNumber;
 const int BootstrapJoinResponse::kXipFieldNumber;
 const int BootstrapJoinResponse::kDxipFieldNumber;
+const int BootstrapJoinResponse::kClosestNodesFieldNumber;
+const int BootstrapJoinResponse::kRetryAfterMsFieldNumber;
 #endif  // !defined(_MSC_VER) || _MSC_VER >= 1900
 
 BootstrapJoinResponse::BootstrapJoinResponse()
@@ -3296,9 +3304,13 @@ BootstrapJoinResponse::BootstrapJoinResponse(const BootstrapJoinResponse& from)
   if (from.has_dxip()) {
     dxip_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.dxip_);
   }
+  closest_nodes_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  if (from.has_closest_nodes()) {
+    closest_nodes_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.closest_nodes_);
+  }
   ::memcpy(&public_port_, &from.public_port_,
-    static_cast<size_t>(reinterpret_cast<char*>(&nat_type_) -
-    reinterpret_cast<char*>(&public_port_)) + sizeof(nat_type_));
+    static_cast<size_t>(reinterpret_cast<char*>(&retry_after_ms_) -
+    reinterpret_cast<char*>(&public_port_)) + sizeof(retry_after_ms_));
   // @@protoc_insertion_point(copy_constructor:top.kadmlia.protobuf.BootstrapJoinResponse)
 }
 
@@ -3308,9 +3320,10 @@ void BootstrapJoinResponse::SharedCtor() {
   xid_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   xip_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   dxip_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  closest_nodes_.UnsafeSetDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   ::memset(&public_port_, 0, static_cast<size_t>(
-      reinterpret_cast<char*>(&nat_type_) -
-      reinterpret_cast<char*>(&public_port_)) + sizeof(nat_type_));
+      reinterpret_cast<char*>(&retry_after_ms_) -
+      reinterpret_cast<char*>(&public_port_)) + sizeof(retry_after_ms_));
 }
 
 BootstrapJoinResponse::~BootstrapJoinResponse() {
@@ -3324,6 +3337,7 @@ void BootstrapJoinResponse::SharedDtor() {
   xid_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   xip_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
   dxip_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  closest_nodes_.DestroyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
 }
 
 void BootstrapJoinResponse::SetCachedSize(int size) const {
@@ -3347,7 +3361,7 @@ void BootstrapJoinResponse::Clear() {
   (void) cached_has_bits;
 
   cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 31u) {
+  if (cached_has_bits & 63u) {
     if (cached_has_bits & 0x00000001u) {
       public_ip_.ClearNonDefaultToEmptyNoArena();
     }
@@ -3363,12 +3377,16 @@ void BootstrapJoinResponse::Clear() {
     if (cached_has_bits & 0x00000010u) {
       dxip_.ClearNonDefaultToEmptyNoArena();
     }
+    if (cached_has_bits & 0x00000020u) {
+      closest_nodes_.ClearNonDefaultToEmptyNoArena();
+    }
   }
-  if (cached_has_bits & 96u) {
+  if (cached_has_bits & 192u) {
     ::memset(&public_port_, 0, static_cast<size_t>(
         reinterpret_cast<char*>(&nat_type_) -
         reinterpret_cast<char*>(&public_port_)) + sizeof(nat_type_));
   }
+  retry_after_ms_ = 0u;
   _has_bits_.Clear();
   _internal_metadata_.Clear();
 }
@@ -3471,6 +3489,32 @@ bool BootstrapJoinResponse::MergePartialFromCodedStream(
         break;
       }
 
+      // optional bytes closest_nodes = 8;
+      case 8: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(66u /* 66 & 0xFF */)) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadBytes(
+                input, this->mutable_closest_nodes()));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
+      // optional uint32 retry_after_ms = 9;
+      case 9: {
+        if (static_cast< ::google::protobuf::uint8>(tag) ==
+            static_cast< ::google::protobuf::uint8>(72u /* 72 & 0xFF */)) {
+          set_has_retry_after_ms();
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::uint32, ::google::protobuf::internal::WireFormatLite::TYPE_UINT32>(
+                 input, &retry_after_ms_)));
+        } else {
+          goto handle_unusual;
+        }
+        break;
+      }
+
       default: {
       handle_unusual:
         if (tag == 0) {
@@ -3505,7 +3549,7 @@ void BootstrapJoinResponse::SerializeWithCachedSizes(
   }
 
   // optional int32 public_port = 2;
-  if (cached_has_bits & 0x00000020u) {
+  if (cached_has_bits & 0x00000040u) {
     ::google::protobuf::internal::WireFormatLite::WriteInt32(2, this->public_port(), output);
   }
 
@@ -3516,7 +3560,7 @@ void BootstrapJoinResponse::SerializeWithCachedSizes(
   }
 
   // optional int32 nat_type = 4;
-  if (cached_has_bits & 0x00000040u) {
+  if (cached_has_bits & 0x00000080u) {
     ::google::protobuf::internal::WireFormatLite::WriteInt32(4, this->nat_type(), output);
   }
 
@@ -3538,6 +3582,17 @@ void BootstrapJoinResponse::SerializeWithCachedSizes(
       7, this->dxip(), output);
   }
 
+  // optional bytes closest_nodes = 8;
+  if (cached_has_bits & 0x00000020u) {
+    ::google::protobuf::internal::WireFormatLite::WriteBytesMaybeAliased(
+      8, this->closest_nodes(), output);
+  }
+
+  // optional uint32 retry_after_ms = 9;
+  if (cached_has_bits & 0x00000100u) {
+    ::google::protobuf::internal::WireFormatLite::WriteUInt32(9, this->retry_after_ms(), output);
+  }
+
   if (_internal_metadata_.have_unknown_fields()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         _internal_metadata_.unknown_fields(), output);
@@ -3561,7 +3616,7 @@ void BootstrapJoinResponse::SerializeWithCachedSizes(
   }
 
   // optional int32 public_port = 2;
-  if (cached_has_bits & 0x00000020u) {
+  if (cached_has_bits & 0x00000040u) {
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(2, this->public_port(), target);
   }
 
@@ -3573,7 +3628,7 @@ void BootstrapJoinResponse::SerializeWithCachedSizes(
   }
 
   // optional int32 nat_type = 4;
-  if (cached_has_bits & 0x00000040u) {
+  if (cached_has_bits & 0x00000080u) {
     target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(4, this->nat_type(), target);
   }
 
@@ -3598,6 +3653,18 @@ void BootstrapJoinResponse::SerializeWithCachedSizes(
         7, this->dxip(), target);
   }
 
+  // optional bytes closest_nodes = 8;
+  if (cached_has_bits & 0x00000020u) {
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteBytesToArray(
+        8, this->closest_nodes(), target);
+  }
+
+  // optional uint32 retry_after_ms = 9;
+  if (cached_has_bits & 0x00000100u) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteUInt32ToArray(9, this->retry_after_ms(), target);
+  }
+
   if (_internal_metadata_.have_unknown_fields()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields(), target);
@@ -3615,7 +3682,7 @@ size_t BootstrapJoinResponse::ByteSizeLong() const {
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
         _internal_metadata_.unknown_fields());
   }
-  if (_has_bits_[0 / 32] & 127u) {
+  if (_has_bits_[0 / 32] & 255u) {
     // optional bytes public_ip = 1;
     if (has_public_ip()) {
       total_size += 1 +
@@ -3651,6 +3718,13 @@ size_t BootstrapJoinResponse::ByteSizeLong() const {
           this->dxip());
     }
 
+    // optional bytes closest_nodes = 8;
+    if (has_closest_nodes()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::BytesSize(
+          this->closest_nodes());
+    }
+
     // optional int32 public_port = 2;
     if (has_public_port()) {
       total_size += 1 +
@@ -3666,6 +3740,13 @@ size_t BootstrapJoinResponse::ByteSizeLong() const {
     }
 
   }
+  // optional uint32 retry_after_ms = 9;
+  if (has_retry_after_ms()) {
+    total_size += 1 +
+      ::google::protobuf::internal::WireFormatLite::UInt32Size(
+        this->retry_after_ms());
+  }
+
   int cached_size = ::google::protobuf::internal::ToCachedSize(total_size);
   SetCachedSize(cached_size);
   return total_size;
@@ -3694,7 +3775,7 @@ void BootstrapJoinResponse::MergeFrom(const BootstrapJoinResponse& from) {
   (void) cached_has_bits;
 
   cached_has_bits = from._has_bits_[0];
-  if (cached_has_bits & 127u) {
+  if (cached_has_bits & 255u) {
     if (cached_has_bits & 0x00000001u) {
       set_has_public_ip();
       public_ip_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.public_ip_);
@@ -3716,13 +3797,20 @@ void BootstrapJoinResponse::MergeFrom(const BootstrapJoinResponse& from) {
       dxip_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.dxip_);
     }
     if (cached_has_bits & 0x00000020u) {
-      public_port_ = from.public_port_;
+      set_has_closest_nodes();
+      closest_nodes_.AssignWithDefault(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), from.closest_nodes_);
     }
     if (cached_has_bits & 0x00000040u) {
+      public_port_ = from.public_port_;
+    }
+    if (cached_has_bits & 0x00000080u) {
       nat_type_ = from.nat_type_;
     }
     _has_bits_[0] |= cached_has_bits;
   }
+  if (cached_has_bits & 0x00000100u) {
+    set_retry_after_ms(from.retry_after_ms());
+  }
 }
 
 void BootstrapJoinResponse::CopyFrom(const ::google::protobuf::Message& from) {
@@ -3759,8 +3847,11 @@ void BootstrapJoinResponse::InternalSwap(BootstrapJoinResponse* other) {
     GetArenaNoVirtual());
   dxip_.Swap(&other->dxip_, &::google::protobuf::internal::GetEmptyStringAlreadyInited(),
     GetArenaNoVirtual());
+  closest_nodes_.Swap(&other->closest_nodes_, &::google::protobuf::internal::GetEmptyStringAlreadyInited(),
+    GetArenaNoVirtual());
   swap(public_port_, other->public_port_);
   swap(nat_type_, other->nat_type_);
+  swap(retry_after_ms_, other->retry_after_ms_);
   swap(_has_bits_[0], other->_has_bits_[0]);
   _internal_metadata_.Swap(&other->_internal_metadata_);
 }
@@ -1175,6 +1175,21 @@ class BootstrapJoinResponse : public ::google::protobuf::Message /* @@protoc_ins
   ::std::string* release_dxip();
   void set_allocated_dxip(::std::string* dxip);
 
+  // optional bytes closest_nodes = 8;
+  bool has_closest_nodes() const;
+  void clear_closest_nodes();
+  static const int kClosestNodesFieldNumber = 8;
+  const ::std::string& closest_nodes() const;
+  void set_closest_nodes(const ::std::string& value);
+  #if LANG_CXX11
+  void set_closest_nodes(::std::string&& value);
+  #endif
+  void set_closest_nodes(const char* value);
+  void set_closest_nodes(const void* value, size_t size);
+  ::std::string* mutable_closest_nodes();
+  ::std::string* release_closest_nodes();
+  void set_allocated_closest_nodes(::std::string* closest_nodes);
+
   // optional int32 public_port = 2;
   bool has_public_port() const;
   void clear_public_port();
@@ -1189,6 +1204,13 @@ class BootstrapJoinResponse : public ::google::protobuf::Message /* @@protoc_ins
   ::google::protobuf::int32 nat_type() const;
   void set_nat_type(::google::protobuf::int32 value);
 
+  // optional uint32 retry_after_ms = 9;
+  bool has_retry_after_ms() const;
+  void clear_retry_after_ms();
+  static const int kRetryAfterMsFieldNumber = 9;
+  ::google::protobuf::uint32 retry_after_ms() const;
+  void set_retry_after_ms(::google::protobuf::uint32 value);
+
   // @@protoc_insertion_point(class_scope:top.kadmlia.protobuf.BootstrapJoinResponse)
  private:
   void set_has_public_ip();
@@ -1205,6 +1227,10 @@ class BootstrapJoinResponse : public ::google::protobuf::Message /* @@protoc_ins
   void clear_has_xip();
   void set_has_dxip();
   void clear_has_dxip();
+  void set_has_closest_nodes();
+  void clear_has_closest_nodes();
+  void set_has_retry_after_ms();
+  void clear_has_retry_after_ms();
 
   ::google::protobuf::internal::InternalMetadataWithArena _internal_metadata_;
   ::google::protobuf::internal::HasBits<1> _has_bits_;
@@ -1214,8 +1240,10 @@ class BootstrapJoinResponse : public ::google::protobuf::Message /* @@protoc_ins
   ::google::protobuf::internal::ArenaStringPtr xid_;
   ::google::protobuf::internal::ArenaStringPtr xip_;
   ::google::protobuf::internal::ArenaStringPtr dxip_;
+  ::google::protobuf::internal::ArenaStringPtr closest_nodes_;
   ::google::protobuf::int32 public_port_;
   ::google::protobuf::int32 nat_type_;
+  ::google::protobuf::uint32 retry_after_ms_;
   friend struct ::protobuf_kadmlia_2eproto::TableStruct;
 };
 // -------------------------------------------------------------------
@@ -6431,13 +6459,13 @@ inline void BootstrapJoinResponse::set_allocated_public_ip(::std::string* public
 
 // optional int32 public_port = 2;
 inline bool BootstrapJoinResponse::has_public_port() const {
-  return (_has_bits_[0] & 0x00000020u) != 0;
+  return (_has_bits_[0] & 0x00000040u) != 0;
 }
 inline void BootstrapJoinResponse::set_has_public_port() {
-  _has_bits_[0] |= 0x00000020u;
+  _has_bits_[0] |= 0x00000040u;
 }
 inline void BootstrapJoinResponse::clear_has_public_port() {
-  _has_bits_[0] &= ~0x00000020u;
+  _has_bits_[0] &= ~0x00000040u;
 }
 inline void BootstrapJoinResponse::clear_public_port() {
   public_port_ = 0;
@@ -6521,13 +6549,13 @@ inline void BootstrapJoinResponse::set_allocated_bootstrap_id(::std::string* boo
 
 // optional int32 nat_type = 4;
 inline bool BootstrapJoinResponse::has_nat_type() const {
-  return (_has_bits_[0] & 0x00000040u) != 0;
+  return (_has_bits_[0] & 0x00000080u) != 0;
 }
 inline void BootstrapJoinResponse::set_has_nat_type() {
-  _has_bits_[0] |= 0x00000040u;
+  _has_bits_[0] |= 0x00000080u;
 }
 inline void BootstrapJoinResponse::clear_has_nat_type() {
-  _has_bits_[0] &= ~0x00000040u;
+  _has_bits_[0] &= ~0x00000080u;
 }
 inline void BootstrapJoinResponse::clear_nat_type() {
   nat_type_ = 0;
@@ -6741,6 +6769,96 @@ inline void BootstrapJoinResponse::set_allocated_dxip(::std::string* dxip) {
   // @@protoc_insertion_point(field_set_allocated:top.kadmlia.protobuf.BootstrapJoinResponse.dxip)
 }
 
+// optional bytes closest_nodes = 8;
+inline bool BootstrapJoinResponse::has_closest_nodes() const {
+  return (_has_bits_[0] & 0x00000020u) != 0;
+}
+inline void BootstrapJoinResponse::set_has_closest_nodes() {
+  _has_bits_[0] |= 0x00000020u;
+}
+inline void BootstrapJoinResponse::clear_has_closest_nodes() {
+  _has_bits_[0] &= ~0x00000020u;
+}
+inline void BootstrapJoinResponse::clear_closest_nodes() {
+  closest_nodes_.ClearToEmptyNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+  clear_has_closest_nodes();
+}
+inline const ::std::string& BootstrapJoinResponse::closest_nodes() const {
+  // @@protoc_insertion_point(field_get:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+  return closest_nodes_.GetNoArena();
+}
+inline void BootstrapJoinResponse::set_closest_nodes(const ::std::string& value) {
+  set_has_closest_nodes();
+  closest_nodes_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), value);
+  // @@protoc_insertion_point(field_set:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+}
+#if LANG_CXX11
+inline void BootstrapJoinResponse::set_closest_nodes(::std::string&& value) {
+  set_has_closest_nodes();
+  closest_nodes_.SetNoArena(
+    &::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::move(value));
+  // @@protoc_insertion_point(field_set_rvalue:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+}
+#endif
+inline void BootstrapJoinResponse::set_closest_nodes(const char* value) {
+  GOOGLE_DCHECK(value != NULL);
+  set_has_closest_nodes();
+  closest_nodes_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), ::std::string(value));
+  // @@protoc_insertion_point(field_set_char:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+}
+inline void BootstrapJoinResponse::set_closest_nodes(const void* value, size_t size) {
+  set_has_closest_nodes();
+  closest_nodes_.SetNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(),
+      ::std::string(reinterpret_cast<const char*>(value), size));
+  // @@protoc_insertion_point(field_set_pointer:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+}
+inline ::std::string* BootstrapJoinResponse::mutable_closest_nodes() {
+  set_has_closest_nodes();
+  // @@protoc_insertion_point(field_mutable:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+  return closest_nodes_.MutableNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline ::std::string* BootstrapJoinResponse::release_closest_nodes() {
+  // @@protoc_insertion_point(field_release:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+  if (!has_closest_nodes()) {
+    return NULL;
+  }
+  clear_has_closest_nodes();
+  return closest_nodes_.ReleaseNonDefaultNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited());
+}
+inline void BootstrapJoinResponse::set_allocated_closest_nodes(::std::string* closest_nodes) {
+  if (closest_nodes != NULL) {
+    set_has_closest_nodes();
+  } else {
+    clear_has_closest_nodes();
+  }
+  closest_nodes_.SetAllocatedNoArena(&::google::protobuf::internal::GetEmptyStringAlreadyInited(), closest_nodes);
+  // @@protoc_insertion_point(field_set_allocated:top.kadmlia.protobuf.BootstrapJoinResponse.closest_nodes)
+}
+
+// optional uint32 retry_after_ms = 9;
+inline bool BootstrapJoinResponse::has_retry_after_ms() const {
+  return (_has_bits_[0] & 0x00000100u) != 0;
+}
+inline void BootstrapJoinResponse::set_has_retry_after_ms() {
+  _has_bits_[0] |= 0x00000100u;
+}
+inline void BootstrapJoinResponse::clear_has_retry_after_ms() {
+  _has_bits_[0] &= ~0x00000100u;
+}
+inline void BootstrapJoinResponse::clear_retry_after_ms() {
+  retry_after_ms_ = 0u;
+  clear_has_retry_after_ms();
+}
+inline ::google::protobuf::uint32 BootstrapJoinResponse::retry_after_ms() const {
+  // @@protoc_insertion_point(field_get:top.kadmlia.protobuf.BootstrapJoinResponse.retry_after_ms)
+  return retry_after_ms_;
+}
+inline void BootstrapJoinResponse::set_retry_after_ms(::google::protobuf::uint32 value) {
+  set_has_retry_after_ms();
+  retry_after_ms_ = value;
+  // @@protoc_insertion_point(field_set:top.kadmlia.protobuf.BootstrapJoinResponse.retry_after_ms)
+}
+
 // -------------------------------------------------------------------
 
 // NatDetectRequest
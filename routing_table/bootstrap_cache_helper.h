@@ -17,6 +17,7 @@
 #include "xpbase/base/kad_key/kadmlia_key.h"
 #include "xkad/routing_table/bootstrap_cache.h"
 #include "xkad/routing_table/node_info.h"
+#include "xkad/routing_table/memory_stats.h"
 
 namespace top {
 namespace kadmlia {
@@ -46,6 +47,9 @@ public:
     bool GetCacheServicePublicNodes(
             uint64_t service_type,
             std::set<std::pair<std::string, uint16_t>>& boot_endpoints);
+    // public endpoints and cached service nodes, the nodes themselves belong
+    // to the routing tables and are not counted
+    void GetMemoryUsage(MemoryUsage& usage);
     BootstrapCacheHelper(base::TimerManager* timer_manager);
     ~BootstrapCacheHelper();
 
@@ -0,0 +1,91 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <unordered_map>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <memory>
+
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+enum JoinAdmitResult {
+    kJoinAdmit = 0,
+    kJoinRetryLater,  // source or seed is over its limit, reply with retry_after_ms
+    kJoinDrop,  // over the limit and already told to retry in this window, no reply
+};
+
+static const uint32_t kJoinMaxPerSecond = 200;  // all sources
+// per source endpoint, above the kJoinRetryTimes requests one join sends
+static const uint32_t kJoinSourceBurst = 8;
+static const uint32_t kJoinSourceRefillMs = 1000;  // one token per second
+// endpoints of one ip that may join at once, the ip bucket is this many source
+// buckets together
+static const uint32_t kJoinIpSources = 4;
+static const uint32_t kJoinRetryAfterMinMs = 1000;
+static const uint32_t kJoinRetryAfterMaxMs = 30 * 1000;
+static const uint32_t kJoinLimiterMaxSources = 4096;
+
+// admission control for bootstrap join requests on seed nodes. sources are
+// keyed by ip:port, peers behind one nat do not share a bucket, and every ip
+// has a bucket of kJoinIpSources sources on top so one host can not take a
+// fresh burst per port. at most one retry-later reply goes to an ip per retry
+// window, the rest is dropped so a spoofed flood is not reflected
+class BootstrapJoinLimiter {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    BootstrapJoinLimiter();
+    // 0 disables the limit
+    BootstrapJoinLimiter(uint32_t max_per_second, uint32_t source_burst);
+    ~BootstrapJoinLimiter();
+    // 0 disables the limit
+    void SetLimits(uint32_t max_per_second, uint32_t source_burst);
+    int Admit(const std::string& ip, uint16_t port, uint32_t& retry_after_ms);
+    int Admit(const std::string& ip, uint16_t port, TimePoint now, uint32_t& retry_after_ms);
+    uint32_t sources_size();
+
+private:
+    struct SourceBucket {
+        uint32_t tokens;
+        TimePoint last_refill;
+    };
+    typedef std::unordered_map<std::string, SourceBucket> SourceBuckets;
+
+    // 0 if a token was taken, else the milliseconds until the next one
+    uint32_t TakeToken(
+            SourceBuckets& buckets,
+            const std::string& key,
+            uint32_t burst,
+            uint32_t refill_ms,
+            TimePoint now);
+    // 0 if the seed-wide window has room, else the milliseconds to wait
+    uint64_t TakeWindowSlot(TimePoint now);
+    int RetryLater(const std::string& ip, TimePoint now, uint64_t wait_ms, uint32_t& retry_after_ms);
+    void EraseIdle(SourceBuckets& buckets, TimePoint now);
+
+    uint32_t max_per_second_;
+    uint32_t source_burst_;
+    SourceBuckets sources_;
+    SourceBuckets ips_;
+    // ip -> end of the retry window of the last retry-later reply sent to it
+    std::unordered_map<std::string, TimePoint> retry_sent_;
+    std::mutex mutex_;
+    TimePoint window_start_;
+    uint32_t window_count_;
+
+    DISALLOW_COPY_AND_ASSIGN(BootstrapJoinLimiter);
+};
+
+typedef std::shared_ptr<BootstrapJoinLimiter> BootstrapJoinLimiterPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
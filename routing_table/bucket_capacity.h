@@ -0,0 +1,50 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <string>
+
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+
+namespace base {
+class Config;
+}
+
+namespace kadmlia {
+
+static const uint32_t kBucketCapacityMax = 64;
+
+// k of every bucket. the near_bucket_count buckets nearest to self, bucket index
+// 1 to near_bucket_count, get near_k slots, the others far_k. the class of a
+// bucket depends on its index only, not on the table contents.
+// the default is the classic kKadParamK for all buckets
+struct BucketCapacityPolicy {
+    uint32_t near_bucket_count{ 0 };
+    uint32_t near_k{ kKadParamK };
+    uint32_t far_k{ kKadParamK };
+
+    uint32_t Capacity(int bucket_index) const {
+        return bucket_index > 0 && (uint32_t)bucket_index <= near_bucket_count ? near_k : far_k;
+    }
+    bool Valid() const {
+        return near_k > 0 && near_k <= kBucketCapacityMax &&
+                far_k > 0 && far_k <= kBucketCapacityMax;
+    }
+};
+
+// process-wide policy of a service type, used by routing tables created for it
+void SetServiceBucketCapacityPolicy(uint64_t service_type, const BucketCapacityPolicy& policy);
+bool GetServiceBucketCapacityPolicy(uint64_t service_type, BucketCapacityPolicy& policy);
+// [section] near_buckets, near_bucket_k, far_bucket_k
+bool GetBucketCapacityPolicyConfig(
+        const base::Config& config,
+        const std::string& section,
+        BucketCapacityPolicy& policy);
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -10,11 +10,16 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
 
 #include "xpbase/base/top_timer.h"
 #include "xkad/routing_table/routing_utils.h"
 #include "xtransport/proto/transport.pb.h"
 #include "xkad/proto/kadmlia.pb.h"
+#include "xkad/routing_table/lock_stats.h"
+#include "xkad/routing_table/rpc_stats.h"
 
 namespace top {
 
@@ -43,6 +48,9 @@ struct CallbackItem {
     int32_t expect_count;
     std::shared_ptr<std::mutex> wait_mutex;
     std::shared_ptr<std::condition_variable> wait_condition;
+    // request type for RpcStats, if unknown the response type is used
+    int32_t message_type{kRpcTypeUnknown};
+    std::chrono::steady_clock::time_point add_time{};  // set by Add
 
     ~CallbackItem();
 };
@@ -59,6 +67,12 @@ public:
             int32_t timeout_sec,
             ResponseFunctor callback,
             int32_t expect_count);
+    void Add(
+            uint32_t message_id,
+            int32_t timeout_sec,
+            ResponseFunctor callback,
+            int32_t expect_count,
+            int32_t message_type);
     void Add(CallbackItemPtr callback_ptr);
     void Callback(
             uint32_t message_id,
@@ -66,16 +80,26 @@ public:
             base::xpacket_t& packet);
     void Timeout(uint32_t message_id);
     void Cancel(uint32_t message_id, uint32_t no_callback);
+    RpcStats& rpc_stats() {
+        return rpc_stats_;
+    }
 
 private:
     CallbackManager();
     ~CallbackManager();
 
     void TimeoutCheck();
+    void Cancel(uint32_t message_id, uint32_t no_callback, bool timed_out);
+    // called with callback_map_mutex_ held
+    void AddTimedOut(uint32_t message_id, int32_t message_type);
 
     static std::atomic<uint32_t> msg_id_;
     std::map<uint32_t, CallbackItemPtr> callback_map_;
-    std::mutex callback_map_mutex_;
+    KadMutex callback_map_mutex_;
+    // recently timed out requests, a response to one of them is late
+    std::unordered_map<uint32_t, int32_t> timed_out_map_;
+    std::deque<uint32_t> timed_out_queue_;  // oldest first
+    RpcStats rpc_stats_;
     base::SingleThreadTimer timer_;
 
     DISALLOW_COPY_AND_ASSIGN(CallbackManager);
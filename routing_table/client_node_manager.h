@@ -11,6 +11,8 @@
 #include <memory>
 
 #include "xkad/routing_table/routing_utils.h"
+#include "xkad/routing_table/lock_stats.h"
+#include "xkad/routing_table/memory_stats.h"
 
 namespace top {
 
@@ -33,19 +35,24 @@ private:
 
 typedef std::shared_ptr<ClientNodeInfo> ClientNodeInfoPtr;
 
+// a ClientNodeInfo with its control block and strings
+uint64_t ClientNodeInfoBytes(const ClientNodeInfo& node);
+
 class ClientNodeManager {
 public:
     static ClientNodeManager* Instance();
     int AddClientNode(ClientNodeInfoPtr node_ptr);
     void RemoveClientNode(const std::string& node_id);
     ClientNodeInfoPtr FindClientNode(const std::string& node_id);
+    void GetMemoryUsage(MemoryUsage& usage);
 
 private:
     ClientNodeManager();
     ~ClientNodeManager();
 
     std::map<std::string, ClientNodeInfoPtr> client_nodes_map_;
-    std::mutex client_nodes_map_mutex_;
+    KadMutex client_nodes_map_mutex_;
+    uint32_t memory_reporter_id_;
 
     DISALLOW_COPY_AND_ASSIGN(ClientNodeManager);
 };
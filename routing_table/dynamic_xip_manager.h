@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "xkad/routing_table/routing_utils.h"
+#include "xkad/routing_table/memory_stats.h"
 
 namespace top {
 
@@ -29,6 +30,7 @@ public:
     void RemoveClientNode(const std::string& dy_xip);
     ClientNodeInfoPtr FindClientNode(const std::string& dy_xip);
     std::string DispatchDynamicXip(const base::XipParser&  local_xip);
+    void GetMemoryUsage(MemoryUsage& usage);
 public:
     DynamicXipManager();
     ~DynamicXipManager();
@@ -0,0 +1,40 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <functional>
+
+namespace top {
+
+namespace kadmlia {
+
+// binary (ip, port) key, ipv4 is stored as ipv4-mapped ipv6 address.
+// an ip that can not be parsed is stored by its 64 bit string hash
+struct EndpointKey {
+public:
+    EndpointKey();
+    EndpointKey(const std::string& ip, uint16_t port);
+    bool operator==(const EndpointKey& other) const;
+    bool operator!=(const EndpointKey& other) const;
+    bool operator<(const EndpointKey& other) const;
+    bool IsIpv4() const;
+    std::string string() const;
+
+public:
+    uint64_t addr_high{ 0 };
+    uint64_t addr_low{ 0 };
+    uint16_t port{ 0 };
+};
+
+struct EndpointKeyHash {
+    size_t operator()(const EndpointKey& key) const;
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,41 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "xkad/routing_table/node_info.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const int kForwardMaxTries = 3;  // next hops tried when sending fails
+static const uint32_t kParallelForwardMax = 4;
+
+// hands out the next hops for a target one by one from a candidate list
+// sorted once, a retry takes the next candidate instead of sorting again
+class ForwardCursor {
+public:
+    // nodes sorted by xor distance to target_id
+    ForwardCursor(const std::string& target_id, std::vector<NodeInfoPtr>&& nodes, bool rtt_aware);
+    ~ForwardCursor();
+    // nullptr when all candidates are used
+    NodeInfoPtr Next();
+    uint32_t remaining() const;
+
+private:
+    std::string target_id_;
+    std::vector<NodeInfoPtr> nodes_;
+    size_t pos_;
+    bool rtt_aware_;
+
+    DISALLOW_COPY_AND_ASSIGN(ForwardCursor);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
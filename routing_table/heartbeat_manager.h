@@ -9,6 +9,10 @@
 #include <functional>
 #include <mutex>
 #include <vector>
+#include <map>
+#include <unordered_map>
+
+#include "xkad/routing_table/endpoint_key.h"
 
 namespace top {
 namespace kadmlia {
@@ -21,7 +25,17 @@ public:
     static void OnHeartbeatCallback(const std::string& ip, uint16_t port);
 
     virtual ~HeartbeatManagerIntf() {}
+    // cb is called for every failed endpoint
     virtual void Register(const std::string& name, OfflineCallback cb) = 0;
+    // cb is called only for the endpoints name subscribed. the defaults keep
+    // older implementations working: a subscriber gets every failed endpoint
+    virtual void RegisterSubscriber(const std::string& name, OfflineCallback cb) {
+        Register(name, cb);
+    }
+    virtual void Unregister(const std::string& name) {}
+    // subscriptions are counted, one endpoint may carry several nodes
+    virtual void Subscribe(const std::string& name, const std::string& ip, uint16_t port) {}
+    virtual void Unsubscribe(const std::string& name, const std::string& ip, uint16_t port) {}
 
 private:
     virtual void OnHeartbeatFailed(const std::string& ip, uint16_t port) = 0;
@@ -30,11 +44,18 @@ private:
 class HeartbeatManager : public HeartbeatManagerIntf {
 public:
     virtual void Register(const std::string& name, OfflineCallback cb) override;
+    virtual void RegisterSubscriber(const std::string& name, OfflineCallback cb) override;
+    virtual void Unregister(const std::string& name) override;
+    virtual void Subscribe(const std::string& name, const std::string& ip, uint16_t port) override;
+    virtual void Unsubscribe(const std::string& name, const std::string& ip, uint16_t port) override;
     virtual void OnHeartbeatFailed(const std::string& ip, uint16_t port) override;
 
 private:
     std::mutex mutex_;
-    std::vector<OfflineCallback> vec_cb_;
+    std::map<std::string, OfflineCallback> broadcast_cb_map_;
+    std::map<std::string, OfflineCallback> subscriber_cb_map_;
+    // endpoint -> (subscriber name -> subscribe count)
+    std::unordered_map<EndpointKey, std::map<std::string, uint32_t>, EndpointKeyHash> endpoint_subscribers_;
 };
 
 }  // namespace kadmlia
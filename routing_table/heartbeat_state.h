@@ -2,31 +2,96 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-// #pragma once
-
-// #include <assert.h>
-// #include <stdint.h>
-// #include <string>
-// #include "xtransport/proto/transport.pb.h"
-// #include "xkad/proto/kadmlia.pb.h"
-
-// namespace top {
-// namespace kadmlia {
-
-// class HeartbeatState {
-// public:
-//     static HeartbeatState& Instance();
-//     virtual void Send(const transport::protobuf::RoutingMessage& message,
-//         const std::string& peer_ip, uint16_t peer_port) = 0;
-//     // virtual void Join() = 0;
-// };
-
-// class HeartbeatStateRecv {
-// public:
-//     static HeartbeatStateRecv& Instance();
-//     virtual void Recv(const transport::protobuf::RoutingMessage& message) = 0;
-//     // virtual void Join() = 0;
-// };
-
-// }  // namespace kadmlia
-// }  // namespace top
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+#include "xpbase/base/top_timer.h"
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+// kad message types by value. upper layer types are not counted, their
+// receives are dispatched by the transport without passing xkad
+static const int kTrafficStatsTypes = kKadMessageTypeMax;
+static const uint32_t kTrafficStatsShards = 8;
+static const uint32_t kTrafficStatsWindowCount = 3;
+static const uint32_t kTrafficStatsWindows[kTrafficStatsWindowCount] = { 1, 5, 30 };  // seconds
+static const uint32_t kTrafficStatsSummaryPeriod = 30;  // seconds
+
+struct TrafficCounters {
+    uint64_t sent_messages{0};
+    uint64_t sent_bytes{0};
+    uint64_t recv_messages{0};
+    uint64_t recv_bytes{0};
+};
+
+struct TrafficStatsInfo {
+    int type{0};
+    TrafficCounters total;
+    TrafficCounters windows[kTrafficStatsWindowCount];  // last kTrafficStatsWindows seconds
+};
+
+std::string TrafficTypeName(int type);
+
+// sent and received messages and bytes per kad message type, the bytes of a
+// packet with its xip2 header on both sides. the counters are sharded by thread
+// and updated without a lock, a second tick keeps the totals for the rolling windows
+class HeartbeatState {
+public:
+    static HeartbeatState* Instance();
+    HeartbeatState();
+    ~HeartbeatState();
+    void Send(int type, uint32_t bytes);
+    void Recv(int type, uint32_t bytes);
+    // one second passed
+    void Tick();
+    // types with traffic, the most bytes sent and received first
+    void Get(std::vector<TrafficStatsInfo>& infos);
+    std::string Dump();
+    void Reset();
+    // ticks every second and logs Dump every summary_period_s, the first call starts
+    void Start(base::TimerManager* timer_manager, uint32_t summary_period_s);
+    void Stop();
+
+private:
+    enum {
+        kSentMessages = 0,
+        kSentBytes,
+        kRecvMessages,
+        kRecvBytes,
+        kCounterCount,
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> counters[kTrafficStatsTypes][kCounterCount];
+    };
+
+    static uint32_t ShardIndex();
+    void Sum(std::vector<TrafficCounters>& totals);
+    void TimerProc();
+
+    Shard shards_[kTrafficStatsShards];
+    // totals at the last ticks, the newest last
+    std::deque<std::vector<TrafficCounters>> history_;
+    std::mutex history_mutex_;
+    std::shared_ptr<base::TimerRepeated> timer_;
+    uint32_t summary_period_s_;
+    uint32_t ticks_;
+    std::mutex timer_mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(HeartbeatState);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
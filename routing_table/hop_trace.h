@@ -0,0 +1,69 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/seq_ring.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint32_t kHopTraceRingSize = 8192;
+
+// one forward of a sampled message. node ids are kept as 64 bit hashes of the
+// kad node id, the records of all nodes joined by trace_id and ordered by
+// hop_num give the path of a message
+struct HopTraceRecord {
+    uint64_t trace_id{0};
+    uint64_t arrival_us{0};  // system clock, comparable across hosts
+    uint64_t node_hash{0};  // this node
+    uint64_t next_hop_hash{0};
+    uint32_t queue_delay_us{0};  // arrival to handing the message to the transport
+    uint32_t message_type{0};
+    uint32_t hop_num{0};
+};
+
+// fixed ring of the latest hop records, see SeqRing
+class HopTracer {
+public:
+    static HopTracer* Instance();
+    // capacity is rounded up to a power of 2
+    explicit HopTracer(uint32_t capacity);
+    ~HopTracer();
+
+    // trace one message in one_in, 0 disables tracing
+    void set_sample_rate(uint32_t one_in) {
+        sample_one_in_.store(one_in, std::memory_order_relaxed);
+    }
+    uint32_t sample_rate() const {
+        return sample_one_in_.load(std::memory_order_relaxed);
+    }
+    bool enabled() const {
+        return sample_rate() != 0;
+    }
+    // every hop decides the same for one trace id
+    bool Sampled(uint64_t trace_id) const;
+    void Record(const HopTraceRecord& record);
+    // the records still in the ring, oldest first
+    void Get(std::vector<HopTraceRecord>& records);
+    // csv with a header line
+    std::string Dump();
+
+private:
+    SeqRing<HopTraceRecord> ring_;
+    std::atomic<uint32_t> sample_one_in_;
+
+    DISALLOW_COPY_AND_ASSIGN(HopTracer);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -6,6 +6,7 @@
 
 #include <string>
 #include <map>
+#include <functional>
 
 #include "xbase/xlog.h"
 #include "xbase/xobject.h"
@@ -40,7 +41,11 @@ public:
     std::shared_ptr<RoutingTable> routing_ptr() { return routing_ptr_; }
 
 private:
+    typedef std::function<void(transport::protobuf::RoutingMessage&, base::xpacket_t&)> KadMessageProc;
+
     void AddBaseHandlers();
+    // counts the received message in HeartbeatState before proc
+    void RegisterKadProcessor(int type, KadMessageProc proc);
     int HandleClientMessage(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet);
     void HandleConnectRequest(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet);
     void HandleHandshake(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet);
@@ -8,6 +8,11 @@
 #include <string>
 #include <mutex>
 #include <list>
+#include <deque>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
 
 #include "xkad/routing_table/routing_utils.h"
@@ -21,6 +26,31 @@ namespace top {
 
 namespace kadmlia {
 
+static const uint32_t kLocalIdentityGraceMs = 60 * 1000;
+
+// identity fields read on the message path. a snapshot is never modified, a
+// change publishes a new one, so readers need no lock and see all fields of
+// one update
+struct LocalIdentity {
+    std::string id;
+    // id for the byte compares of bucket index and distance, zeros unless the
+    // id is kNodeIdSize long. derived from id
+    std::array<uint8_t, kNodeIdSize> id_bytes{};
+    std::string xid;
+    std::string local_ip;
+    uint16_t local_port{ 0 };
+    std::string public_ip;
+    uint16_t public_port{ 0 };
+    std::string idtype;
+
+    bool operator==(const LocalIdentity& other) const {
+        return id == other.id && xid == other.xid &&
+                local_ip == other.local_ip && local_port == other.local_port &&
+                public_ip == other.public_ip && public_port == other.public_port &&
+                idtype == other.idtype;
+    }
+};
+
 class LocalNodeInfo {
 public:
     LocalNodeInfo();
@@ -37,25 +67,29 @@ public:
             uint32_t role);
     void Reset();
     bool IsPublicNode() const;
-    std::string kad_key();
-    std::string xid();
+    // fields of the current snapshot, the same lifetime as identity(). take
+    // identity() once to read several fields of one update
+    const std::string& kad_key() const { return identity().id; }
+    const std::string& xid() const { return identity().xid; }
     std::string xip();
-    std::string id();
+    const std::string& id() const { return identity().id; }
     base::XipParser& GetXipParser();
-    std::string local_ip() { return local_ip_; }
-    uint16_t local_port() { return local_port_; }
-    void set_local_port(uint16_t local_port) { local_port_ = local_port; }
+    const std::string& local_ip() const { return identity().local_ip; }
+    uint16_t local_port() const { return identity().local_port; }
+    void set_local_port(uint16_t local_port);
     bool first_node() { return first_node_; }
     void set_first_node(bool first_node) { first_node_ = first_node; }
     bool client_mode() { return client_mode_; }
     std::string private_key() { return private_key_; }
     std::string public_key() { return public_key_; }
-    std::string public_ip() { return public_ip_; }
-    std::string idtype() { return idtype_; }
-    uint16_t public_port() { return public_port_; }
+    const std::string& public_ip() const { return identity().public_ip; }
+    const std::string& idtype() const { return identity().idtype; }
+    uint16_t public_port() const { return identity().public_port; }
     int32_t nat_type() { return nat_type_; }
-    void set_public_ip(const std::string& ip) { public_ip_ = ip; }
-    void set_public_port(uint16_t port) { public_port_ = port; }
+    void set_public_ip(const std::string& ip);
+    void set_public_port(uint16_t port);
+    // both in one snapshot, readers never see the new ip with the old port
+    void set_public_endpoint(const std::string& ip, uint16_t port);
     uint64_t service_type() { return service_type_; }
     void set_service_type(uint64_t service_type) { service_type_ = service_type; }
     uint32_t routing_table_id() { return routing_table_id_; }
@@ -66,10 +100,7 @@ public:
         std::lock_guard<std::mutex> lock(kadkey_mutex_);
         return kadmlia_key_; 
     }
-    void set_kadmlia_key(base::KadmliaKeyPtr kadmlia_key) { 
-        std::lock_guard<std::mutex> lock(kadkey_mutex_);
-        kadmlia_key_ = kadmlia_key; 
-    }
+    void set_kadmlia_key(base::KadmliaKeyPtr kadmlia_key);
     uint32_t score() { return score_; }
     void set_xip(const std::string& xip_str);
     inline bool use_kad_key() {
@@ -88,20 +119,35 @@ public:
     bool is_root() { return is_root_; }
     void set_is_root(bool root) { is_root_ = root; }
     uint64_t hash64() { return hash64_; }
+    // the current snapshot, lock free. a replaced one is freed kLocalIdentityGraceMs
+    // after the change: keep the reference for one message or loop, copy the
+    // fields kept longer
+    const LocalIdentity& identity() const {
+        return *identity_.load(std::memory_order_acquire);
+    }
 
 private:
-    std::string local_ip_;
-    uint16_t local_port_{ 0 };
+    struct RetiredIdentity {
+        std::unique_ptr<const LocalIdentity> identity;
+        std::chrono::steady_clock::time_point retired_time;
+    };
+
+    // publishes a changed copy of the current snapshot, nothing if unchanged
+    void UpdateIdentity(std::function<void(LocalIdentity&)> update);
+
+    // owns the snapshot identity_ points to, guarded by identity_mutex_ like
+    // retired_identities_
+    std::unique_ptr<const LocalIdentity> current_identity_;
+    std::atomic<const LocalIdentity*> identity_;
+    std::deque<RetiredIdentity> retired_identities_;
+    std::mutex identity_mutex_;  // serializes the writers
     uint16_t rpc_http_port_{ 0 };
     uint16_t rpc_ws_port_{ 0 };
     bool first_node_{ false };
     bool client_mode_{ false };
     std::string private_key_;
     std::string public_key_;
-    std::string public_ip_;
-    uint16_t public_port_{ 0 };
     int32_t nat_type_{kNatTypeUnknown};
-    std::string idtype_;
     uint64_t service_type_{ kInvalidType };
     uint32_t routing_table_id_{0};
     uint32_t role_{ kRoleInvalid };
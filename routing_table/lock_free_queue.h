@@ -0,0 +1,109 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include <utility>
+
+#include "xpbase/base/top_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+// bounded multi-producer multi-consumer queue, every slot carries a sequence
+// number so push and pop only need one cas on the shared position
+template <typename T>
+class LockFreeQueue {
+public:
+    // capacity is rounded up to a power of 2
+    explicit LockFreeQueue(uint32_t capacity)
+            : mask_(RoundUp(capacity) - 1),
+              slots_(mask_ + 1),
+              push_pos_(0),
+              pop_pos_(0) {
+        for (uint32_t i = 0; i <= mask_; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // false if the queue is full
+    bool Push(T value) {
+        uint64_t pos = push_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            uint64_t seq = slot->seq.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)pos;
+            if (diff == 0) {
+                if (push_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = push_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // false if the queue is empty
+    bool Pop(T& value) {
+        uint64_t pos = pop_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            uint64_t seq = slot->seq.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+            if (diff == 0) {
+                if (pop_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = pop_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        slot->value = T();
+        slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq;
+        T value;
+    };
+
+    static uint32_t RoundUp(uint32_t capacity) {
+        uint32_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const uint32_t mask_;
+    std::vector<Slot> slots_;
+    std::atomic<uint64_t> push_pos_;
+    std::atomic<uint64_t> pop_pos_;
+
+    DISALLOW_COPY_AND_ASSIGN(LockFreeQueue);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
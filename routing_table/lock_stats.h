@@ -0,0 +1,118 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <condition_variable>
+
+#include "xpbase/base/top_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+// bucket i counts times in [2^i, 2^(i+1)) ns, the last bucket is open
+static const uint32_t kLockStatsBuckets = 32;
+
+struct LockStatsInfo {
+    std::string name;
+    uint64_t acquisitions{0};
+    uint64_t contended{0};  // acquisitions that found the lock taken
+    uint64_t wait_ns{0};  // total
+    uint64_t hold_ns{0};  // total
+    uint64_t max_wait_ns{0};
+    uint64_t max_hold_ns{0};
+    std::vector<uint64_t> wait_histogram;
+    std::vector<uint64_t> hold_histogram;
+};
+
+// upper bound of the bucket holding the percent-th percentile, 0 if empty
+uint64_t LockStatsPercentileNs(const std::vector<uint64_t>& histogram, double percent);
+
+// counters of one lock name, updated without a lock
+class LockStatsEntry {
+public:
+    explicit LockStatsEntry(const std::string& name);
+    void RecordWait(uint64_t wait_ns, bool contended);
+    void RecordHold(uint64_t hold_ns);
+    void Get(LockStatsInfo& info);
+    void Reset();
+
+private:
+    static uint32_t Bucket(uint64_t ns);
+    static void UpdateMax(std::atomic<uint64_t>& max_ns, uint64_t ns);
+
+    std::string name_;
+    std::atomic<uint64_t> acquisitions_;
+    std::atomic<uint64_t> contended_;
+    std::atomic<uint64_t> wait_ns_;
+    std::atomic<uint64_t> hold_ns_;
+    std::atomic<uint64_t> max_wait_ns_;
+    std::atomic<uint64_t> max_hold_ns_;
+    std::atomic<uint64_t> wait_histogram_[kLockStatsBuckets];
+    std::atomic<uint64_t> hold_histogram_[kLockStatsBuckets];
+
+    DISALLOW_COPY_AND_ASSIGN(LockStatsEntry);
+};
+
+// all instrumented locks by name, the locks of every routing table with the same
+// name share one entry. entries live until the process exits
+class LockStats {
+public:
+    static LockStats* Instance();
+    LockStatsEntry* GetEntry(const std::string& name);
+    // sorted by total wait time, the most waited lock first
+    void GetAll(std::vector<LockStatsInfo>& infos);
+    std::string Dump();
+    void Reset();
+
+private:
+    LockStats();
+    ~LockStats();
+
+    std::map<std::string, std::unique_ptr<LockStatsEntry>> entries_;
+    std::mutex entries_mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(LockStats);
+};
+
+// std::mutex that records wait and hold times of every acquisition
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const char* name);
+    void lock();
+    bool try_lock();
+    void unlock();
+
+private:
+    std::mutex mutex_;
+    LockStatsEntry* entry_;
+    std::chrono::steady_clock::time_point acquired_;  // guarded by mutex_
+
+    DISALLOW_COPY_AND_ASSIGN(InstrumentedMutex);
+};
+
+// the routing table locks, instrumented when built with XKAD_LOCK_STATS.
+// members are constructed with XKAD_LOCK_NAME("Class::member_")
+#ifdef XKAD_LOCK_STATS
+typedef InstrumentedMutex KadMutex;
+typedef std::condition_variable_any KadConditionVariable;
+#define XKAD_LOCK_NAME(name) name
+#else
+typedef std::mutex KadMutex;
+typedef std::condition_variable KadConditionVariable;
+#define XKAD_LOCK_NAME(name)
+#endif
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,84 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <functional>
+
+#include "xpbase/base/top_timer.h"
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/node_info.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint32_t kMemoryStatsSamplePeriod = 10;  // seconds
+// per element overhead of the standard containers on 64 bit libstdc++
+static const uint64_t kMapNodeBytes = 32;  // rb tree links and color
+static const uint64_t kHashNodeBytes = 16;  // next link and cached hash
+static const uint64_t kSharedPtrBlockBytes = 16;  // counts of make_shared
+
+struct MemoryUsage {
+    std::string name;
+    uint64_t entries{0};
+    uint64_t bytes{0};  // approximate, containers and string heap included
+    uint64_t peak_entries{0};  // high-water marks seen by MemoryStats
+    uint64_t peak_bytes{0};
+};
+
+// returns the usages of one subsystem, appended to usages
+typedef std::function<void(std::vector<MemoryUsage>& usages)> MemoryReporter;
+
+// heap bytes of a string, 0 while it fits the small string buffer
+uint64_t StringHeapBytes(const std::string& str);
+// a NodeInfo with its control block and strings, not its udp_property
+uint64_t NodeInfoBytes(const NodeInfo& node);
+
+// live memory of the registered subsystems. the reporters are asked on Get and
+// every kMemoryStatsSamplePeriod after Start, the high-water marks are kept by name
+class MemoryStats {
+public:
+    static MemoryStats* Instance();
+    MemoryStats();
+    ~MemoryStats();
+    // the reporter is called under the stats lock, so Unregister waits for a running one
+    uint32_t Register(MemoryReporter reporter);
+    void Unregister(uint32_t reporter_id);
+    // the largest first
+    void Get(std::vector<MemoryUsage>& usages);
+    // one line per subsystem and the total
+    std::string Dump();
+    void ResetPeaks();
+    // samples every sample_period_s for the high-water marks, the first call starts
+    void Start(base::TimerManager* timer_manager, uint32_t sample_period_s);
+    void Stop();
+
+private:
+    struct Peak {
+        uint64_t entries{0};
+        uint64_t bytes{0};
+    };
+
+    void Sample(std::vector<MemoryUsage>& usages);
+
+    std::map<uint32_t, MemoryReporter> reporters_;
+    std::map<std::string, Peak> peaks_;
+    uint32_t next_reporter_id_;
+    std::mutex mutex_;
+    std::shared_ptr<base::TimerRepeated> timer_;
+    std::mutex timer_mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(MemoryStats);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -12,6 +13,8 @@
 
 #include "xpbase/base/top_timer.h"
 #include "xkad/routing_table/routing_utils.h"
+#include "xkad/routing_table/endpoint_key.h"
+#include "xkad/routing_table/sim_scheduler_intf.h"
 
 namespace top {
 
@@ -23,6 +26,8 @@ class RoutingTable;
 class NodeDetectionManager {
 public:
     explicit NodeDetectionManager(base::TimerManager* timer_manager, RoutingTable& routing_table);
+    // detection runs on the simulation clock
+    NodeDetectionManager(SimSchedulerIntfPtr sim_scheduler, RoutingTable& routing_table);
     ~NodeDetectionManager();
     void Join();
     int AddDetectionNode(std::shared_ptr<NodeInfo> node_ptr);
@@ -33,13 +38,15 @@ private:
     void DoTetection();
     int Handshake(std::shared_ptr<NodeInfo> node_ptr);
 
-    std::map<std::string, std::shared_ptr<NodeInfo>> detection_nodes_map_;
+    std::unordered_map<EndpointKey, std::shared_ptr<NodeInfo>, EndpointKeyHash> detection_nodes_map_;
     std::mutex detection_nodes_map_mutex_;
     std::map<std::string, std::shared_ptr<NodeInfo>> detected_nodes_map_;
     std::mutex detected_nodes_map_mutex_;
     RoutingTable& routing_table_;
     base::TimerManager* timer_manager_{nullptr};
     std::shared_ptr<base::TimerRepeated> timer_;
+    SimSchedulerIntfPtr sim_scheduler_;
+    uint64_t sim_task_id_{ 0 };
     bool destroy_{ false };
 
     DISALLOW_COPY_AND_ASSIGN(NodeDetectionManager);
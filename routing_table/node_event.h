@@ -0,0 +1,70 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "xkad/routing_table/node_info.h"
+#include "xkad/routing_table/lock_free_queue.h"
+
+namespace top {
+
+namespace kadmlia {
+
+enum NodeEventType {
+    kNodeEventAdded = 0,
+    kNodeEventDropped,
+    kNodeEventUpdated,  // rtt or other live info of a node in the table changed
+    kNodeEventResync,   // events were lost, rebuild the view from nodes(), node is null
+};
+
+struct NodeEvent {
+    int type{ kNodeEventAdded };
+    NodeInfoPtr node;
+    uint64_t generation{ 0 };  // routing table generation after the change
+};
+
+typedef std::function<void(const NodeEvent&)> NodeEventCallback;
+
+static const uint32_t kNodeEventQueueSize = 4096;
+
+// routing table changes are published from any thread without a lock and
+// delivered to the subscribers in order by Dispatch
+class NodeEventDispatcher {
+public:
+    NodeEventDispatcher();
+    explicit NodeEventDispatcher(uint32_t queue_size);
+    ~NodeEventDispatcher();
+    uint32_t Subscribe(NodeEventCallback callback);
+    void Unsubscribe(uint32_t subscription_id);
+    void Publish(int type, NodeInfoPtr node, uint64_t generation);
+    // deliver the queued events, returns the count delivered
+    uint32_t Dispatch();
+    bool HasSubscriber() {
+        return has_subscriber_;
+    }
+
+private:
+    LockFreeQueue<NodeEvent> queue_;
+    std::atomic<bool> overflow_;
+    std::atomic<uint64_t> last_generation_;
+    std::atomic<bool> has_subscriber_;
+    std::map<uint32_t, NodeEventCallback> subscribers_;
+    std::mutex subscribers_mutex_;
+    uint32_t next_subscription_id_;
+    std::mutex dispatch_mutex_;  // one dispatcher at a time keeps the order
+
+    DISALLOW_COPY_AND_ASSIGN(NodeEventDispatcher);
+};
+
+typedef std::shared_ptr<NodeEventDispatcher> NodeEventDispatcherPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <memory>
 #include <chrono>
 
@@ -24,6 +25,8 @@ public:
     NodeInfo();
     NodeInfo(const NodeInfo& other);
     NodeInfo(const std::string& id);
+    // udp_property as given, null until a table shares the PeerStore one on AddNode
+    NodeInfo(const std::string& id, transport::UdpPropertyPtr property);
     ~NodeInfo();
     NodeInfo& operator=(const NodeInfo& other);
     bool operator < (const NodeInfo& other) const;
@@ -32,32 +35,47 @@ public:
     bool IsTimeout(std::chrono::steady_clock::time_point tp_now);
     bool IsTimeToHeartbeat(std::chrono::steady_clock::time_point tp_now);
     void Heartbeat();
+    void Heartbeat(std::chrono::steady_clock::time_point tp_now);
     void ResetHeartbeat();
+    void ResetHeartbeat(std::chrono::steady_clock::time_point tp_now);
+    // smooth rtt with a new sample, like tcp srtt
+    void UpdateRtt(uint32_t sample_ms);
 
 public:
+    // hot fields used by routing table iteration, sorting and heartbeating,
+    // kept together on the first cache line (64 bytes on x86_64)
     std::string node_id;
+    uint64_t hash64{ 0 };
+    std::chrono::steady_clock::time_point tp_next_time_to_heartbeat;
     int bucket_index{ kInvalidBucketIndex };
-    std::string public_ip;
+    int32_t heartbeat_count{ 0 };  // count > 3
+    std::atomic<uint32_t> rtt_ms{ 0 };  // smoothed rtt, 0 if no sample yet, relaxed
     uint16_t public_port{ 0 };
-    std::string local_ip;
     uint16_t local_port{ 0 };
+
+    // cold fields, ordered by size to avoid padding
+    std::string public_ip;
+    std::string local_ip;
+    std::string xid;
+    std::string xip;
+    transport::UdpPropertyPtr udp_property;
+    uint64_t service_type{ 0 };
     int32_t connection_id{ 0 };
     int32_t detection_count{ 0 };
     int32_t nat_type{ 0 };
     int32_t detection_delay_count{ 0 };
-    int32_t heartbeat_count{ 0 };  // count > 3
-    uint64_t service_type{ 0 };
+    uint32_t score{ 0 };
+    // RoutingTable::Now() in ms of the last message from the node, relaxed
+    std::atomic<int64_t> last_seen_ms{ 0 };
     bool is_client{ false };
-    std::chrono::steady_clock::time_point tp_next_time_to_heartbeat;
     bool same_vlan{ false };
-    std::string xid;
-    std::string xip;
-    uint32_t score{ 0 };
-    uint64_t hash64{ 0 };
-	transport::UdpPropertyPtr udp_property;
 };
 
 typedef std::shared_ptr<NodeInfo> NodeInfoPtr;
 
+// NodeInfo and its shared_ptr control block in one pooled allocation. no
+// udp_property is allocated, AddNode and AddNodes set the PeerStore one
+NodeInfoPtr NewNodeInfo(const std::string& id);
+
 }  // namespace kadmlia
 }  // namespace top
@@ -0,0 +1,96 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <vector>
+
+namespace top {
+namespace kadmlia {
+
+static const uint32_t kObjectPoolMaxFree = 256;
+
+// allocator keeping freed single objects in a per thread free list, for
+// std::allocate_shared of short lived objects created per message. no lock,
+// a block freed on another thread is kept by that thread
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+
+    PoolAllocator() {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n == 1 && alive_) {
+            auto& blocks = FreeBlocks().blocks;
+            if (!blocks.empty()) {
+                void* block = blocks.back();
+                blocks.pop_back();
+                return static_cast<T*>(block);
+            }
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        if (n == 1 && alive_) {
+            auto& blocks = FreeBlocks().blocks;
+            if (blocks.size() < kObjectPoolMaxFree) {
+                blocks.push_back(ptr);
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+    // blocks cached by the calling thread
+    static size_t free_size() {
+        return alive_ ? FreeBlocks().blocks.size() : 0;
+    }
+
+private:
+    struct BlockList {
+        BlockList() {
+            blocks.reserve(kObjectPoolMaxFree);
+            alive_ = true;
+        }
+        ~BlockList() {
+            alive_ = false;
+            for (auto block : blocks) {
+                ::operator delete(block);
+            }
+        }
+        std::vector<void*> blocks;
+    };
+
+    static BlockList& FreeBlocks() {
+        static thread_local BlockList list;
+        return list;
+    }
+
+    // false once the thread's list is destroyed, objects freed later in thread
+    // exit go to the heap. trivially destructible so it outlives the list
+    static thread_local bool alive_;
+};
+
+template <typename T>
+thread_local bool PoolAllocator<T>::alive_ = true;
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return false;
+}
+
+}  // namespace kadmlia
+}  // namespace top
@@ -0,0 +1,72 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <memory>
+
+#include "xkad/routing_table/node_info.h"
+#include "xkad/routing_table/rpc_stats.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint32_t kRttPendingTimeoutMs = 10 * 1000;  // request without response
+static const uint32_t kRttPendingMaxSize = 4096;
+static const int kRttNextHopCandidates = kKadParamK;
+
+// send time of outgoing requests (handshake, find nodes) by message id, the
+// response carries the same id back. requests, responses and timeouts are
+// counted by request type in rpc_stats if given. the caller passes the
+// time, so samples follow the routing table clock
+class RttSampler {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    explicit RttSampler(RpcStats* rpc_stats = nullptr);
+    ~RttSampler();
+    void Sent(uint32_t message_id, int message_type, TimePoint now);
+    // true and rtt_ms set if message_id is a pending request
+    bool Received(uint32_t message_id, TimePoint now, uint32_t& rtt_ms);
+    uint32_t size();
+
+private:
+    struct Pending {
+        TimePoint sent_time;
+        int message_type;
+    };
+
+    void EraseExpired(TimePoint now);
+
+    std::unordered_map<uint32_t, Pending> pending_;
+    TimePoint last_expire_time_;
+    RpcStats* rpc_stats_;
+    std::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(RttSampler);
+};
+
+typedef std::shared_ptr<RttSampler> RttSamplerPtr;
+
+// nodes are sorted by xor distance to target_id. among the leading nodes in the same
+// bucket of target_id as nodes[0] (equivalent xor progress) return the one with the
+// lowest known rtt, nodes[0] if none has a sample
+NodeInfoPtr SelectLowLatencyNode(
+        const std::string& target_id,
+        const std::vector<NodeInfoPtr>& nodes);
+// same choice over nodes[start, end), returns the index, start if nothing is better
+size_t SelectLowLatencyIndex(
+        const std::string& target_id,
+        const std::vector<NodeInfoPtr>& nodes,
+        size_t start);
+
+}  // namespace kadmlia
+
+}  // namespace top
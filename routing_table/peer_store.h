@@ -0,0 +1,49 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/endpoint_key.h"
+#include "xtransport/transport_fwd.h"
+
+namespace top {
+namespace kadmlia {
+
+static const uint32_t kPeerStorePruneInterval = 1024;
+
+// process-wide per physical peer state. the routing tables of all service types
+// in the process share one record per peer endpoint, the record lives as long
+// as a node of some table refers to it.
+// only the udp property is shared: the id and address strings of NodeInfo stay
+// per table copies, std::string can not share its buffer
+class PeerStore {
+public:
+    static PeerStore* Instance();
+
+    PeerStore();
+    ~PeerStore();
+    // udp property of the peer at (ip, port), created on first use
+    transport::UdpPropertyPtr GetUdpProperty(const std::string& ip, uint16_t port);
+    // peers still referred to
+    uint32_t size();
+
+private:
+    void Prune();
+
+    std::unordered_map<EndpointKey, std::weak_ptr<transport::UdpProperty>, EndpointKeyHash> peers_;
+    uint32_t gets_since_prune_;
+    std::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(PeerStore);
+};
+
+}  // namespace kadmlia
+}  // namespace top
@@ -0,0 +1,65 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <memory>
+
+#include "xkad/routing_table/node_info.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint32_t kReplacementCacheSize = 4;  // candidates per bucket
+static const uint32_t kReplacementCacheTimeoutMs = 60 * 1000;  // candidate not seen since is stale
+static const int32_t kReplacementProbeMaxMiss = 3;  // unanswered probes before eviction
+static const uint32_t kReplacementProbeIntervalMs = 2 * 1000;  // per bucket
+
+// per k-bucket LRU of candidates rejected because the bucket was full,
+// the most recent live candidate replaces a dropped bucket member
+class ReplacementCache {
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    ReplacementCache();
+    ReplacementCache(uint32_t bucket_capacity, uint32_t timeout_ms);
+    ~ReplacementCache();
+    // node->bucket_index must be set, a cached node is moved to the front.
+    // now is the routing table clock
+    void Add(NodeInfoPtr node, TimePoint now);
+    void Remove(const std::string& node_id, int bucket_index);
+    // most recent live candidate of the bucket, nullptr if none
+    NodeInfoPtr Pop(int bucket_index, TimePoint now);
+    uint32_t size();
+    uint32_t bucket_size(int bucket_index);
+    // approximate, the cached nodes included
+    uint64_t bytes();
+
+private:
+    struct Candidate {
+        NodeInfoPtr node;
+        TimePoint seen;
+    };
+    typedef std::list<Candidate> CandidateList;
+
+    uint32_t bucket_capacity_;
+    std::chrono::milliseconds timeout_;
+    std::map<int, CandidateList> buckets_;  // front is the most recent
+    uint32_t size_;
+    std::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(ReplacementCache);
+};
+
+typedef std::shared_ptr<ReplacementCache> ReplacementCachePtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,55 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <mutex>
+#include <string>
+#include <memory>
+
+#include "xkad/routing_table/node_info.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint32_t kRouteCacheMaxSize = 1024;  // destinations
+static const uint32_t kRouteCacheCandidates = 16;  // next hops kept per destination
+
+// LRU of the closest next hops per destination id. an entry is valid only for
+// the routing table generation it was computed at
+class RouteCache {
+public:
+    RouteCache();
+    explicit RouteCache(uint32_t max_size);
+    ~RouteCache();
+    // nodes sorted by distance to des_node_id, at most kRouteCacheCandidates are kept
+    void Put(const std::string& des_node_id, uint64_t generation, const std::vector<NodeInfoPtr>& nodes);
+    bool Get(const std::string& des_node_id, uint64_t generation, std::vector<NodeInfoPtr>& nodes);
+    void Clear();
+    uint32_t size();
+
+private:
+    struct Entry {
+        uint64_t generation;
+        std::vector<NodeInfoPtr> nodes;
+        std::list<std::string>::iterator lru_iter;
+    };
+
+    uint32_t max_size_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  // front is the most recent
+    std::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(RouteCache);
+};
+
+typedef std::shared_ptr<RouteCache> RouteCachePtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
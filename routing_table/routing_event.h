@@ -0,0 +1,97 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/seq_ring.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint32_t kRoutingEventRingSize = 1024;
+static const uint32_t kRoutingEventDumpInterval = 60;  // seconds between anomaly dumps
+
+enum RoutingEventType {
+    kRoutingEventAdded = 0,
+    kRoutingEventRejected,  // bucket full, kept as a replacement candidate
+    kRoutingEventDropped,
+    kRoutingEventUnjoined,  // the table became empty or offline
+};
+
+enum RoutingEventReason {
+    kRoutingReasonNone = 0,
+    kRoutingReasonApi,        // DropNode called from outside the table
+    kRoutingReasonBucketFull,
+    kRoutingReasonHeartbeat,  // heartbeat timeout or failure
+    kRoutingReasonEvicted,    // full bucket member missed the replacement probes
+    kRoutingReasonQuit,       // the node said it quits
+    kRoutingReasonEmpty,      // all neighbours dropped
+    kRoutingReasonOffline,    // only virtual nodes of the local node left
+};
+
+// one routing table change, fixed size so recording costs no allocation.
+// the peer is a 64 bit hash of its kad node id
+struct RoutingEvent {
+    uint64_t time_us{0};  // system clock
+    uint64_t peer_hash{0};
+    uint32_t generation{0};  // low bits of the table generation after the change
+    uint16_t table_size{0};
+    int16_t bucket{0};
+    uint16_t peer_port{0};
+    uint8_t type{kRoutingEventAdded};
+    uint8_t reason{kRoutingReasonNone};
+};
+
+const char* RoutingEventTypeName(int type);
+const char* RoutingEventReasonName(int reason);
+
+// flight recorder of the latest routing table changes. Record is a few stores
+// into a SeqRing, the ring is formatted only when it is dumped
+class RoutingEventRecorder {
+public:
+    // capacity is rounded up to a power of 2
+    explicit RoutingEventRecorder(uint32_t capacity);
+    ~RoutingEventRecorder();
+    void Record(const RoutingEvent& event);
+    void Record(
+            int type,
+            int reason,
+            uint64_t peer_hash,
+            uint16_t peer_port,
+            int bucket,
+            uint32_t table_size,
+            uint64_t generation);
+    // the events still in the ring, oldest first
+    void Get(std::vector<RoutingEvent>& events);
+    // one line per event, oldest first
+    std::string Dump();
+    // Dump for an anomaly, false if one was dumped in the last kRoutingEventDumpInterval
+    bool DumpAnomaly(std::string& dump);
+    uint64_t recorded() const {
+        return ring_.pushed();
+    }
+    uint64_t bytes() const {
+        return sizeof(*this) + ring_.bytes() - sizeof(ring_);
+    }
+
+private:
+    SeqRing<RoutingEvent> ring_;
+    std::atomic<uint64_t> last_anomaly_us_;
+
+    DISALLOW_COPY_AND_ASSIGN(RoutingEventRecorder);
+};
+
+typedef std::shared_ptr<RoutingEventRecorder> RoutingEventRecorderPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -8,11 +8,13 @@
 #include <mutex>
 #include <map>
 #include <unordered_set>
+#include <unordered_map>
 #include <string>
 #include <memory>
 #include <thread>
 #include <condition_variable>
 #include <set>
+#include <deque>
 
 #include "xpbase/base/top_timer.h"
 #include "xpbase/base/top_config.h"
@@ -21,12 +23,24 @@
 #include "xpbase/base/xid/xid_generator.h"
 #include "xkad/routing_table/routing_utils.h"
 #include "xkad/routing_table/node_info.h"
+#include "xkad/routing_table/endpoint_key.h"
 #include "xkad/proto/kadmlia.pb.h"
 #include "xkad/routing_table/callback_manager.h"
 #include "xkad/routing_table/bootstrap_cache_helper.h"
 // #include "xkad/gossip/rumor_handler.h"
 #include "xkad/routing_table/local_node_info.h"
 #include "xkad/routing_table/dynamic_xip_manager.h"
+#include "xkad/routing_table/bootstrap_join_limiter.h"
+#include "xkad/routing_table/replacement_cache.h"
+#include "xkad/routing_table/peer_rtt.h"
+#include "xkad/routing_table/bucket_capacity.h"
+#include "xkad/routing_table/route_cache.h"
+#include "xkad/routing_table/forward_cursor.h"
+#include "xkad/routing_table/node_event.h"
+#include "xkad/routing_table/sim_scheduler_intf.h"
+#include "xkad/routing_table/lock_stats.h"
+#include "xkad/routing_table/routing_event.h"
+#include "xkad/routing_table/memory_stats.h"
 #include "xsecurity/xsecurity_join.hpp"
 #include "xbase/xbase.h"
 #include "heartbeat_manager.h"
@@ -56,7 +70,12 @@ public:
     virtual bool Init();
     virtual bool UnInit();
     virtual int AddNode(NodeInfoPtr node);
+    // add nodes under one lock per index and publish one snapshot, returns the added count
+    uint32_t AddNodes(const std::vector<NodeInfoPtr>& nodes);
+    // drop for kRoutingReasonApi
     virtual int DropNode(NodeInfoPtr node);
+    // reason: RoutingEventReason for the flight recorder
+    virtual int DropNode(NodeInfoPtr node, int reason);
     virtual void GetPubEndpoints(std::vector<std::string>& public_endpoints);
     virtual void GetBootstrapCache(std::set<std::pair<std::string, uint16_t>>& boot_endpoints);
     virtual bool IsDestination(const std::string& des_node_id, bool check_closest);
@@ -112,6 +131,7 @@ public:
     void SortNodesByTargetXid(const std::string& target_xid, std::vector<NodeInfoPtr>& nodes);
 //     void SpreadAllNeighborsRapid(transport::protobuf::RoutingMessage&);
 //     bool SupportRumor(bool just_root);
+    // a candidate rejected by a full bucket is cached, see CacheReplacement
     bool CanAddNode(NodeInfoPtr node);
     NodeInfoPtr GetRandomNode();
     void SetVersion(transport::protobuf::RoutingMessage& message);
@@ -156,6 +176,9 @@ public:
     void SendToClosestNode(transport::protobuf::RoutingMessage& message);
     void SendToClosestNode(transport::protobuf::RoutingMessage& message, bool add_hop);
     void ResetNodeHeartbeat(const std::string& id);
+    // a message from the node: it is alive, resets its missed probes and
+    // moves it last in the least-recently-seen order of its bucket
+    void NodeSeen(const std::string& id);
     bool CloserToTarget(
         const std::string& id1,
         const std::string& id2,
@@ -199,12 +222,53 @@ public:
     DynamicXipManagerPtr get_dy_manager() {
         return dy_manager_;
     }
+    // probe the least-recently-seen member before rejecting a candidate of a full bucket
+    void set_probe_full_bucket(bool probe) {
+        probe_full_bucket_ = probe;
+    }
+    // prefer the lowest rtt next hop among nodes with equivalent xor progress
+    void set_rtt_aware_next_hop(bool rtt_aware) {
+        rtt_aware_next_hop_ = rtt_aware;
+    }
+    // bootstrap join admission on seed nodes, 0 disables a limit, set after Init
+    void SetJoinLimits(uint32_t max_per_second, uint32_t source_burst);
+    // overrides the service type policy, existing nodes above the new capacity are kept
+    void set_bucket_capacity_policy(const BucketCapacityPolicy& policy);
+    BucketCapacityPolicy bucket_capacity_policy();
+    // forward messages of message_type to the count closest next hops at once
+    // (latency critical types, the destination may get duplicates), 1 to disable
+    void SetParallelForward(int message_type, uint32_t count);
+    // bumped whenever a node is added or dropped
+    uint64_t generation() {
+        return generation_;
+    }
+    // node added/dropped/updated events, delivered on the routing table timer in
+    // publish order, a resync event means events were lost and views should be rebuilt
+    uint32_t SubscribeNodeEvents(NodeEventCallback callback);
+    void UnsubscribeNodeEvents(uint32_t subscription_id);
+    void DispatchNodeEvents();
+    // run the table's periodic procs on a virtual clock instead of timer threads,
+    // set before Init
+    void set_sim_scheduler(SimSchedulerIntfPtr sim_scheduler) {
+        sim_scheduler_ = sim_scheduler;
+    }
+    // track a request sent outside the routing table (handshake) for rtt samples
+    void AddRttRequest(uint32_t message_id, int message_type);
+    // flight recorder of the latest node adds and drops of this table
+    RoutingEventRecorderPtr routing_events() {
+        return routing_events_;
+    }
+    // the table, its dynamic xip manager and its bootstrap cache helper,
+    // reported to MemoryStats between Init and UnInit
+    void GetMemoryUsage(std::vector<MemoryUsage>& usages);
 
+    // message_type: the kad type of data for the traffic stats, others are not counted
     int SendData(
             const xbyte_buffer_t& data,
             const std::string& peer_ip,
             uint16_t peer_port,
-            uint16_t priority = enum_xpacket_priority_type_priority);
+            uint16_t priority = enum_xpacket_priority_type_priority,
+            int message_type = kKadMessageTypeMax);
 
     int SendData(
             transport::protobuf::RoutingMessage& message,
@@ -213,6 +277,15 @@ public:
     int SendData(transport::protobuf::RoutingMessage& message, NodeInfoPtr node_ptr);
 
 protected:
+    // wraps data in an xip2 packet, counts it and sends it, with the peer's
+    // udp property if given (the transport may set it)
+    int SendPacket(
+            const xbyte_buffer_t& data,
+            const std::string& peer_ip,
+            uint16_t peer_port,
+            uint16_t priority,
+            int message_type,
+            transport::UdpPropertyPtr* udp_property);
     virtual int Bootstrap(
             const std::string& peer_ip,
             uint16_t peer_port,
@@ -232,12 +305,50 @@ protected:
     // 8*kNodeIdSize-1: the first bit is different already
     int SetNodeBucket(NodeInfoPtr node);
     bool ValidNode(NodeInfoPtr node);
+    // cheap checks on a received node entry before a NodeInfo is allocated for it
+    bool IsNewNodeCandidate(const std::string& id, int32_t nat_type);
+    // checks before adding a node and sets its bucket index
+    int PrepareNewNode(NodeInfoPtr node);
     int SortNodesByTargetXid(const std::string& target_xid, int number);
     int SortNodesByTargetXip(const std::string& target_xip, int number);
-    // make sure nodes_ is sorted by kad algo
-    virtual bool NewNodeReplaceOldNode(NodeInfoPtr node, bool remove);
+    virtual bool NewNodeReplaceOldNode(NodeInfoPtr node);
+    // nodes_mutex_ must be held, adds to nodes_ and the bucket members
+    void InsertNode(NodeInfoPtr node);
+    // keep a candidate rejected by a full bucket for later promotion, and probe
+    // the least-recently-seen member of the bucket if probe_full_bucket_
+    void CacheReplacement(NodeInfoPtr node);
+    // refill the bucket from its replacement cache after a member is dropped. a drop
+    // made by a promotion (a probed member evicted) is queued and promoted after it,
+    // so DropNode does not re-enter itself
+    void PromoteReplacements(int bucket_index);
+    void PromoteReplacement(int bucket_index);
+    // nodes_mutex_ must be held, node null for table wide events
+    void RecordRoutingEvent(int type, int reason, NodeInfoPtr node);
+    // sample rtt if message answers a tracked request, node_ptr null: the table's node
+    void UpdateNodeRtt(const transport::protobuf::RoutingMessage& message, NodeInfoPtr node_ptr);
+    void OnPublicNodeEvent(const NodeEvent& event);
+    // period in microseconds like base::TimerRepeated
+    void StartTimer(
+            std::shared_ptr<base::TimerRepeated>& timer,
+            const std::string& name,
+            int32_t period_us,
+            std::function<void()> proc);
+    // virtual clock time when a sim scheduler is set
+    std::chrono::steady_clock::time_point Now();
     virtual uint32_t GetFindNodesMaxSize();
     void RecursiveSend(transport::protobuf::RoutingMessage& message, int retry_times);
+    // adds a HopTracer record for a sampled message handed to next_hop
+    void RecordHop(
+            const transport::protobuf::RoutingMessage& message,
+            uint64_t trace_id,
+            std::chrono::steady_clock::time_point arrival,
+            NodeInfoPtr next_hop);
+    // nodes closest to des_node_id without self and exclude, cached per table generation
+    void GetNextHopNodes(
+            const std::string& des_node_id,
+            const std::set<std::string>& exclude,
+            std::vector<NodeInfoPtr>& ready_nodes);
+    uint32_t GetParallelForward(int message_type);
     void HeartbeatProc();
     void HeartbeatCheckProc();
     void Rejoin();
@@ -252,6 +363,26 @@ protected:
     void GetRandomAlphaNodes(std::map<std::string, std::string>& query_nodes);
     void GetClosestAlphaNodes(std::map<std::string, std::string>& query_nodes);
     void DumpNodes();
+    // fill find_nodes_res with nodes closest to target_id until max_bytes is reached
+    void GetClosestNodesResponse(
+            const std::string& target_id,
+            uint32_t max_bytes,
+            protobuf::FindClosestNodesResponse& find_nodes_res);
+    // add or detect the nodes responsed by message's sender (find nodes or bootstrap join)
+    void HandleClosestNodes(
+            const protobuf::FindClosestNodesResponse& find_nodes_res,
+            transport::protobuf::RoutingMessage& message,
+            base::xpacket_t& packet);
+    // seed fast path: reply from the pre-serialized join response template
+    void GetJoinResponseTemplate(std::string& msg_template, std::string& res_template);
+    int SendJoinResponseFromTemplate(
+            transport::protobuf::RoutingMessage& message,
+            base::xpacket_t& packet,
+            const protobuf::BootstrapJoinResponse& join_res);
+    void SendBootstrapJoinRetryLater(
+            transport::protobuf::RoutingMessage& message,
+            base::xpacket_t& packet,
+            uint32_t retry_after_ms);
 
     uint32_t RoutingMaxNodesSize_;
     std::shared_ptr<transport::Transport> transport_ptr_;
@@ -259,21 +390,24 @@ protected:
 
     std::string name_{"<bluert>"};
     std::vector<NodeInfoPtr> nodes_;
-    std::mutex nodes_mutex_;
+    KadMutex nodes_mutex_;
     std::map<std::string, NodeInfoPtr> node_id_map_;
-    std::mutex node_id_map_mutex_;
+    // public endpoint -> nodes, virtual nodes of one peer share the endpoint.
+    // guarded by node_id_map_mutex_ too
+    std::unordered_multimap<EndpointKey, NodeInfoPtr, EndpointKeyHash> endpoint_nodes_map_;
+    KadMutex node_id_map_mutex_;
     std::shared_ptr<std::map<uint64_t, NodeInfoPtr>> node_hash_map_;
-    std::mutex node_hash_map_mutex_;
-    std::mutex bootstrap_mutex_;
-    std::condition_variable bootstrap_cond_;
-    std::mutex joined_mutex_;
+    KadMutex node_hash_map_mutex_;
+    KadMutex bootstrap_mutex_;
+    KadConditionVariable bootstrap_cond_;
+    KadMutex joined_mutex_;
     std::atomic<bool> joined_;
     std::string bootstrap_id_;
     std::string bootstrap_ip_;
     uint16_t bootstrap_port_;
     // keep the first bootstrap id
     std::vector<NodeInfoPtr> bootstrap_nodes_;
-    std::mutex bootstrap_nodes_mutex_;
+    KadMutex bootstrap_nodes_mutex_;
 
     int find_neighbour_num_;
     std::shared_ptr<NodeDetectionManager> node_detection_ptr_;
@@ -283,11 +417,12 @@ protected:
     std::shared_ptr<base::TimerRepeated> timer_heartbeat_;
     std::shared_ptr<base::TimerRepeated> timer_heartbeat_check_;
     std::shared_ptr<base::TimerRepeated> timer_prt_;
+    std::shared_ptr<base::TimerRepeated> timer_node_event_;
     bool destroy_;
     uint32_t find_nodes_period_;
 
     std::set<std::pair<std::string, uint16_t>> set_endpoints_;
-    std::mutex set_endpoints_mutex_;
+    KadMutex set_endpoints_mutex_;
     bool after_join_;
 
     std::shared_ptr<kadmlia::BootstrapCacheHelper> bootstrap_cache_helper_;
@@ -296,10 +431,44 @@ protected:
 //     gossip::RumorHandlerSptr rumor_handler_;
     DynamicXipManagerPtr dy_manager_;
     std::map<std::string, std::string> heart_beat_info_map_;
-    std::mutex heart_beat_info_map_mutex_;
+    KadMutex heart_beat_info_map_mutex_;
     on_heart_beat_info_receive_callback_t heart_beat_callback_;
-    std::mutex heart_beat_callback_mutex_;
+    KadMutex heart_beat_callback_mutex_;
     std::shared_ptr<security::XSecurityJoin> security_join_ptr_;
+    BootstrapJoinLimiterPtr join_limiter_;
+    // serialized RoutingMessage and BootstrapJoinResponse parts that are the same
+    // for every joiner, per-joiner fields are serialized after them
+    std::string join_msg_template_;
+    std::string join_res_template_;
+    std::chrono::steady_clock::time_point join_template_time_;
+    KadMutex join_template_mutex_;
+    // retry hint from an overloaded bootstrap node, used by MultiJoin
+    std::atomic<uint32_t> join_retry_after_ms_;
+    ReplacementCachePtr replacement_cache_;
+    std::atomic<bool> probe_full_bucket_;
+    RttSamplerPtr rtt_sampler_;
+    std::atomic<bool> rtt_aware_next_hop_;
+    BucketCapacityPolicy bucket_capacity_policy_;  // guarded by nodes_mutex_
+    // bucket index -> members in nodes_, guarded by nodes_mutex_
+    std::map<int, std::vector<NodeInfoPtr>> bucket_nodes_;
+    // bucket index -> earliest time of its next probe, guarded by nodes_mutex_
+    std::map<int, std::chrono::steady_clock::time_point> bucket_probe_time_;
+    RouteCachePtr route_cache_;
+    std::atomic<uint64_t> generation_;
+    std::deque<int> pending_promotions_;  // bucket indexes
+    bool promoting_;
+    KadMutex promotion_mutex_;
+    std::map<int, uint32_t> parallel_forward_map_;
+    KadMutex parallel_forward_mutex_;
+    NodeEventDispatcherPtr node_event_dispatcher_;
+    RoutingEventRecorderPtr routing_events_;
+    // public nodes for the bootstrap cache, maintained from node events
+    std::unordered_map<std::string, NodeInfoPtr> public_nodes_;
+    KadMutex public_nodes_mutex_;
+    uint32_t public_nodes_subscription_;
+    uint32_t memory_reporter_id_;
+    SimSchedulerIntfPtr sim_scheduler_;
+    std::vector<uint64_t> sim_task_ids_;
 
 private:
 //     bool CheckRumorLicense() const;
@@ -142,6 +142,9 @@ static const int kHopToLive = 20;
 static const int kJoinRetryTimes = 5;
 static const uint32_t kFindNodesBloomfilterBitSize = 4096;
 static const uint32_t kFindNodesBloomfilterHashNum = 11;
+// byte budget of the closest nodes carried by BootstrapJoinResponse,
+// keeps the join response inside one udp packet
+static const uint32_t kJoinResponseClosestNodesMaxBytes = 1024;
 
 static const std::string kUdpNatDetectMagic = "UdpNatDetectMagic";
 static const std::string LOCAL_COUNTRY_DB_KEY = "local_country_code";
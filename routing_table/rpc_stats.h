@@ -0,0 +1,103 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+#include "xpbase/base/top_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static const int kRpcTypeUnknown = -1;
+// log-linear buckets: values below 32 exactly, above 16 buckets per power of two
+static const uint32_t kRpcHistogramSubBuckets = 16;
+static const uint32_t kRpcHistogramBuckets = 464;  // up to 2^32 - 1 us
+
+// hdr style latency histogram in microseconds, buckets about 6% wide
+class RpcLatencyHistogram {
+public:
+    RpcLatencyHistogram();
+    void Record(uint64_t value_us);
+    // highest value of the bucket holding the percent-th percentile, 0 if empty
+    uint64_t Percentile(double percent) const;
+    uint64_t count() const;
+    uint64_t sum() const;
+    uint64_t max() const;
+    void Reset();
+
+    static uint32_t BucketIndex(uint64_t value_us);
+    static uint64_t BucketHighest(uint32_t index);
+
+private:
+    std::atomic<uint64_t> buckets_[kRpcHistogramBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+
+    DISALLOW_COPY_AND_ASSIGN(RpcLatencyHistogram);
+};
+
+struct RpcStatsInfo {
+    int type{kRpcTypeUnknown};
+    uint64_t requests{0};
+    uint64_t responses{0};
+    uint64_t timeouts{0};
+    uint64_t late_responses{0};  // arrived after the request timed out
+    uint64_t cancelled{0};
+    uint64_t mean_us{0};
+    uint64_t p50_us{0};
+    uint64_t p90_us{0};
+    uint64_t p99_us{0};
+    uint64_t p999_us{0};
+    uint64_t max_us{0};
+};
+
+// round trips of CallbackManager requests and of the kad requests sampled by
+// RttSampler, by message type
+class RpcStats {
+public:
+    RpcStats();
+    ~RpcStats();
+    void OnRequest(int type);
+    void OnResponse(int type, uint64_t rtt_us);
+    void OnTimeout(int type);
+    void OnLateResponse(int type);
+    void OnCancel(int type);
+    // sorted by type
+    void Get(std::vector<RpcStatsInfo>& infos);
+    bool Get(int type, RpcStatsInfo& info);
+    std::string Dump();
+    void Reset();
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> timeouts{0};
+        std::atomic<uint64_t> late_responses{0};
+        std::atomic<uint64_t> cancelled{0};
+        RpcLatencyHistogram rtt;
+    };
+
+    Entry* GetEntry(int type);
+    static void GetInfo(int type, Entry& entry, RpcStatsInfo& info);
+
+    // entries are never erased, so they are used outside the lock
+    std::map<int, std::unique_ptr<Entry>> entries_;
+    std::mutex entries_mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(RpcStats);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
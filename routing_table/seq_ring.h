@@ -0,0 +1,113 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+#include "xpbase/base/top_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+// fixed ring keeping the latest pushed records, the oldest are overwritten.
+// a writer takes a slot with one fetch_add and publishes it with a sequence
+// number, a reader skips slots that are being written or whose writer was
+// lapped. T is copied as words, so it must be trivially copyable
+template <typename T>
+class SeqRing {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqRing needs a trivially copyable type");
+
+    // capacity is rounded up to a power of 2
+    explicit SeqRing(uint32_t capacity)
+            : mask_(RoundUp(capacity) - 1),
+              slots_(new Slot[mask_ + 1]),
+              write_pos_(0) {}
+
+    void Push(const T& record) {
+        uint64_t words[kWords] = { 0 };
+        memcpy(words, &record, sizeof(T));
+
+        const uint64_t pos = write_pos_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+        slot.seq.store(pos * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t i = 0; i < kWords; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.seq.store(pos * 2 + 2, std::memory_order_release);
+    }
+
+    // the records still in the ring, oldest first
+    void Get(std::vector<T>& records) const {
+        records.clear();
+        const uint64_t end = write_pos_.load(std::memory_order_acquire);
+        const uint64_t begin = end > mask_ + 1 ? end - mask_ - 1 : 0;
+        for (uint64_t pos = begin; pos < end; ++pos) {
+            const Slot& slot = slots_[pos & mask_];
+            const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq != pos * 2 + 2) {
+                continue;
+            }
+
+            uint64_t words[kWords];
+            for (uint32_t i = 0; i < kWords; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) {
+                continue;
+            }
+            T record;
+            memcpy(&record, words, sizeof(T));
+            records.push_back(record);
+        }
+    }
+
+    // all records ever pushed, including overwritten ones
+    uint64_t pushed() const {
+        return write_pos_.load(std::memory_order_relaxed);
+    }
+
+    uint32_t capacity() const {
+        return static_cast<uint32_t>(mask_ + 1);
+    }
+
+    uint64_t bytes() const {
+        return sizeof(*this) + (mask_ + 1) * sizeof(Slot);
+    }
+
+private:
+    static const uint32_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint64_t> seq{0};  // odd while written
+        std::atomic<uint64_t> words[kWords];
+    };
+
+    static uint64_t RoundUp(uint32_t capacity) {
+        uint64_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const uint64_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> write_pos_;
+
+    DISALLOW_COPY_AND_ASSIGN(SeqRing);
+};
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,33 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <functional>
+
+namespace top {
+
+namespace kadmlia {
+
+typedef std::function<void()> SimTask;
+
+// virtual clock a routing table runs its timers on instead of the timer
+// manager, set by the simulations. the implementation lives in xkad_sim
+class SimSchedulerIntf {
+public:
+    virtual ~SimSchedulerIntf() {}
+    virtual uint64_t now_ms() const = 0;
+    // returns the task id, 0 is never used
+    virtual uint64_t Schedule(uint64_t delay_ms, SimTask task) = 0;
+    virtual uint64_t SchedulePeriodic(uint64_t first_ms, uint64_t period_ms, SimTask task) = 0;
+    virtual void Cancel(uint64_t task_id) = 0;
+};
+
+typedef std::shared_ptr<SimSchedulerIntf> SimSchedulerIntfPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,206 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/sim/loopback_network.h"
+
+#include <chrono>
+
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static std::string LinkKey(const std::string& ip_a, const std::string& ip_b) {
+    if (ip_a < ip_b) {
+        return ip_a + "|" + ip_b;
+    }
+    return ip_b + "|" + ip_a;
+}
+
+LoopbackNetwork::LoopbackNetwork(uint32_t seed) : LoopbackNetwork(seed, SteadyClockMs) {}
+
+LoopbackNetwork::LoopbackNetwork(uint32_t seed, LoopbackClock clock)
+        : clock_(clock),
+          random_(seed),
+          default_link_(),
+          links_(),
+          partition_(),
+          endpoints_(),
+          packets_(),
+          next_seq_(0),
+          stats_(),
+          mutex_() {}
+
+LoopbackNetwork::~LoopbackNetwork() {}
+
+uint64_t LoopbackNetwork::SteadyClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool LoopbackNetwork::Register(
+        const std::string& ip,
+        uint16_t port,
+        int32_t nat_type,
+        LoopbackReceiver receiver) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Endpoint& endpoint = endpoints_[EndpointKey(ip, port)];
+    if (endpoint.receiver) {
+        return false;
+    }
+    endpoint.nat_type = nat_type;
+    endpoint.receiver = receiver;
+    return true;
+}
+
+void LoopbackNetwork::Unregister(const std::string& ip, uint16_t port) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    endpoints_.erase(EndpointKey(ip, port));
+}
+
+int LoopbackNetwork::Send(
+        const std::string& from_ip,
+        uint16_t from_port,
+        const std::string& to_ip,
+        uint16_t to_port,
+        const std::string& data) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.sent;
+    EndpointKey to(to_ip, to_port);
+    auto from_iter = endpoints_.find(EndpointKey(from_ip, from_port));
+    if (from_iter != endpoints_.end() && from_iter->second.nat_type != kNatTypePublic) {
+        // opens the sender's nat for replies from this peer
+        from_iter->second.contacted.insert(to);
+    }
+
+    const LoopbackLink& link = GetLink(from_ip, to_ip);
+    if (link.loss > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(random_) < link.loss) {
+        ++stats_.dropped_loss;
+        return kKadSuccess;  // lost on the way, like udp
+    }
+
+    Packet packet;
+    packet.deliver_ms = clock_() + link.latency_ms;
+    if (link.jitter_ms > 0) {
+        packet.deliver_ms += std::uniform_int_distribution<uint32_t>(0, link.jitter_ms)(random_);
+    }
+    packet.seq = next_seq_++;
+    packet.from_ip = from_ip;
+    packet.from_port = from_port;
+    packet.to_ip = to_ip;
+    packet.to = to;
+    packet.data = data;
+    packets_.push(std::move(packet));
+    return kKadSuccess;
+}
+
+uint32_t LoopbackNetwork::Deliver() {
+    struct Delivery {
+        LoopbackReceiver receiver;
+        Packet packet;
+    };
+    std::vector<Delivery> deliveries;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t now_ms = clock_();
+        while (!packets_.empty() && packets_.top().deliver_ms <= now_ms) {
+            Packet packet = packets_.top();
+            packets_.pop();
+            auto iter = endpoints_.find(packet.to);
+            if (iter == endpoints_.end() || Partitioned(packet.from_ip, packet.to_ip)) {
+                ++stats_.dropped_unreachable;
+                continue;
+            }
+
+            Endpoint& endpoint = iter->second;
+            if (endpoint.nat_type != kNatTypePublic &&
+                    endpoint.contacted.find(EndpointKey(packet.from_ip, packet.from_port)) ==
+                    endpoint.contacted.end()) {
+                ++stats_.dropped_nat;
+                continue;
+            }
+
+            ++stats_.delivered;
+            stats_.bytes += packet.data.size();
+            deliveries.push_back(Delivery{ endpoint.receiver, std::move(packet) });
+        }
+    }
+
+    for (auto& delivery : deliveries) {
+        delivery.receiver(delivery.packet.from_ip, delivery.packet.from_port, delivery.packet.data);
+    }
+    return deliveries.size();
+}
+
+bool LoopbackNetwork::NextDeliveryMs(uint64_t& deliver_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (packets_.empty()) {
+        return false;
+    }
+    deliver_ms = packets_.top().deliver_ms;
+    return true;
+}
+
+void LoopbackNetwork::set_default_link(const LoopbackLink& link) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    default_link_ = link;
+}
+
+void LoopbackNetwork::SetLink(const std::string& ip_a, const std::string& ip_b, const LoopbackLink& link) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    links_[LinkKey(ip_a, ip_b)] = link;
+}
+
+void LoopbackNetwork::Partition(
+        const std::vector<std::string>& group_a,
+        const std::vector<std::string>& group_b) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    partition_.clear();
+    for (auto& ip : group_a) {
+        partition_[ip] = 1;
+    }
+    for (auto& ip : group_b) {
+        partition_[ip] = 2;
+    }
+}
+
+void LoopbackNetwork::Heal() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    partition_.clear();
+}
+
+LoopbackStats LoopbackNetwork::stats() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+uint32_t LoopbackNetwork::size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return packets_.size();
+}
+
+const LoopbackLink& LoopbackNetwork::GetLink(const std::string& ip_a, const std::string& ip_b) {
+    if (links_.empty()) {
+        return default_link_;
+    }
+    auto iter = links_.find(LinkKey(ip_a, ip_b));
+    if (iter != links_.end()) {
+        return iter->second;
+    }
+    return default_link_;
+}
+
+bool LoopbackNetwork::Partitioned(const std::string& ip_a, const std::string& ip_b) {
+    if (partition_.empty()) {
+        return false;
+    }
+    auto iter_a = partition_.find(ip_a);
+    auto iter_b = partition_.find(ip_b);
+    return iter_a != partition_.end() && iter_b != partition_.end() && iter_a->second != iter_b->second;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
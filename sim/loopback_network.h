@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <random>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/endpoint_key.h"
+#include "xkad/nat_detect/nat_defines.h"
+
+namespace top {
+
+namespace kadmlia {
+
+struct LoopbackLink {
+    uint32_t latency_ms{ 0 };
+    uint32_t jitter_ms{ 0 };  // uniform extra delay in [0, jitter_ms]
+    double loss{ 0.0 };  // drop probability
+};
+
+struct LoopbackStats {
+    uint64_t sent{ 0 };
+    uint64_t delivered{ 0 };
+    uint64_t bytes{ 0 };
+    uint64_t dropped_loss{ 0 };
+    uint64_t dropped_nat{ 0 };
+    uint64_t dropped_unreachable{ 0 };  // no endpoint or partitioned
+};
+
+// receiver of a packet: (from ip, from port, data)
+typedef std::function<void(const std::string&, uint16_t, const std::string&)> LoopbackReceiver;
+typedef std::function<uint64_t()> LoopbackClock;  // milliseconds
+
+// in-process network between endpoints of one process. packets are queued with
+// a delivery time from the link latency and handed to the receiver by Deliver.
+// endpoints behind a nat only accept packets from the ip and port of peers they
+// sent to before (port restricted cone). the random source is seeded, so a run
+// with a virtual clock is reproducible
+class LoopbackNetwork {
+public:
+    explicit LoopbackNetwork(uint32_t seed);
+    LoopbackNetwork(uint32_t seed, LoopbackClock clock);
+    ~LoopbackNetwork();
+    bool Register(const std::string& ip, uint16_t port, int32_t nat_type, LoopbackReceiver receiver);
+    void Unregister(const std::string& ip, uint16_t port);
+    int Send(
+            const std::string& from_ip,
+            uint16_t from_port,
+            const std::string& to_ip,
+            uint16_t to_port,
+            const std::string& data);
+    // deliver the packets due by now, returns the count delivered
+    uint32_t Deliver();
+    // delivery time of the next queued packet, false if none
+    bool NextDeliveryMs(uint64_t& deliver_ms);
+    void set_default_link(const LoopbackLink& link);
+    // overrides the default link for packets between the two ips, both directions
+    void SetLink(const std::string& ip_a, const std::string& ip_b, const LoopbackLink& link);
+    // packets between the two groups of ips are dropped until Heal
+    void Partition(const std::vector<std::string>& group_a, const std::vector<std::string>& group_b);
+    void Heal();
+    LoopbackStats stats();
+    uint32_t size();
+
+private:
+    struct Endpoint {
+        int32_t nat_type{ kNatTypePublic };
+        LoopbackReceiver receiver;
+        std::unordered_set<EndpointKey, EndpointKeyHash> contacted;
+    };
+
+    struct Packet {
+        uint64_t deliver_ms{ 0 };
+        uint64_t seq{ 0 };
+        std::string from_ip;
+        uint16_t from_port{ 0 };
+        std::string to_ip;
+        EndpointKey to;
+        std::string data;
+    };
+
+    struct PacketLater {
+        bool operator()(const Packet& a, const Packet& b) const {
+            if (a.deliver_ms != b.deliver_ms) {
+                return a.deliver_ms > b.deliver_ms;
+            }
+            return a.seq > b.seq;
+        }
+    };
+
+    static uint64_t SteadyClockMs();
+    const LoopbackLink& GetLink(const std::string& ip_a, const std::string& ip_b);
+    bool Partitioned(const std::string& ip_a, const std::string& ip_b);
+
+    LoopbackClock clock_;
+    std::mt19937 random_;
+    LoopbackLink default_link_;
+    std::unordered_map<std::string, LoopbackLink> links_;  // "ip_a|ip_b" with ip_a < ip_b
+    std::unordered_map<std::string, int> partition_;  // ip -> group 1 or 2
+    std::unordered_map<EndpointKey, Endpoint, EndpointKeyHash> endpoints_;
+    std::priority_queue<Packet, std::vector<Packet>, PacketLater> packets_;
+    uint64_t next_seq_;
+    LoopbackStats stats_;
+    std::mutex mutex_;
+
+    DISALLOW_COPY_AND_ASSIGN(LoopbackNetwork);
+};
+
+typedef std::shared_ptr<LoopbackNetwork> LoopbackNetworkPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,134 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/sim/loopback_transport.h"
+
+#include <string.h>
+
+#include "xpbase/base/top_log.h"
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+LoopbackTransport::LoopbackTransport(
+        LoopbackNetworkPtr network,
+        const std::string& ip,
+        uint16_t port,
+        int32_t nat_type)
+        : network_(network),
+          ip_(ip),
+          port_(port),
+          nat_type_(nat_type),
+          started_(false),
+          message_handler_() {}
+
+LoopbackTransport::~LoopbackTransport() {
+    Stop();
+}
+
+int LoopbackTransport::Start(
+        const std::string& local_ip,
+        uint16_t local_port,
+        transport::MultiThreadHandler* message_handler) {
+    if (started_) {
+        return kKadSuccess;
+    }
+
+    // the endpoint is fixed by the simulation, not by the caller
+    if (!network_->Register(ip_, port_, nat_type_, std::bind(
+            &LoopbackTransport::OnReceive,
+            this,
+            std::placeholders::_1,
+            std::placeholders::_2,
+            std::placeholders::_3))) {
+        TOP_ERROR("loopback endpoint %s:%d in use", ip_.c_str(), (int)port_);
+        return kKadFailed;
+    }
+    started_ = true;
+    return kKadSuccess;
+}
+
+void LoopbackTransport::Stop() {
+    if (!started_) {
+        return;
+    }
+    network_->Unregister(ip_, port_);
+    started_ = false;
+}
+
+int LoopbackTransport::SendData(base::xpacket_t& packet) {
+    if (!started_) {
+        return kKadFailed;
+    }
+    std::string data((const char*)packet.get_body().data(), packet.get_body().size());  // NOLINT
+    return network_->Send(ip_, port_, packet.get_to_ip_addr(), packet.get_to_ip_port(), data);
+}
+
+int LoopbackTransport::SendDataWithProp(base::xpacket_t& packet, transport::UdpPropertyPtr& udp_property) {
+    return SendData(packet);
+}
+
+int LoopbackTransport::SendPing(const xbyte_buffer_t& data, const std::string& peer_ip, uint16_t peer_port) {
+    if (!started_) {
+        return kKadFailed;
+    }
+    // pings carry no xip2 header, add one so the receive side is the same
+    _xip2_header header;
+    memset(&header, 0, sizeof(header));
+    std::string packet_data((const char*)&header, enum_xip2_header_len);  // NOLINT
+    packet_data.append((const char*)data.data(), data.size());  // NOLINT
+    return network_->Send(ip_, port_, peer_ip, peer_port, packet_data);
+}
+
+int LoopbackTransport::SendPing(base::xpacket_t& packet) {
+    return SendData(packet);
+}
+
+int LoopbackTransport::ReStartServer() {
+    return kKadSuccess;
+}
+
+int LoopbackTransport::get_socket_status() {
+    return started_ ? 1 : 0;
+}
+
+std::string LoopbackTransport::local_ip() {
+    return ip_;
+}
+
+uint16_t LoopbackTransport::local_port() {
+    return port_;
+}
+
+int LoopbackTransport::RegisterOfflineCallback(
+        std::function<void(const std::string& ip, const uint16_t port)> cb) {
+    return kKadSuccess;
+}
+
+void LoopbackTransport::OnReceive(const std::string& from_ip, uint16_t from_port, const std::string& data) {
+    if (!message_handler_ || data.size() <= (size_t)enum_xip2_header_len) {
+        return;
+    }
+
+    transport::protobuf::RoutingMessage message;
+    if (!message.ParseFromArray(data.data() + enum_xip2_header_len, data.size() - enum_xip2_header_len)) {
+        TOP_WARN("loopback message from %s:%d parse failed", from_ip.c_str(), (int)from_port);
+        return;
+    }
+
+    uint8_t local_buf[kUdpPacketBufferSize];
+    base::xpacket_t packet(base::xcontext_t::instance(), local_buf, sizeof(local_buf), 0, 0, false);
+    packet.get_body().push_back((uint8_t*)data.data(), data.size());  // NOLINT
+    packet.set_from_ip_addr(from_ip);
+    packet.set_from_ip_port(from_port);
+    packet.set_to_ip_addr(ip_);
+    packet.set_to_ip_port(port_);
+    message_handler_(message, packet);
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
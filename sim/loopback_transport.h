@@ -0,0 +1,65 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <functional>
+
+#include "xbase/xpacket.h"
+#include "xtransport/transport.h"
+#include "xtransport/proto/transport.pb.h"
+#include "xkad/sim/loopback_network.h"
+
+namespace top {
+
+namespace kadmlia {
+
+typedef std::function<void(transport::protobuf::RoutingMessage&, base::xpacket_t&)> LoopbackMessageHandler;
+
+// transport of one simulated node, packets go through a LoopbackNetwork shared
+// by all nodes of the process instead of a udp socket
+class LoopbackTransport : public transport::Transport {
+public:
+    LoopbackTransport(LoopbackNetworkPtr network, const std::string& ip, uint16_t port, int32_t nat_type);
+    virtual ~LoopbackTransport();
+    // received messages are parsed and passed to handler on the Deliver thread
+    void set_message_handler(LoopbackMessageHandler handler) {
+        message_handler_ = handler;
+    }
+
+    virtual int Start(
+            const std::string& local_ip,
+            uint16_t local_port,
+            transport::MultiThreadHandler* message_handler) override;
+    virtual void Stop() override;
+    virtual int SendData(base::xpacket_t& packet) override;
+    virtual int SendDataWithProp(base::xpacket_t& packet, transport::UdpPropertyPtr& udp_property) override;
+    virtual int SendPing(const xbyte_buffer_t& data, const std::string& peer_ip, uint16_t peer_port) override;
+    virtual int SendPing(base::xpacket_t& packet) override;
+    virtual int ReStartServer() override;
+    virtual int get_socket_status() override;
+    virtual std::string local_ip() override;
+    virtual uint16_t local_port() override;
+    virtual int RegisterOfflineCallback(std::function<void(const std::string& ip, const uint16_t port)> cb) override;
+
+private:
+    void OnReceive(const std::string& from_ip, uint16_t from_port, const std::string& data);
+
+    LoopbackNetworkPtr network_;
+    std::string ip_;
+    uint16_t port_;
+    int32_t nat_type_;
+    bool started_;
+    LoopbackMessageHandler message_handler_;
+
+    DISALLOW_COPY_AND_ASSIGN(LoopbackTransport);
+};
+
+typedef std::shared_ptr<LoopbackTransport> LoopbackTransportPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
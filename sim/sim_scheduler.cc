@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/sim/sim_scheduler.h"
+
+namespace top {
+
+namespace kadmlia {
+
+SimScheduler::SimScheduler(uint32_t seed)
+        : now_ms_(0),
+          next_seq_(0),
+          next_task_id_(0),
+          events_(),
+          tasks_(),
+          sources_(),
+          random_(seed) {}
+
+SimScheduler::~SimScheduler() {}
+
+uint64_t SimScheduler::Schedule(uint64_t delay_ms, SimTask task) {
+    return SchedulePeriodic(delay_ms, 0, task);
+}
+
+uint64_t SimScheduler::SchedulePeriodic(uint64_t first_ms, uint64_t period_ms, SimTask task) {
+    uint64_t task_id = ++next_task_id_;
+    Task& item = tasks_[task_id];
+    item.task = task;
+    item.period_ms = period_ms;
+    Push(now_ms_ + first_ms, task_id);
+    return task_id;
+}
+
+void SimScheduler::Cancel(uint64_t task_id) {
+    // the queued event is skipped when it comes up
+    tasks_.erase(task_id);
+}
+
+void SimScheduler::AddSource(SimSourceNext next, SimTask run) {
+    sources_.push_back(Source{ next, run });
+}
+
+uint64_t SimScheduler::RunUntil(uint64_t end_ms) {
+    uint64_t count = 0;
+    while (true) {
+        uint64_t source_ms = 0;
+        int source = NextSource(source_ms);
+        while (!events_.empty() && tasks_.find(events_.top().task_id) == tasks_.end()) {
+            events_.pop();
+        }
+
+        bool has_event = !events_.empty() && events_.top().time_ms <= end_ms;
+        bool has_source = source >= 0 && source_ms <= end_ms;
+        if (!has_event && !has_source) {
+            break;
+        }
+
+        // timers first on a tie, like a timer thread running before the socket poll
+        if (has_event && (!has_source || events_.top().time_ms <= source_ms)) {
+            Step();
+        } else {
+            if (source_ms > now_ms_) {
+                now_ms_ = source_ms;
+            }
+            sources_[source].run();
+        }
+        ++count;
+    }
+
+    if (end_ms > now_ms_) {
+        now_ms_ = end_ms;
+    }
+    return count;
+}
+
+bool SimScheduler::Step() {
+    while (!events_.empty()) {
+        Event event = events_.top();
+        events_.pop();
+        auto iter = tasks_.find(event.task_id);
+        if (iter == tasks_.end()) {
+            continue;
+        }
+
+        if (event.time_ms > now_ms_) {
+            now_ms_ = event.time_ms;
+        }
+        // copy, the task may cancel itself or schedule others
+        SimTask task = iter->second.task;
+        if (iter->second.period_ms > 0) {
+            Push(now_ms_ + iter->second.period_ms, event.task_id);
+        } else {
+            tasks_.erase(iter);
+        }
+        task();
+        return true;
+    }
+    return false;
+}
+
+void SimScheduler::Push(uint64_t time_ms, uint64_t task_id) {
+    Event event;
+    event.time_ms = time_ms;
+    event.seq = next_seq_++;
+    event.task_id = task_id;
+    events_.push(event);
+}
+
+int SimScheduler::NextSource(uint64_t& next_ms) {
+    int source = -1;
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        uint64_t source_ms = 0;
+        if (sources_[i].next(source_ms) && (source < 0 || source_ms < next_ms)) {
+            source = i;
+            next_ms = source_ms;
+        }
+    }
+    return source;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,102 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <queue>
+#include <random>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+
+#include "xpbase/base/top_utils.h"
+#include "xkad/routing_table/sim_scheduler_intf.h"
+
+namespace top {
+
+namespace kadmlia {
+
+// next_ms: time of the next pending event of the source, false if none
+typedef std::function<bool(uint64_t& next_ms)> SimSourceNext;
+
+// discrete event scheduler on a virtual clock in milliseconds. single threaded:
+// tasks run on the thread calling Run*, in (time, schedule order), so the same
+// seed and inputs give the same task order. a routing table run is not fully
+// repeatable: callback timeouts, the bootstrap cache and xudp heartbeats still
+// run on base::TimerManager and the wall clock
+class SimScheduler : public SimSchedulerIntf {
+public:
+    explicit SimScheduler(uint32_t seed);
+    virtual ~SimScheduler();
+    virtual uint64_t now_ms() const override {
+        return now_ms_;
+    }
+    virtual uint64_t Schedule(uint64_t delay_ms, SimTask task) override;
+    virtual uint64_t SchedulePeriodic(uint64_t first_ms, uint64_t period_ms, SimTask task) override;
+    virtual void Cancel(uint64_t task_id) override;
+    // event source outside the scheduler (the loopback network), run is called
+    // when the clock reaches the time next reported
+    void AddSource(SimSourceNext next, SimTask run);
+    // run events up to and including end_ms, the clock ends at end_ms
+    uint64_t RunUntil(uint64_t end_ms);
+    uint64_t RunFor(uint64_t duration_ms) {
+        return RunUntil(now_ms_ + duration_ms);
+    }
+    // run the next event only, false if there is none
+    bool Step();
+    std::mt19937& random() {
+        return random_;
+    }
+    uint32_t size() const {
+        return tasks_.size();
+    }
+
+private:
+    struct Event {
+        uint64_t time_ms{ 0 };
+        uint64_t seq{ 0 };
+        uint64_t task_id{ 0 };
+    };
+
+    struct EventLater {
+        bool operator()(const Event& a, const Event& b) const {
+            if (a.time_ms != b.time_ms) {
+                return a.time_ms > b.time_ms;
+            }
+            return a.seq > b.seq;
+        }
+    };
+
+    struct Task {
+        SimTask task;
+        uint64_t period_ms{ 0 };
+    };
+
+    struct Source {
+        SimSourceNext next;
+        SimTask run;
+    };
+
+    void Push(uint64_t time_ms, uint64_t task_id);
+    // earliest source with an event, -1 if none
+    int NextSource(uint64_t& next_ms);
+
+    uint64_t now_ms_;
+    uint64_t next_seq_;
+    uint64_t next_task_id_;
+    std::priority_queue<Event, std::vector<Event>, EventLater> events_;
+    std::unordered_map<uint64_t, Task> tasks_;
+    std::vector<Source> sources_;
+    std::mt19937 random_;
+
+    DISALLOW_COPY_AND_ASSIGN(SimScheduler);
+};
+
+typedef std::shared_ptr<SimScheduler> SimSchedulerPtr;
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,162 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <assert.h>
+#include <string.h>
+
+#include <iostream>
+#include <fstream>
+
+#include "xpbase/base/top_log.h"
+#include "xpbase/base/top_config.h"
+#include "xpbase/base/args_parser.h"
+#include "xpbase/base/kad_key/get_kadmlia_key.h"
+#include "xkad/routing_table/routing_utils.h"
+#include "xkad/nat_detect/nat_manager_intf.h"
+#include "sim_scenario.h"
+
+using namespace top::kadmlia::test;
+
+namespace top {
+    uint32_t gloabl_platform_type = kPlatform;
+    std::shared_ptr<top::base::KadmliaKey> global_xid;
+    std::string global_node_id = RandomString(kNodeIdSize);
+    std::string global_node_id_hash("");
+}
+
+static void PrintUsage() {
+    std::cout << "Allowed options:" << std::endl;
+    std::cout << "\t-h [help]            print help info" << std::endl;
+    std::cout << "\t-s [scenario]        bootstrap|lookup|churn|partition|all, default all" << std::endl;
+    std::cout << "\t-n [nodes]           node count, default 64" << std::endl;
+    std::cout << "\t-r [seed]            random seed, default 1" << std::endl;
+    std::cout << "\t-l [latency_ms]      one way link latency, default 20" << std::endl;
+    std::cout << "\t-j [jitter_ms]       extra random latency, default 10" << std::endl;
+    std::cout << "\t-p [loss_percent]    packet loss, default 0" << std::endl;
+    std::cout << "\t-d [duration_ms]     churn and partition phase, default 60000" << std::endl;
+    std::cout << "\t-q [lookups]         lookup storm size, default 1000" << std::endl;
+    std::cout << "\t-o [output]          json report path, default stdout" << std::endl;
+    std::cout << "\t-L [log_path]        log path" << std::endl;
+    std::cout << "\t-D [log_level]       log level" << std::endl;
+}
+
+static bool ParseParams(int argc, char** argv, top::ArgsParser& args_parser) {
+    args_parser.AddArgType('h', "help", top::kNoValue);
+    args_parser.AddArgType('s', "scenario", top::kMustValue);
+    args_parser.AddArgType('n', "nodes", top::kMustValue);
+    args_parser.AddArgType('r', "seed", top::kMustValue);
+    args_parser.AddArgType('l', "latency_ms", top::kMustValue);
+    args_parser.AddArgType('j', "jitter_ms", top::kMustValue);
+    args_parser.AddArgType('p', "loss_percent", top::kMustValue);
+    args_parser.AddArgType('d', "duration_ms", top::kMustValue);
+    args_parser.AddArgType('q', "lookups", top::kMustValue);
+    args_parser.AddArgType('o', "output", top::kMustValue);
+    args_parser.AddArgType('L', "log_path", top::kMustValue);
+    args_parser.AddArgType('D', "log_level", top::kMustValue);
+
+    std::string tmp_params = "";
+    for (int i = 1; i < argc; i++) {
+        if (strlen(argv[i]) == 0) {
+            tmp_params += static_cast<char>(31);
+        } else {
+            tmp_params += argv[i];
+        }
+        tmp_params += " ";
+    }
+
+    std::string err_pos;
+    if (args_parser.Parse(tmp_params, err_pos) != top::kadmlia::kKadSuccess) {
+        std::cout << "parse params failed!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void GetOption(top::ArgsParser& args_parser, const std::string& name, uint32_t& value) {
+    int param = 0;
+    if (args_parser.GetParam(name, param) == top::kadmlia::kKadSuccess && param >= 0) {
+        value = param;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    top::ArgsParser args_parser;
+    if (!ParseParams(argc, argv, args_parser)) {
+        return 1;
+    }
+    if (args_parser.HasParam("h")) {
+        PrintUsage();
+        return 0;
+    }
+
+    SimOptions options;
+    std::string scenario = "all";
+    std::string output;
+    std::string log_path = "./xkad_simbench.log";
+    uint32_t log_level = enum_xlog_level_error;
+    uint32_t duration_ms = options.duration_ms;
+    args_parser.GetParam("s", scenario);
+    args_parser.GetParam("o", output);
+    args_parser.GetParam("L", log_path);
+    GetOption(args_parser, "n", options.nodes);
+    GetOption(args_parser, "r", options.seed);
+    GetOption(args_parser, "l", options.latency_ms);
+    GetOption(args_parser, "j", options.jitter_ms);
+    GetOption(args_parser, "p", options.loss_percent);
+    GetOption(args_parser, "d", duration_ms);
+    GetOption(args_parser, "q", options.lookups);
+    GetOption(args_parser, "D", log_level);
+    options.duration_ms = duration_ms;
+
+    xinit_log(log_path.c_str(), true, true);
+    xset_log_level((enum_xlog_level)log_level);
+
+    // every simulated node shares the process xid
+    top::base::Config config;
+    config.Set("node", "zone_id", 1);
+    if (!top::kadmlia::CreateGlobalXid(config)) {
+        assert(0);
+    }
+    // loopback endpoints are public, no nat detection
+    top::kadmlia::NatManagerIntf::Instance()->SetNatType(top::kadmlia::kNatTypePublic);
+
+    std::vector<std::string> scenarios;
+    if (scenario == "all") {
+        scenarios = { "bootstrap", "lookup", "churn", "partition" };
+    } else if (scenario == "bootstrap" || scenario == "lookup"
+            || scenario == "churn" || scenario == "partition") {
+        scenarios.push_back(scenario);
+    } else {
+        std::cout << "unknown scenario: " << scenario << std::endl;
+        PrintUsage();
+        return 1;
+    }
+
+    std::string json = "[\n";
+    int ret = 0;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        SimReport report;
+        SimScenario sim_scenario(options);
+        if (!sim_scenario.Run(scenarios[i], report)) {
+            TOP_FATAL("simbench scenario %s failed", scenarios[i].c_str());
+            ret = 1;
+        }
+        json += "  " + report.ToString(2);
+        json += i + 1 < scenarios.size() ? ",\n" : "\n";
+    }
+    json += "]\n";
+
+    if (output.empty()) {
+        std::cout << json;
+        return ret;
+    }
+
+    std::ofstream out(output);
+    if (!out) {
+        std::cout << "open " << output << " failed" << std::endl;
+        return 1;
+    }
+    out << json;
+    return ret;
+}
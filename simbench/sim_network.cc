@@ -0,0 +1,329 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sim_network.h"
+
+#include <time.h>
+#include <stdlib.h>
+
+#include <set>
+#include <algorithm>
+#include <unordered_set>
+
+#include "xpbase/base/top_log.h"
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+static uint64_t ThreadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+SimNode::SimNode(SimNetwork* network, uint32_t index, const std::string& ip, uint16_t port, bool first_node)
+        : network_(network),
+          index_(index),
+          ip_(ip),
+          port_(port),
+          first_node_(first_node),
+          id_(),
+          alive_(false),
+          message_manager_(),
+          message_handler_(),
+          transport_(),
+          local_node_(),
+          routing_table_() {}
+
+SimNode::~SimNode() {
+    Stop(false);
+}
+
+bool SimNode::Start() {
+    // ids from the scheduler random source keep a run reproducible
+    std::mt19937& random = network_->scheduler()->random();
+    id_.resize(kNodeIdSize);
+    for (auto& c : id_) {
+        c = static_cast<char>(random() & 0xff);
+    }
+    auto kad_key = std::make_shared<SimKadkey>(id_, true);
+
+    message_handler_.message_manager_ = &message_manager_;
+    message_handler_.Init();
+    message_manager_.RegisterMessageProcessor(kSimLookup, [this](
+            transport::protobuf::RoutingMessage& message,
+            base::xpacket_t& packet) {
+        HandleLookup(message, packet);
+    });
+
+    transport_ = std::make_shared<LoopbackTransport>(network_->loopback(), ip_, port_, kNatTypePublic);
+    transport_->set_message_handler(std::bind(
+            &SimNode::HandleMessage,
+            this,
+            std::placeholders::_1,
+            std::placeholders::_2));
+    if (transport_->Start(ip_, port_, nullptr) != kKadSuccess) {
+        TOP_ERROR("sim node %s:%d start transport failed", ip_.c_str(), (int)port_);
+        return false;
+    }
+
+    local_node_ = std::make_shared<LocalNodeInfo>();
+    if (!local_node_->Init(
+            ip_,
+            port_,
+            first_node_,
+            false,
+            "",
+            kad_key,
+            kad_key->xnetwork_id(),
+            kRoleInvalid)) {
+        TOP_ERROR("sim node %s:%d local_node_info init failed", ip_.c_str(), (int)port_);
+        return false;
+    }
+    local_node_->set_service_type(kRoot);
+
+    routing_table_ = std::make_shared<RoutingTable>(transport_, kNodeIdSize, local_node_);
+    routing_table_->set_sim_scheduler(network_->scheduler());
+    if (!routing_table_->Init()) {
+        TOP_ERROR("sim node %s:%d routing table init failed", ip_.c_str(), (int)port_);
+        return false;
+    }
+    message_handler_.set_routing_ptr(routing_table_);
+    alive_ = true;
+    return true;
+}
+
+void SimNode::Join(const std::string& boot_ip, uint16_t boot_port) {
+    if (!alive_) {
+        return;
+    }
+    std::set<std::pair<std::string, uint16_t>> boot_endpoints;
+    boot_endpoints.insert(std::make_pair(boot_ip, boot_port));
+    routing_table_->MultiJoinAsync(boot_endpoints);
+}
+
+void SimNode::Stop(bool graceful) {
+    if (!alive_) {
+        return;
+    }
+    alive_ = false;
+    if (graceful) {
+        // the drop notices go out before the endpoint is gone
+        routing_table_->UnInit();
+        transport_->Stop();
+        return;
+    }
+    transport_->Stop();
+    routing_table_->UnInit();
+}
+
+void SimNode::SendLookup(const std::string& des_node_id, uint32_t lookup_index) {
+    if (!alive_) {
+        return;
+    }
+    transport::protobuf::RoutingMessage message;
+    routing_table_->SetFreqMessage(message);
+    message.set_des_service_type(local_node_->service_type());
+    message.set_des_node_id(des_node_id);
+    message.set_type(kSimLookup);
+    message.set_data(std::to_string(lookup_index));
+    routing_table_->SendToClosestNode(message);
+}
+
+void SimNode::HandleMessage(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet) {
+    if (!alive_) {
+        return;
+    }
+    const uint64_t begin_ns = ThreadCpuNs();
+    message_manager_.HandleMessage(message, packet);
+    network_->add_handle_cpu_ns(ThreadCpuNs() - begin_ns);
+}
+
+void SimNode::HandleLookup(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet) {
+    if (message.des_node_id() == id_) {
+        network_->OnLookupArrived(strtoul(message.data().c_str(), nullptr, 10), message.hop_nodes_size());
+        return;
+    }
+
+    if (message.hop_nodes_size() >= kSimLookupMaxHops) {
+        TOP_DEBUG("sim lookup %s dropped after %d hops", message.data().c_str(), message.hop_nodes_size());
+        return;
+    }
+    routing_table_->SendToClosestNode(message);
+}
+
+// --------------------------------------------------------------------------------
+SimNetwork::SimNetwork(uint32_t seed, const LoopbackLink& link)
+        : scheduler_(std::make_shared<SimScheduler>(seed)),
+          loopback_(),
+          nodes_(),
+          lookups_(),
+          handle_cpu_ns_(0) {
+    SimScheduler* scheduler = scheduler_.get();
+    loopback_ = std::make_shared<LoopbackNetwork>(seed, [scheduler]() {
+        return scheduler->now_ms();
+    });
+    loopback_->set_default_link(link);
+    LoopbackNetwork* loopback = loopback_.get();
+    scheduler_->AddSource(
+            [loopback](uint64_t& next_ms) {
+                return loopback->NextDeliveryMs(next_ms);
+            },
+            [loopback]() {
+                loopback->Deliver();
+            });
+}
+
+SimNetwork::~SimNetwork() {
+    for (auto& node : nodes_) {
+        node->Stop(false);
+    }
+}
+
+SimNodePtr SimNetwork::AddNode() {
+    const uint32_t index = nodes_.size();
+    // 10.x.y.z, one endpoint per node
+    const uint32_t host = index + 1;
+    const std::string ip = "10." + std::to_string((host >> 16) & 0xff) + "."
+            + std::to_string((host >> 8) & 0xff) + "." + std::to_string(host & 0xff);
+    const uint16_t port = 9000;
+    auto node = std::make_shared<SimNode>(this, index, ip, port, index == 0);
+    if (!node->Start()) {
+        return nullptr;
+    }
+    nodes_.push_back(node);
+    if (index > 0) {
+        node->Join(nodes_[0]->ip(), nodes_[0]->port());
+    }
+    return node;
+}
+
+void SimNetwork::StopNode(uint32_t index, bool graceful) {
+    if (index >= nodes_.size()) {
+        return;
+    }
+    nodes_[index]->Stop(graceful);
+}
+
+void SimNetwork::ReportOffline(const std::string& ip, uint16_t port, uint64_t detect_ms) {
+    scheduler_->Schedule(detect_ms, [this, ip, port]() {
+        for (auto& node : nodes_) {
+            if (node->alive()) {
+                node->routing_table()->OnHeartbeatFailed(ip, port);
+            }
+        }
+    });
+}
+
+void SimNetwork::Partition(
+        const std::vector<uint32_t>& group_a,
+        const std::vector<uint32_t>& group_b,
+        uint64_t detect_ms) {
+    std::vector<std::string> ips_a;
+    std::vector<std::string> ips_b;
+    for (auto index : group_a) {
+        ips_a.push_back(nodes_[index]->ip());
+    }
+    for (auto index : group_b) {
+        ips_b.push_back(nodes_[index]->ip());
+    }
+    loopback_->Partition(ips_a, ips_b);
+
+    auto drop_other_side = [this](const std::vector<uint32_t>& observers, const std::vector<uint32_t>& others) {
+        for (auto observer : observers) {
+            SimNodePtr node = nodes_[observer];
+            if (!node->alive()) {
+                continue;
+            }
+            for (auto other : others) {
+                node->routing_table()->OnHeartbeatFailed(nodes_[other]->ip(), nodes_[other]->port());
+            }
+        }
+    };
+    scheduler_->Schedule(detect_ms, [drop_other_side, group_a, group_b]() {
+        drop_other_side(group_a, group_b);
+        drop_other_side(group_b, group_a);
+    });
+}
+
+void SimNetwork::Heal() {
+    loopback_->Heal();
+}
+
+uint32_t SimNetwork::StartLookup(uint32_t src_index, uint32_t des_index) {
+    const uint32_t lookup_index = lookups_.size();
+    SimLookup lookup;
+    lookup.sent_ms = scheduler_->now_ms();
+    lookups_.push_back(lookup);
+    nodes_[src_index]->SendLookup(nodes_[des_index]->id(), lookup_index);
+    return lookup_index;
+}
+
+void SimNetwork::OnLookupArrived(uint32_t lookup_index, uint32_t hops) {
+    if (lookup_index >= lookups_.size()) {
+        return;
+    }
+    SimLookup& lookup = lookups_[lookup_index];
+    if (lookup.arrived) {
+        return;  // parallel forward duplicate
+    }
+    lookup.arrived = true;
+    lookup.arrived_ms = scheduler_->now_ms();
+    lookup.hops = hops;
+}
+
+void SimNetwork::GetTableStats(uint64_t& entries, uint64_t& stale, uint32_t& min_size) {
+    std::unordered_set<std::string> dead_ids;
+    for (auto& node : nodes_) {
+        if (!node->alive()) {
+            dead_ids.insert(node->id());
+        }
+    }
+
+    entries = 0;
+    stale = 0;
+    min_size = 0xffffffff;
+    for (auto& node : nodes_) {
+        if (!node->alive()) {
+            continue;
+        }
+        auto table_nodes = node->routing_table()->GetUnLockNodes();
+        if (!table_nodes) {
+            min_size = 0;
+            continue;
+        }
+        min_size = std::min(min_size, (uint32_t)table_nodes->size());
+        for (auto& table_node : *table_nodes) {
+            ++entries;
+            if (dead_ids.find(table_node->node_id) != dead_ids.end()) {
+                ++stale;
+            }
+        }
+    }
+    if (min_size == 0xffffffff) {
+        min_size = 0;
+    }
+}
+
+bool SimNetwork::AllJoined(uint32_t min_size) {
+    for (auto& node : nodes_) {
+        if (!node->alive()) {
+            continue;
+        }
+        // the first node never joins anyone
+        if (node->index() > 0 && !node->routing_table()->IsJoined()) {
+            return false;
+        }
+        if (node->routing_table()->nodes_size() < min_size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
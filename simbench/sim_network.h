@@ -0,0 +1,169 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "xpbase/base/top_utils.h"
+#include "xpbase/base/kad_key/platform_kadmlia_key.h"
+#include "xtransport/src/message_manager.h"
+#include "xkad/sim/loopback_network.h"
+#include "xkad/sim/sim_scheduler.h"
+#include "xkad/sim/loopback_transport.h"
+
+#define private public
+#define protected public
+#include "xkad/routing_table/routing_table.h"
+#include "xkad/routing_table/local_node_info.h"
+#include "xkad/routing_table/kad_message_handler.h"
+#undef private
+#undef protected
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+// message routed hop by hop with SendToClosestNode, data is the lookup index
+const int kSimLookup = kMessageTypeMax + 300;
+const int kSimLookupMaxHops = 16;
+
+class SimKadkey : public base::PlatformKadmliaKey {
+public:
+    SimKadkey(const std::string& str_for_hash, bool hash_tag)
+            : PlatformKadmliaKey(str_for_hash, hash_tag) {
+        node_id_ = str_for_hash;
+    }
+
+    virtual std::string Get() override {
+        return node_id_;
+    }
+
+private:
+    std::string node_id_;
+};
+
+class SimNetwork;
+
+// one node of the simulation: a routing table with its own message manager,
+// talking through a LoopbackTransport
+class SimNode {
+public:
+    SimNode(SimNetwork* network, uint32_t index, const std::string& ip, uint16_t port, bool first_node);
+    ~SimNode();
+    bool Start();
+    // async bootstrap, the rejoin timer retries while not joined
+    void Join(const std::string& boot_ip, uint16_t boot_port);
+    // graceful: tell the neighbours, crash: vanish from the network
+    void Stop(bool graceful);
+    void SendLookup(const std::string& des_node_id, uint32_t lookup_index);
+
+    bool alive() const {
+        return alive_;
+    }
+    uint32_t index() const {
+        return index_;
+    }
+    const std::string& ip() const {
+        return ip_;
+    }
+    uint16_t port() const {
+        return port_;
+    }
+    const std::string& id() const {
+        return id_;
+    }
+    std::shared_ptr<RoutingTable> routing_table() {
+        return routing_table_;
+    }
+
+private:
+    void HandleMessage(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet);
+    void HandleLookup(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet);
+
+    SimNetwork* network_;
+    uint32_t index_;
+    std::string ip_;
+    uint16_t port_;
+    bool first_node_;
+    std::string id_;
+    bool alive_;
+    transport::MessageManager message_manager_;
+    KadMessageHandler message_handler_;
+    LoopbackTransportPtr transport_;
+    std::shared_ptr<LocalNodeInfo> local_node_;
+    std::shared_ptr<RoutingTable> routing_table_;
+
+    DISALLOW_COPY_AND_ASSIGN(SimNode);
+};
+
+typedef std::shared_ptr<SimNode> SimNodePtr;
+
+struct SimLookup {
+    uint64_t sent_ms{ 0 };
+    uint64_t arrived_ms{ 0 };
+    uint32_t hops{ 0 };
+    bool arrived{ false };
+};
+
+// all nodes of one run on a shared virtual clock and loopback network
+class SimNetwork {
+public:
+    SimNetwork(uint32_t seed, const LoopbackLink& link);
+    ~SimNetwork();
+    // node 0 is the first node, the others bootstrap from it
+    SimNodePtr AddNode();
+    void StopNode(uint32_t index, bool graceful);
+    // failure detection of the udp layer: tables drop the endpoint after detect_ms
+    void ReportOffline(const std::string& ip, uint16_t port, uint64_t detect_ms);
+    // cut the two groups of nodes, each side drops the other after detect_ms
+    void Partition(
+            const std::vector<uint32_t>& group_a,
+            const std::vector<uint32_t>& group_b,
+            uint64_t detect_ms);
+    void Heal();
+    // returns the lookup index
+    uint32_t StartLookup(uint32_t src_index, uint32_t des_index);
+    void OnLookupArrived(uint32_t lookup_index, uint32_t hops);
+    // stale entries: table entries pointing at stopped nodes
+    void GetTableStats(uint64_t& entries, uint64_t& stale, uint32_t& min_size);
+    bool AllJoined(uint32_t min_size);
+
+    SimSchedulerPtr scheduler() {
+        return scheduler_;
+    }
+    LoopbackNetworkPtr loopback() {
+        return loopback_;
+    }
+    const std::vector<SimNodePtr>& nodes() const {
+        return nodes_;
+    }
+    std::vector<SimLookup>& lookups() {
+        return lookups_;
+    }
+    // cpu time spent handling messages, i.e. inside the routing tables
+    uint64_t handle_cpu_ns() const {
+        return handle_cpu_ns_;
+    }
+    void add_handle_cpu_ns(uint64_t ns) {
+        handle_cpu_ns_ += ns;
+    }
+
+private:
+    SimSchedulerPtr scheduler_;
+    LoopbackNetworkPtr loopback_;
+    std::vector<SimNodePtr> nodes_;
+    std::vector<SimLookup> lookups_;
+    uint64_t handle_cpu_ns_;
+
+    DISALLOW_COPY_AND_ASSIGN(SimNetwork);
+};
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
@@ -0,0 +1,99 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sim_report.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+void SimReport::Add(const std::string& key, int64_t value) {
+    Item item;
+    item.key = key;
+    item.value = std::to_string(value);
+    items_.push_back(item);
+}
+
+void SimReport::Add(const std::string& key, double value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.4f", value);
+    Item item;
+    item.key = key;
+    item.value = buf;
+    items_.push_back(item);
+}
+
+void SimReport::Add(const std::string& key, const std::string& value) {
+    Item item;
+    item.key = key;
+    item.value = Quote(value);
+    items_.push_back(item);
+}
+
+void SimReport::Add(const std::string& key, const SimReport& value) {
+    Item item;
+    item.key = key;
+    item.object.push_back(value);
+    items_.push_back(item);
+}
+
+void SimReport::AddPercentiles(const std::string& key, std::vector<uint64_t> samples) {
+    SimReport percentiles;
+    if (samples.empty()) {
+        percentiles.Add("p50", (int64_t)-1);
+        percentiles.Add("p90", (int64_t)-1);
+        percentiles.Add("p99", (int64_t)-1);
+        percentiles.Add("max", (int64_t)-1);
+        Add(key, percentiles);
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](uint32_t percent) {
+        size_t index = (samples.size() * percent + 99) / 100;
+        index = index == 0 ? 0 : index - 1;
+        return (int64_t)samples[std::min(index, samples.size() - 1)];
+    };
+    percentiles.Add("p50", at(50));
+    percentiles.Add("p90", at(90));
+    percentiles.Add("p99", at(99));
+    percentiles.Add("max", (int64_t)samples.back());
+    Add(key, percentiles);
+}
+
+std::string SimReport::ToString(int indent) const {
+    const std::string pad(indent + 2, ' ');
+    std::string str = "{\n";
+    for (size_t i = 0; i < items_.size(); ++i) {
+        str += pad + Quote(items_[i].key) + ": ";
+        if (!items_[i].object.empty()) {
+            str += items_[i].object[0].ToString(indent + 2);
+        } else {
+            str += items_[i].value;
+        }
+        str += i + 1 < items_.size() ? ",\n" : "\n";
+    }
+    str += std::string(indent, ' ') + "}";
+    return str;
+}
+
+std::string SimReport::Quote(const std::string& str) {
+    std::string quoted = "\"";
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    quoted += "\"";
+    return quoted;
+}
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
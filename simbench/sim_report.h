@@ -0,0 +1,40 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+// flat json object writer, values keep insertion order
+class SimReport {
+public:
+    void Add(const std::string& key, int64_t value);
+    void Add(const std::string& key, double value);
+    void Add(const std::string& key, const std::string& value);
+    void Add(const std::string& key, const SimReport& value);
+    // p50/p90/p99/max of samples, all -1 when there are none
+    void AddPercentiles(const std::string& key, std::vector<uint64_t> samples);
+    std::string ToString(int indent = 0) const;
+
+private:
+    static std::string Quote(const std::string& str);
+
+    // (key, serialized value), nested objects are kept as reports
+    struct Item {
+        std::string key;
+        std::string value;
+        std::vector<SimReport> object;
+    };
+    std::vector<Item> items_;
+};
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
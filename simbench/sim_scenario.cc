@@ -0,0 +1,396 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "sim_scenario.h"
+
+#include <time.h>
+
+#include <algorithm>
+
+#include "xpbase/base/top_log.h"
+#include "xkad/routing_table/lock_stats.h"
+#include "sim_network.h"
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+static const uint64_t kConvergeCheckMs = 100;
+static const uint32_t kConvergeTableSize = 8;
+static const uint64_t kLookupIntervalMs = 5;
+static const uint64_t kLookupWaitMs = 10 * 1000;
+static const uint32_t kChurnLookupIntervalMs = 50;
+static const uint32_t kPartitionLookups = 200;
+static const uint32_t kHealProbeLookups = 20;
+static const uint64_t kHealProbeWaitMs = 2000;
+static const double kHealSuccessRate = 0.95;
+
+static uint64_t ProcessCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+SimScenario::SimScenario(const SimOptions& options) : options_(options) {}
+
+SimScenario::~SimScenario() {}
+
+bool SimScenario::Run(const std::string& name, SimReport& report) {
+    LoopbackLink link;
+    link.latency_ms = options_.latency_ms;
+    link.jitter_ms = options_.jitter_ms;
+    link.loss = options_.loss_percent / 100.0;
+    SimNetwork network(options_.seed, link);
+    const uint64_t cpu_begin_ns = ProcessCpuNs();
+    LockStats::Instance()->Reset();
+
+    report.Add("scenario", name);
+    report.Add("nodes", (int64_t)options_.nodes);
+    report.Add("seed", (int64_t)options_.seed);
+    report.Add("latency_ms", (int64_t)options_.latency_ms);
+    report.Add("jitter_ms", (int64_t)options_.jitter_ms);
+    report.Add("loss_percent", (int64_t)options_.loss_percent);
+    bool ret = Bootstrap(network, report);
+    if (ret) {
+        if (name == "lookup") {
+            ret = LookupStorm(network, report);
+        } else if (name == "churn") {
+            ret = Churn(network, report);
+        } else if (name == "partition") {
+            ret = Partition(network, report);
+        }
+    }
+
+    AddNetworkStats(network, report);
+    report.Add("virtual_ms", (int64_t)network.scheduler()->now_ms());
+    report.Add("cpu_ms", (int64_t)((ProcessCpuNs() - cpu_begin_ns) / 1000000));
+    report.Add("rt_cpu_ms", (int64_t)(network.handle_cpu_ns() / 1000000));
+    AddLockStats(report);
+    return ret;
+}
+
+bool SimScenario::Bootstrap(SimNetwork& network, SimReport& report) {
+    SimSchedulerPtr scheduler = network.scheduler();
+    if (!network.AddNode()) {
+        return false;
+    }
+
+    bool add_failed = false;
+    for (uint32_t i = 1; i < options_.nodes; ++i) {
+        scheduler->Schedule(i * options_.join_interval_ms, [&network, &add_failed]() {
+            if (!network.AddNode()) {
+                add_failed = true;
+            }
+        });
+    }
+
+    // joined and knows enough nodes to route
+    const uint32_t min_size = MinTableSize();
+    const uint64_t begin_ms = scheduler->now_ms();
+    int64_t convergence_ms = -1;
+    while (scheduler->now_ms() - begin_ms < options_.converge_timeout_ms) {
+        scheduler->RunFor(kConvergeCheckMs);
+        if (add_failed) {
+            TOP_ERROR("simbench add node failed");
+            return false;
+        }
+        if (network.nodes().size() == options_.nodes && network.AllJoined(min_size)) {
+            convergence_ms = scheduler->now_ms() - begin_ms;
+            break;
+        }
+    }
+
+    report.Add("last_join_ms", (int64_t)((options_.nodes - 1) * options_.join_interval_ms));
+    report.Add("convergence_ms", convergence_ms);
+    return true;
+}
+
+bool SimScenario::LookupStorm(SimNetwork& network, SimReport& report) {
+    auto indexes = RunLookups(
+            network,
+            options_.lookups,
+            kLookupIntervalMs,
+            kLookupWaitMs,
+            [this, &network](uint32_t& src, uint32_t& des) {
+                return PickAlive(network, src, des);
+            });
+    SimReport lookup;
+    AddLookupStats(network, indexes, lookup);
+    report.Add("lookup", lookup);
+    return true;
+}
+
+bool SimScenario::Churn(SimNetwork& network, SimReport& report) {
+    SimSchedulerPtr scheduler = network.scheduler();
+    uint32_t graceful = 0;
+    uint32_t crash = 0;
+    uint32_t joined = 0;
+    bool add_failed = false;
+    // one node leaves and a fresh one joins every interval, the size stays
+    const uint64_t churn_task = scheduler->SchedulePeriodic(
+            options_.churn_interval_ms,
+            options_.churn_interval_ms,
+            [this, &network, scheduler, &graceful, &crash, &joined, &add_failed]() {
+        std::vector<uint32_t> alive;
+        for (auto& node : network.nodes()) {
+            if (node->alive() && node->index() != 0) {
+                alive.push_back(node->index());
+            }
+        }
+        if (!alive.empty()) {
+            SimNodePtr node = network.nodes()[alive[scheduler->random()() % alive.size()]];
+            if (scheduler->random()() % 2 == 0) {
+                network.StopNode(node->index(), true);
+                ++graceful;
+            } else {
+                network.StopNode(node->index(), false);
+                network.ReportOffline(node->ip(), node->port(), options_.detect_ms);
+                ++crash;
+            }
+        }
+        if (network.AddNode()) {
+            ++joined;
+        } else {
+            add_failed = true;
+        }
+    });
+
+    auto pick = [this, &network](uint32_t& src, uint32_t& des) {
+        return PickAlive(network, src, des);
+    };
+    auto indexes = RunLookups(
+            network,
+            options_.duration_ms / kChurnLookupIntervalMs,
+            kChurnLookupIntervalMs,
+            0,
+            pick);
+    scheduler->Cancel(churn_task);
+    if (add_failed) {
+        TOP_ERROR("simbench add node failed");
+        return false;
+    }
+
+    uint64_t entries = 0;
+    uint64_t stale = 0;
+    uint32_t min_size = 0;
+    network.GetTableStats(entries, stale, min_size);
+    SimReport churn;
+    churn.Add("graceful_leaves", (int64_t)graceful);
+    churn.Add("crashes", (int64_t)crash);
+    churn.Add("joins", (int64_t)joined);
+    churn.Add("stale_ratio", entries == 0 ? 0.0 : (double)stale / entries);
+    SimReport lookup;
+    AddLookupStats(network, indexes, lookup);
+    churn.Add("lookup", lookup);
+
+    // stale entries left after the last crash has been detected
+    scheduler->RunFor(options_.detect_ms + kConvergeCheckMs);
+    network.GetTableStats(entries, stale, min_size);
+    churn.Add("stale_ratio_settled", entries == 0 ? 0.0 : (double)stale / entries);
+    churn.Add("min_table_size", (int64_t)min_size);
+    indexes = RunLookups(network, kPartitionLookups, kLookupIntervalMs, kLookupWaitMs, pick);
+    SimReport lookup_after;
+    AddLookupStats(network, indexes, lookup_after);
+    churn.Add("lookup_after", lookup_after);
+    report.Add("churn", churn);
+    return true;
+}
+
+bool SimScenario::Partition(SimNetwork& network, SimReport& report) {
+    SimSchedulerPtr scheduler = network.scheduler();
+    std::vector<uint32_t> group_a;
+    std::vector<uint32_t> group_b;
+    for (auto& node : network.nodes()) {
+        if (node->index() < network.nodes().size() / 2) {
+            group_a.push_back(node->index());
+        } else {
+            group_b.push_back(node->index());
+        }
+    }
+    if (group_a.size() < 2 || group_b.size() < 2) {
+        TOP_ERROR("simbench partition needs at least 4 nodes");
+        return false;
+    }
+
+    auto pick_inside = [scheduler, &group_a, &group_b](uint32_t& src, uint32_t& des) {
+        const auto& group = scheduler->random()() % 2 == 0 ? group_a : group_b;
+        src = group[scheduler->random()() % group.size()];
+        des = group[scheduler->random()() % group.size()];
+        return src != des;
+    };
+    auto pick_cross = [scheduler, &group_a, &group_b](uint32_t& src, uint32_t& des) {
+        src = group_a[scheduler->random()() % group_a.size()];
+        des = group_b[scheduler->random()() % group_b.size()];
+        if (scheduler->random()() % 2 == 0) {
+            std::swap(src, des);
+        }
+        return true;
+    };
+
+    network.Partition(group_a, group_b, options_.detect_ms);
+    const uint64_t interval_ms = std::max<uint64_t>(options_.duration_ms / (2 * kPartitionLookups), 1);
+    auto inside = RunLookups(network, kPartitionLookups, interval_ms, 0, pick_inside);
+    auto cross = RunLookups(network, kPartitionLookups, interval_ms, 0, pick_cross);
+    SimReport partition;
+    partition.Add("group_a", (int64_t)group_a.size());
+    partition.Add("group_b", (int64_t)group_b.size());
+    SimReport lookup_inside;
+    AddLookupStats(network, inside, lookup_inside);
+    partition.Add("lookup_inside", lookup_inside);
+    SimReport lookup_cross;
+    AddLookupStats(network, cross, lookup_cross);
+    partition.Add("lookup_cross", lookup_cross);
+
+    // probe across the cut until lookups get through again
+    network.Heal();
+    const uint64_t heal_begin_ms = scheduler->now_ms();
+    int64_t heal_ms = -1;
+    std::vector<uint32_t> probe;
+    while (scheduler->now_ms() - heal_begin_ms < options_.duration_ms) {
+        probe = RunLookups(network, kHealProbeLookups, kLookupIntervalMs, kHealProbeWaitMs, pick_cross);
+        SimReport unused;
+        if (AddLookupStats(network, probe, unused) >= kHealSuccessRate) {
+            heal_ms = scheduler->now_ms() - heal_begin_ms;
+            break;
+        }
+    }
+    partition.Add("heal_ms", heal_ms);
+    SimReport lookup_healed;
+    AddLookupStats(network, probe, lookup_healed);
+    partition.Add("lookup_after_heal", lookup_healed);
+    report.Add("partition", partition);
+    return true;
+}
+
+std::vector<uint32_t> SimScenario::RunLookups(
+        SimNetwork& network,
+        uint32_t count,
+        uint64_t interval_ms,
+        uint64_t wait_ms,
+        std::function<bool(uint32_t&, uint32_t&)> pick) {
+    SimSchedulerPtr scheduler = network.scheduler();
+    std::vector<uint32_t> indexes;
+    for (uint32_t i = 0; i < count; ++i) {
+        scheduler->Schedule(i * interval_ms, [&network, &indexes, &pick]() {
+            uint32_t src = 0;
+            uint32_t des = 0;
+            if (pick(src, des)) {
+                indexes.push_back(network.StartLookup(src, des));
+            }
+        });
+    }
+    scheduler->RunFor(count * interval_ms + wait_ms);
+    return indexes;
+}
+
+bool SimScenario::PickAlive(SimNetwork& network, uint32_t& src, uint32_t& des) {
+    std::vector<uint32_t> alive;
+    for (auto& node : network.nodes()) {
+        if (node->alive()) {
+            alive.push_back(node->index());
+        }
+    }
+    if (alive.size() < 2) {
+        return false;
+    }
+
+    std::mt19937& random = network.scheduler()->random();
+    src = alive[random() % alive.size()];
+    do {
+        des = alive[random() % alive.size()];
+    } while (des == src);
+    return true;
+}
+
+double SimScenario::AddLookupStats(
+        SimNetwork& network,
+        const std::vector<uint32_t>& indexes,
+        SimReport& report) {
+    std::vector<uint64_t> hops;
+    std::vector<uint64_t> latency;
+    for (auto index : indexes) {
+        const SimLookup& lookup = network.lookups()[index];
+        if (!lookup.arrived) {
+            continue;
+        }
+        hops.push_back(lookup.hops);
+        latency.push_back(lookup.arrived_ms - lookup.sent_ms);
+    }
+
+    const double success_rate = indexes.empty() ? 0.0 : (double)hops.size() / indexes.size();
+    report.Add("count", (int64_t)indexes.size());
+    report.Add("success", (int64_t)hops.size());
+    report.Add("success_rate", success_rate);
+    report.AddPercentiles("hops", hops);
+    report.AddPercentiles("latency_ms", latency);
+    return success_rate;
+}
+
+void SimScenario::AddNetworkStats(SimNetwork& network, SimReport& report) {
+    const LoopbackStats stats = network.loopback()->stats();
+    const double nodes = std::max<size_t>(network.nodes().size(), 1);
+    SimReport traffic;
+    traffic.Add("messages", (int64_t)stats.sent);
+    traffic.Add("bytes", (int64_t)stats.bytes);
+    traffic.Add("messages_per_node", stats.sent / nodes);
+    traffic.Add("bytes_per_node", stats.bytes / nodes);
+    traffic.Add("dropped_loss", (int64_t)stats.dropped_loss);
+    traffic.Add("dropped_nat", (int64_t)stats.dropped_nat);
+    traffic.Add("dropped_unreachable", (int64_t)stats.dropped_unreachable);
+    report.Add("traffic", traffic);
+
+    uint64_t entries = 0;
+    uint64_t stale = 0;
+    uint32_t min_size = 0;
+    network.GetTableStats(entries, stale, min_size);
+    uint32_t alive = 0;
+    for (auto& node : network.nodes()) {
+        if (node->alive()) {
+            ++alive;
+        }
+    }
+    SimReport table;
+    table.Add("alive_nodes", (int64_t)alive);
+    table.Add("min_size", (int64_t)min_size);
+    table.Add("avg_size", alive == 0 ? 0.0 : (double)entries / alive);
+    report.Add("table", table);
+}
+
+void SimScenario::AddLockStats(SimReport& report) {
+    // empty unless built with XKAD_LOCK_STATS
+    std::vector<LockStatsInfo> infos;
+    LockStats::Instance()->GetAll(infos);
+    SimReport locks;
+    bool has_locks = false;
+    for (auto& info : infos) {
+        if (info.acquisitions == 0) {
+            continue;
+        }
+        SimReport lock;
+        lock.Add("acquisitions", (int64_t)info.acquisitions);
+        lock.Add("contended", (int64_t)info.contended);
+        lock.Add("wait_ms", info.wait_ns / 1e6);
+        lock.Add("wait_p99_ns", (int64_t)LockStatsPercentileNs(info.wait_histogram, 99));
+        lock.Add("max_wait_ns", (int64_t)info.max_wait_ns);
+        lock.Add("hold_ms", info.hold_ns / 1e6);
+        lock.Add("hold_p99_ns", (int64_t)LockStatsPercentileNs(info.hold_histogram, 99));
+        lock.Add("max_hold_ns", (int64_t)info.max_hold_ns);
+        locks.Add(info.name, lock);
+        has_locks = true;
+    }
+    if (has_locks) {
+        report.Add("locks", locks);
+    }
+}
+
+uint32_t SimScenario::MinTableSize() {
+    if (options_.nodes <= 1) {
+        return 0;
+    }
+    return std::min(options_.nodes - 1, kConvergeTableSize);
+}
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
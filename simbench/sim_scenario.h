@@ -0,0 +1,68 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "sim_report.h"
+
+namespace top {
+namespace kadmlia {
+namespace test {
+
+class SimNetwork;
+
+struct SimOptions {
+    uint32_t nodes{ 64 };
+    uint32_t seed{ 1 };
+    uint32_t latency_ms{ 20 };
+    uint32_t jitter_ms{ 10 };
+    uint32_t loss_percent{ 0 };
+    uint64_t join_interval_ms{ 50 };  // between two nodes starting
+    uint64_t converge_timeout_ms{ 120 * 1000 };
+    uint64_t duration_ms{ 60 * 1000 };  // churn and partition phase
+    uint32_t lookups{ 1000 };
+    uint64_t churn_interval_ms{ 1000 };
+    uint64_t detect_ms{ 5000 };  // udp layer heartbeat timeout
+};
+
+// each scenario runs a fresh network on a virtual clock and fills report,
+// false if the network could not be built
+class SimScenario {
+public:
+    explicit SimScenario(const SimOptions& options);
+    ~SimScenario();
+    bool Run(const std::string& name, SimReport& report);
+
+private:
+    bool Bootstrap(SimNetwork& network, SimReport& report);
+    bool LookupStorm(SimNetwork& network, SimReport& report);
+    bool Churn(SimNetwork& network, SimReport& report);
+    bool Partition(SimNetwork& network, SimReport& report);
+
+    // start count lookups spaced by interval_ms between (src, des) from pick,
+    // then run wait_ms more, returns the lookup indexes
+    std::vector<uint32_t> RunLookups(
+            SimNetwork& network,
+            uint32_t count,
+            uint64_t interval_ms,
+            uint64_t wait_ms,
+            std::function<bool(uint32_t&, uint32_t&)> pick);
+    // a random pair of alive nodes
+    bool PickAlive(SimNetwork& network, uint32_t& src, uint32_t& des);
+    double AddLookupStats(SimNetwork& network, const std::vector<uint32_t>& indexes, SimReport& report);
+    void AddNetworkStats(SimNetwork& network, SimReport& report);
+    void AddLockStats(SimReport& report);
+    uint32_t MinTableSize();
+
+    SimOptions options_;
+};
+
+}  // namespace test
+}  // namespace kadmlia
+}  // namespace top
@@ -318,5 +318,34 @@ void BootstrapCacheHelper::LoadBootstrapCache() {
     TOP_INFO("<blueshi>[%llu] LoadBootstrapCache success", kad_key_->GetServiceType());
 }
 
+void BootstrapCacheHelper::GetMemoryUsage(MemoryUsage& usage) {
+    usage.entries = 0;
+    usage.bytes = sizeof(BootstrapCacheHelper);
+    {
+        std::unique_lock<std::mutex> lock(public_endpoint_mutex_);
+        usage.entries += public_endpoints_.size();
+        usage.bytes += public_endpoints_.capacity() * sizeof(std::string);
+        for (auto& endpoint : public_endpoints_) {
+            usage.bytes += StringHeapBytes(endpoint);
+        }
+        usage.bytes += vec_endpoints_.capacity() * sizeof(BootstrapEndpoint);
+        for (auto& ep : vec_endpoints_) {
+            usage.bytes += StringHeapBytes(ep.first);
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(service_public_nodes_mutex_);
+        for (auto& item : service_public_nodes_) {
+            usage.bytes += kMapNodeBytes + sizeof(item);
+            if (item.second) {
+                usage.entries += item.second->size();
+                usage.bytes += kSharedPtrBlockBytes + sizeof(*item.second)
+                        + item.second->capacity() * sizeof(NodeInfoPtr);
+            }
+        }
+    }
+}
+
 }  // namespace kadmlia
 }  // namespace top
@@ -0,0 +1,202 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/bootstrap_join_limiter.h"
+
+#include "xpbase/base/top_log.h"
+
+namespace top {
+
+namespace kadmlia {
+
+BootstrapJoinLimiter::BootstrapJoinLimiter()
+        : BootstrapJoinLimiter(kJoinMaxPerSecond, kJoinSourceBurst) {}
+
+static uint32_t ClampRetryAfter(uint64_t retry_ms) {
+    if (retry_ms < kJoinRetryAfterMinMs) {
+        return kJoinRetryAfterMinMs;
+    }
+    if (retry_ms > kJoinRetryAfterMaxMs) {
+        return kJoinRetryAfterMaxMs;
+    }
+    return static_cast<uint32_t>(retry_ms);
+}
+
+BootstrapJoinLimiter::BootstrapJoinLimiter(uint32_t max_per_second, uint32_t source_burst)
+        : max_per_second_(max_per_second),
+          source_burst_(source_burst),
+          sources_(),
+          ips_(),
+          retry_sent_(),
+          mutex_(),
+          window_start_(),
+          window_count_(0) {}
+
+BootstrapJoinLimiter::~BootstrapJoinLimiter() {}
+
+void BootstrapJoinLimiter::SetLimits(uint32_t max_per_second, uint32_t source_burst) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    max_per_second_ = max_per_second;
+    source_burst_ = source_burst;
+    sources_.clear();
+    ips_.clear();
+    retry_sent_.clear();
+    window_count_ = 0;
+}
+
+int BootstrapJoinLimiter::Admit(const std::string& ip, uint16_t port, uint32_t& retry_after_ms) {
+    return Admit(ip, port, std::chrono::steady_clock::now(), retry_after_ms);
+}
+
+int BootstrapJoinLimiter::Admit(
+        const std::string& ip,
+        uint16_t port,
+        TimePoint now,
+        uint32_t& retry_after_ms) {
+    retry_after_ms = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (source_burst_ > 0) {
+        uint32_t wait_ms = TakeToken(
+                ips_,
+                ip,
+                source_burst_ * kJoinIpSources,
+                kJoinSourceRefillMs / kJoinIpSources,
+                now);
+        if (wait_ms == 0) {
+            wait_ms = TakeToken(
+                    sources_,
+                    ip + ":" + std::to_string(port),
+                    source_burst_,
+                    kJoinSourceRefillMs,
+                    now);
+        }
+        if (wait_ms > 0) {
+            return RetryLater(ip, now, wait_ms, retry_after_ms);
+        }
+    }
+
+    uint64_t wait_ms = TakeWindowSlot(now);
+    if (wait_ms > 0) {
+        return RetryLater(ip, now, wait_ms, retry_after_ms);
+    }
+    return kJoinAdmit;
+}
+
+uint32_t BootstrapJoinLimiter::sources_size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return sources_.size();
+}
+
+uint64_t BootstrapJoinLimiter::TakeWindowSlot(TimePoint now) {
+    if (max_per_second_ == 0) {
+        return 0;
+    }
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - window_start_).count();
+    if (elapsed_ms < 0 || elapsed_ms >= 1000) {
+        window_start_ = now;
+        window_count_ = 0;
+        elapsed_ms = 0;
+    }
+
+    ++window_count_;
+    if (window_count_ <= max_per_second_) {
+        return 0;
+    }
+
+    // spread the overflow over the following windows instead of sending
+    // every rejected joiner back at the same moment
+    uint32_t windows_ahead = (window_count_ - max_per_second_ - 1) / max_per_second_;
+    return (1000 - elapsed_ms) + (uint64_t)windows_ahead * 1000;
+}
+
+int BootstrapJoinLimiter::RetryLater(
+        const std::string& ip,
+        TimePoint now,
+        uint64_t wait_ms,
+        uint32_t& retry_after_ms) {
+    auto iter = retry_sent_.find(ip);
+    if (iter != retry_sent_.end()) {
+        if (now < iter->second) {
+            return kJoinDrop;
+        }
+    } else if (retry_sent_.size() >= kJoinLimiterMaxSources) {
+        for (auto it = retry_sent_.begin(); it != retry_sent_.end();) {
+            if (now >= it->second) {
+                it = retry_sent_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (retry_sent_.size() >= kJoinLimiterMaxSources) {
+            // can not remember the reply, do not send one
+            return kJoinDrop;
+        }
+    }
+
+    retry_after_ms = ClampRetryAfter(wait_ms);
+    retry_sent_[ip] = now + std::chrono::milliseconds(retry_after_ms);
+    return kJoinRetryLater;
+}
+
+uint32_t BootstrapJoinLimiter::TakeToken(
+        SourceBuckets& buckets,
+        const std::string& key,
+        uint32_t burst,
+        uint32_t refill_ms,
+        TimePoint now) {
+    auto iter = buckets.find(key);
+    if (iter == buckets.end()) {
+        if (buckets.size() >= kJoinLimiterMaxSources) {
+            EraseIdle(buckets, now);
+        }
+        if (buckets.size() >= kJoinLimiterMaxSources) {
+            // table full of active sources, let the global window decide
+            TOP_WARN("join limiter sources full(%d), admit %s untracked",
+                    (int)buckets.size(), key.c_str());
+            return 0;
+        }
+        buckets[key] = { burst - 1, now };
+        return 0;
+    }
+
+    SourceBucket& bucket = iter->second;
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - bucket.last_refill).count();
+    if (elapsed_ms > 0) {
+        uint64_t refill = (uint64_t)elapsed_ms / refill_ms;
+        if (bucket.tokens + refill >= burst) {
+            bucket.tokens = burst;
+            bucket.last_refill = now;
+        } else if (refill > 0) {
+            bucket.tokens += static_cast<uint32_t>(refill);
+            bucket.last_refill += std::chrono::milliseconds(refill * refill_ms);
+        }
+    }
+
+    if (bucket.tokens == 0) {
+        auto wait_ms = refill_ms - std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - bucket.last_refill).count();
+        return wait_ms > 0 ? static_cast<uint32_t>(wait_ms) : 1;
+    }
+    --bucket.tokens;
+    return 0;
+}
+
+void BootstrapJoinLimiter::EraseIdle(SourceBuckets& buckets, TimePoint now) {
+    // a bucket idle this long is full again, the same as no bucket
+    const auto idle = std::chrono::milliseconds((uint64_t)source_burst_ * kJoinSourceRefillMs);
+    for (auto iter = buckets.begin(); iter != buckets.end();) {
+        if (now - iter->second.last_refill >= idle) {
+            iter = buckets.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
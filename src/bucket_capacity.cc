@@ -0,0 +1,62 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/bucket_capacity.h"
+
+#include <map>
+#include <mutex>
+
+#include "xpbase/base/top_log.h"
+#include "xpbase/base/top_config.h"
+
+namespace top {
+
+namespace kadmlia {
+
+static std::mutex service_policy_mutex;
+static std::map<uint64_t, BucketCapacityPolicy> service_policy_map;
+
+void SetServiceBucketCapacityPolicy(uint64_t service_type, const BucketCapacityPolicy& policy) {
+    if (!policy.Valid()) {
+        TOP_WARN("invalid bucket capacity policy(%u, %u, %u) for service_type(%llu)",
+                policy.near_bucket_count, policy.near_k, policy.far_k, service_type);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(service_policy_mutex);
+    service_policy_map[service_type] = policy;
+}
+
+bool GetServiceBucketCapacityPolicy(uint64_t service_type, BucketCapacityPolicy& policy) {
+    std::unique_lock<std::mutex> lock(service_policy_mutex);
+    auto iter = service_policy_map.find(service_type);
+    if (iter == service_policy_map.end()) {
+        return false;
+    }
+    policy = iter->second;
+    return true;
+}
+
+bool GetBucketCapacityPolicyConfig(
+        const base::Config& config,
+        const std::string& section,
+        BucketCapacityPolicy& policy) {
+    BucketCapacityPolicy tmp_policy;
+    if (!config.Get(section, "near_buckets", tmp_policy.near_bucket_count)) {
+        return false;
+    }
+    config.Get(section, "near_bucket_k", tmp_policy.near_k);
+    config.Get(section, "far_bucket_k", tmp_policy.far_k);
+    if (!tmp_policy.Valid()) {
+        TOP_WARN("%s bucket capacity config invalid: near_bucket_k(%u) far_bucket_k(%u)",
+                section.c_str(), tmp_policy.near_k, tmp_policy.far_k);
+        return false;
+    }
+    policy = tmp_policy;
+    return true;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -17,6 +17,13 @@ namespace top {
 namespace kadmlia {
 
 static const int32_t kTimeCheckoutPeriod = 1000 * 1000;  // 1s
+static const uint32_t kTimedOutMaxSize = 4096;  // ids kept to count late responses
+
+static uint64_t ElapsedUs(std::chrono::steady_clock::time_point begin) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+    return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
 
 CallbackItem::~CallbackItem() {}
 
@@ -28,7 +35,10 @@ uint32_t CallbackManager::MessageId() {
 
 CallbackManager::CallbackManager()
         : callback_map_(),
-          callback_map_mutex_() {
+          callback_map_mutex_(XKAD_LOCK_NAME("CallbackManager::callback_map_mutex_")),
+          timed_out_map_(),
+          timed_out_queue_(),
+          rpc_stats_() {
     timer_.CallAfter(kTimeCheckoutPeriod, std::bind(&CallbackManager::TimeoutCheck, this));
 }
 
@@ -45,8 +55,10 @@ CallbackManager* CallbackManager::Instance() {
 void CallbackManager::Join() {
     timer_.Join();
     {
-        std::unique_lock<std::mutex> lock(callback_map_mutex_);
+        std::unique_lock<KadMutex> lock(callback_map_mutex_);
         callback_map_.clear();
+        timed_out_map_.clear();
+        timed_out_queue_.clear();
     }
 }
 
@@ -55,12 +67,21 @@ void CallbackManager::Add(
         int32_t timeout_sec,
         ResponseFunctor callback,
         int32_t expect_count) {
+    Add(message_id, timeout_sec, callback, expect_count, kRpcTypeUnknown);
+}
+
+void CallbackManager::Add(
+        uint32_t message_id,
+        int32_t timeout_sec,
+        ResponseFunctor callback,
+        int32_t expect_count,
+        int32_t message_type) {
     CallbackItemPtr item_ptr;
     item_ptr.reset(new CallbackItem{
         message_id, callback, nullptr,
         timeout_sec, expect_count, nullptr, nullptr });
-    std::unique_lock<std::mutex> lock(callback_map_mutex_);
-    callback_map_.insert(std::make_pair(message_id, item_ptr));
+    item_ptr->message_type = message_type;
+    Add(item_ptr);
 }
 
 void CallbackManager::Add(CallbackItemPtr callback_ptr) {
@@ -68,7 +89,11 @@ void CallbackManager::Add(CallbackItemPtr callback_ptr) {
         return;
     }
 
-    std::unique_lock<std::mutex> lock(callback_map_mutex_);
+    callback_ptr->add_time = std::chrono::steady_clock::now();
+    if (callback_ptr->message_type != kRpcTypeUnknown) {
+        rpc_stats_.OnRequest(callback_ptr->message_type);
+    }
+    std::unique_lock<KadMutex> lock(callback_map_mutex_);
     callback_map_.insert(std::make_pair(callback_ptr->message_id, callback_ptr));
 }
 
@@ -78,9 +103,15 @@ void CallbackManager::Callback(
         base::xpacket_t& packet) {
     CallbackItemPtr item_ptr;
     {
-        std::unique_lock<std::mutex> lock(callback_map_mutex_);
+        std::unique_lock<KadMutex> lock(callback_map_mutex_);
         auto iter = callback_map_.find(message_id);
         if (iter == callback_map_.end()) {
+            auto timed_out_iter = timed_out_map_.find(message_id);
+            if (timed_out_iter != timed_out_map_.end()) {
+                const int32_t message_type = timed_out_iter->second != kRpcTypeUnknown ?
+                        timed_out_iter->second : message.type();
+                rpc_stats_.OnLateResponse(message_type);
+            }
             return;
         }
 
@@ -92,6 +123,9 @@ void CallbackManager::Callback(
     }
 
     if (item_ptr) {
+        rpc_stats_.OnResponse(
+                item_ptr->message_type != kRpcTypeUnknown ? item_ptr->message_type : message.type(),
+                ElapsedUs(item_ptr->add_time));
         if (item_ptr->callback) {
             item_ptr->callback(kKadSuccess, message, packet);
         }
@@ -108,16 +142,20 @@ void CallbackManager::Callback(
 }
 
 void CallbackManager::Timeout(uint32_t message_id) {
-    Cancel(message_id, 0);
+    Cancel(message_id, 0, true);
 }
 
 // if no_callback is 0, call callback. if no_callback is 1, do not call callback
 void CallbackManager::Cancel(uint32_t message_id, uint32_t no_callback) {
+    Cancel(message_id, no_callback, false);
+}
+
+void CallbackManager::Cancel(uint32_t message_id, uint32_t no_callback, bool timed_out) {
     ResponseFunctor callback;
     CallbackItemPtr mutex_callback_item;
     int32_t expect_count = 0;
     {
-        std::unique_lock<std::mutex> lock(callback_map_mutex_);
+        std::unique_lock<KadMutex> lock(callback_map_mutex_);
         auto iter = callback_map_.find(message_id);
         if (iter == callback_map_.end()) {
             return;
@@ -126,9 +164,18 @@ void CallbackManager::Cancel(uint32_t message_id, uint32_t no_callback) {
         callback = iter->second->callback;
         mutex_callback_item = iter->second;
         expect_count = iter->second->expect_count;
+        if (timed_out) {
+            AddTimedOut(message_id, iter->second->message_type);
+        }
         callback_map_.erase(iter);
     }
 
+    if (timed_out) {
+        rpc_stats_.OnTimeout(mutex_callback_item->message_type);
+    } else {
+        rpc_stats_.OnCancel(mutex_callback_item->message_type);
+    }
+
     if (no_callback != 0)
         return;
     if (callback) {
@@ -154,10 +201,21 @@ void CallbackManager::Cancel(uint32_t message_id, uint32_t no_callback) {
     }
 }
 
+void CallbackManager::AddTimedOut(uint32_t message_id, int32_t message_type) {
+    if (!timed_out_map_.insert(std::make_pair(message_id, message_type)).second) {
+        return;
+    }
+    timed_out_queue_.push_back(message_id);
+    while (timed_out_queue_.size() > kTimedOutMaxSize) {
+        timed_out_map_.erase(timed_out_queue_.front());
+        timed_out_queue_.pop_front();
+    }
+}
+
 void CallbackManager::TimeoutCheck() {
     std::vector<uint32_t> message_vec;
     {
-        std::unique_lock<std::mutex> lock(callback_map_mutex_);
+        std::unique_lock<KadMutex> lock(callback_map_mutex_);
         for (auto iter = callback_map_.begin(); iter != callback_map_.end(); ++iter) {
             iter->second->timeout_sec--;
             if (iter->second->timeout_sec <= 0) {
@@ -26,11 +26,26 @@ ClientNodeInfo::ClientNodeInfo(const std::string& id)
 
 ClientNodeInfo::~ClientNodeInfo() {}
 
+uint64_t ClientNodeInfoBytes(const ClientNodeInfo& node) {
+    return sizeof(ClientNodeInfo) + kSharedPtrBlockBytes
+            + StringHeapBytes(node.node_id)
+            + StringHeapBytes(node.public_ip);
+}
+
 ClientNodeManager::ClientNodeManager()
         : client_nodes_map_(),
-        client_nodes_map_mutex_() {}
+        client_nodes_map_mutex_(XKAD_LOCK_NAME("ClientNodeManager::client_nodes_map_mutex_")),
+        memory_reporter_id_(0) {
+    memory_reporter_id_ = MemoryStats::Instance()->Register([this](std::vector<MemoryUsage>& usages) {
+        MemoryUsage usage;
+        GetMemoryUsage(usage);
+        usages.push_back(usage);
+    });
+}
 
-ClientNodeManager::~ClientNodeManager() {}
+ClientNodeManager::~ClientNodeManager() {
+    MemoryStats::Instance()->Unregister(memory_reporter_id_);
+}
 
 ClientNodeManager* ClientNodeManager::Instance() {
     static ClientNodeManager ins;
@@ -38,14 +53,14 @@ ClientNodeManager* ClientNodeManager::Instance() {
 }
 
 int ClientNodeManager::AddClientNode(ClientNodeInfoPtr node_ptr) {
-    std::unique_lock<std::mutex> lock(client_nodes_map_mutex_);
+    std::unique_lock<KadMutex> lock(client_nodes_map_mutex_);
     std::string key = node_ptr->node_id;
     client_nodes_map_[key] = node_ptr;
     return kKadSuccess;
 }
 
 void ClientNodeManager::RemoveClientNode(const std::string& node_id) {
-    std::unique_lock<std::mutex> lock(client_nodes_map_mutex_);
+    std::unique_lock<KadMutex> lock(client_nodes_map_mutex_);
     std::string key = node_id;
     auto iter = client_nodes_map_.find(key);
     if (iter != client_nodes_map_.end()) {
@@ -54,7 +69,7 @@ void ClientNodeManager::RemoveClientNode(const std::string& node_id) {
 }
 
 ClientNodeInfoPtr ClientNodeManager::FindClientNode(const std::string& node_id) {
-    std::unique_lock<std::mutex> lock(client_nodes_map_mutex_);
+    std::unique_lock<KadMutex> lock(client_nodes_map_mutex_);
     std::string key = node_id;
     auto iter = client_nodes_map_.find(key);
     if (iter != client_nodes_map_.end()) {
@@ -63,6 +78,19 @@ ClientNodeInfoPtr ClientNodeManager::FindClientNode(const std::string& node_id)
     return nullptr;
 }
 
+void ClientNodeManager::GetMemoryUsage(MemoryUsage& usage) {
+    usage.name = "client_node_manager";
+    usage.bytes = sizeof(ClientNodeManager);
+    std::unique_lock<KadMutex> lock(client_nodes_map_mutex_);
+    usage.entries = client_nodes_map_.size();
+    for (auto& item : client_nodes_map_) {
+        usage.bytes += kMapNodeBytes + sizeof(item) + StringHeapBytes(item.first);
+        if (item.second) {
+            usage.bytes += ClientNodeInfoBytes(*item.second);
+        }
+    }
+}
+
 }  // namespace kadmlia
 
 }  // namespace top
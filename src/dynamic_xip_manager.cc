@@ -63,6 +63,18 @@ ClientNodeInfoPtr DynamicXipManager::FindClientNode(const std::string& dy_xip) {
     return nullptr;
 }
 
+void DynamicXipManager::GetMemoryUsage(MemoryUsage& usage) {
+    usage.bytes = sizeof(DynamicXipManager);
+    std::unique_lock<std::mutex> lock(dy_xip_map_mutex_);
+    usage.entries = dy_xip_map_.size();
+    for (auto& item : dy_xip_map_) {
+        usage.bytes += kMapNodeBytes + sizeof(item) + StringHeapBytes(item.first);
+        if (item.second) {
+            usage.bytes += ClientNodeInfoBytes(*item.second);
+        }
+    }
+}
+
 }  // namespace kadmlia
 
 }  // namespace top
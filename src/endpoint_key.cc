@@ -0,0 +1,104 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/endpoint_key.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint64_t kIpv4MappedLow = 0x0000ffff00000000ull;
+// high word of a non-ip endpoint, inside the deprecated fec0::/10 site-local range
+static const uint64_t kUnparsedHigh = 0xfeffffffffffffffull;
+
+static uint64_t LoadBigEndian64(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static uint64_t Mix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+EndpointKey::EndpointKey() {}
+
+EndpointKey::EndpointKey(const std::string& ip, uint16_t in_port) : port(in_port) {
+    struct in_addr addr4;
+    if (inet_pton(AF_INET, ip.c_str(), &addr4) == 1) {
+        addr_high = 0;
+        addr_low = kIpv4MappedLow | ntohl(addr4.s_addr);
+        return;
+    }
+
+    struct in6_addr addr6;
+    if (inet_pton(AF_INET6, ip.c_str(), &addr6) == 1) {
+        addr_high = LoadBigEndian64(addr6.s6_addr);
+        addr_low = LoadBigEndian64(addr6.s6_addr + 8);
+        return;
+    }
+
+    addr_high = kUnparsedHigh;
+    addr_low = std::hash<std::string>()(ip);
+}
+
+bool EndpointKey::operator==(const EndpointKey& other) const {
+    return addr_low == other.addr_low && addr_high == other.addr_high && port == other.port;
+}
+
+bool EndpointKey::operator!=(const EndpointKey& other) const {
+    return !(*this == other);
+}
+
+bool EndpointKey::operator<(const EndpointKey& other) const {
+    if (addr_high != other.addr_high) {
+        return addr_high < other.addr_high;
+    }
+    if (addr_low != other.addr_low) {
+        return addr_low < other.addr_low;
+    }
+    return port < other.port;
+}
+
+bool EndpointKey::IsIpv4() const {
+    return addr_high == 0 && (addr_low & 0xffffffff00000000ull) == kIpv4MappedLow;
+}
+
+std::string EndpointKey::string() const {
+    char buf[INET6_ADDRSTRLEN + 8] = {0};
+    if (IsIpv4()) {
+        struct in_addr addr4;
+        addr4.s_addr = htonl(static_cast<uint32_t>(addr_low));
+        inet_ntop(AF_INET, &addr4, buf, sizeof(buf));
+    } else if (addr_high == kUnparsedHigh) {
+        snprintf(buf, sizeof(buf), "#%016llx", (unsigned long long)addr_low);
+    } else {
+        struct in6_addr addr6;
+        for (int i = 0; i < 8; ++i) {
+            addr6.s6_addr[i] = static_cast<uint8_t>(addr_high >> (56 - 8 * i));
+            addr6.s6_addr[8 + i] = static_cast<uint8_t>(addr_low >> (56 - 8 * i));
+        }
+        inet_ntop(AF_INET6, &addr6, buf, sizeof(buf));
+    }
+    return std::string(buf) + ":" + std::to_string(port);
+}
+
+size_t EndpointKeyHash::operator()(const EndpointKey& key) const {
+    return static_cast<size_t>(Mix64(key.addr_high ^ Mix64(key.addr_low ^ ((uint64_t)key.port << 48))));
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
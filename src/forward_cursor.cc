@@ -0,0 +1,45 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/forward_cursor.h"
+
+#include <algorithm>
+
+#include "xkad/routing_table/peer_rtt.h"
+
+namespace top {
+
+namespace kadmlia {
+
+ForwardCursor::ForwardCursor(
+        const std::string& target_id,
+        std::vector<NodeInfoPtr>&& nodes,
+        bool rtt_aware)
+        : target_id_(target_id),
+          nodes_(std::move(nodes)),
+          pos_(0),
+          rtt_aware_(rtt_aware) {}
+
+ForwardCursor::~ForwardCursor() {}
+
+NodeInfoPtr ForwardCursor::Next() {
+    if (pos_ >= nodes_.size()) {
+        return nullptr;
+    }
+
+    if (rtt_aware_) {
+        // keep the rest in distance order for the following calls
+        size_t best = SelectLowLatencyIndex(target_id_, nodes_, pos_);
+        std::rotate(nodes_.begin() + pos_, nodes_.begin() + best, nodes_.begin() + best + 1);
+    }
+    return nodes_[pos_++];
+}
+
+uint32_t ForwardCursor::remaining() const {
+    return nodes_.size() - pos_;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
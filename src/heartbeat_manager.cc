@@ -20,14 +20,75 @@ void HeartbeatManagerIntf::OnHeartbeatCallback(const std::string& ip, uint16_t p
 // ----------------------------------------------------------------
 void HeartbeatManager::Register(const std::string& name, OfflineCallback cb) {
     std::unique_lock<std::mutex> lock(mutex_);
-    vec_cb_.push_back(cb);
+    broadcast_cb_map_[name] = cb;
     TOP_INFO("[ht_cb] register %s", name.c_str());
 }
 
+void HeartbeatManager::RegisterSubscriber(const std::string& name, OfflineCallback cb) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    subscriber_cb_map_[name] = cb;
+    TOP_INFO("[ht_cb] register subscriber %s", name.c_str());
+}
+
+void HeartbeatManager::Unregister(const std::string& name) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    broadcast_cb_map_.erase(name);
+    if (subscriber_cb_map_.erase(name) > 0) {
+        for (auto iter = endpoint_subscribers_.begin(); iter != endpoint_subscribers_.end();) {
+            iter->second.erase(name);
+            if (iter->second.empty()) {
+                iter = endpoint_subscribers_.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+    TOP_INFO("[ht_cb] unregister %s", name.c_str());
+}
+
+void HeartbeatManager::Subscribe(const std::string& name, const std::string& ip, uint16_t port) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    endpoint_subscribers_[EndpointKey(ip, port)][name] += 1;
+}
+
+void HeartbeatManager::Unsubscribe(const std::string& name, const std::string& ip, uint16_t port) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = endpoint_subscribers_.find(EndpointKey(ip, port));
+    if (iter == endpoint_subscribers_.end()) {
+        return;
+    }
+
+    auto sub_iter = iter->second.find(name);
+    if (sub_iter != iter->second.end() && --sub_iter->second == 0) {
+        iter->second.erase(sub_iter);
+    }
+    if (iter->second.empty()) {
+        endpoint_subscribers_.erase(iter);
+    }
+}
+
 void HeartbeatManager::OnHeartbeatFailed(const std::string& ip, uint16_t port) {
     TOP_INFO("[ht_cb] %s:%d heartbeat failed", ip.c_str(), (int)port);
-    std::unique_lock<std::mutex> lock(mutex_);
-    for (auto& cb : vec_cb_) {
+    // call out of the lock, callbacks unsubscribe the dropped nodes
+    std::vector<OfflineCallback> vec_cb;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (auto& kv : broadcast_cb_map_) {
+            vec_cb.push_back(kv.second);
+        }
+
+        auto iter = endpoint_subscribers_.find(EndpointKey(ip, port));
+        if (iter != endpoint_subscribers_.end()) {
+            for (auto& sub : iter->second) {
+                auto cb_iter = subscriber_cb_map_.find(sub.first);
+                if (cb_iter != subscriber_cb_map_.end()) {
+                    vec_cb.push_back(cb_iter->second);
+                }
+            }
+        }
+    }
+
+    for (auto& cb : vec_cb) {
         cb(ip, port);
     }
 }
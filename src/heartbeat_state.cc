@@ -2,167 +2,242 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-
-// #include "xkad/routing_table/heartbeat_state.h"
-
-// #include <assert.h>
-// #include <time.h>
-
-// #include <utility>
-// #include <string>
-// #include <map>
-// #include <mutex>
-// #include <thread>
-// #include <chrono>
-// #include <iostream>
-// #include <functional>
-
-// #include "xpbase/base/top_log.h"
-// #include "xpbase/base/top_timer.h"
-// #include "xkad/routing_table/routing_utils.h"
-// #include "xtransport/proto/transport.pb.h"
-// #include "xkad/proto/kadmlia.pb.h"
-
-// namespace top {
-// namespace kadmlia {
-
-// typedef std::chrono::system_clock Clock;
-// typedef std::mutex Mutex;
-// typedef std::lock_guard<Mutex> Guard;
-// typedef std::function<void ()> Callback;
-
-// class HeartbeatStateImpl : public HeartbeatState {
-// public:
-//     explicit HeartbeatStateImpl(const std::string &type) {
-//         Init();
-//         type_ = type;
-//     }
-
-//     // void Join() override {
-//     //     if (timer_ != nullptr) {
-//     //         timer_->close();
-//     //         timer_->release_ref();
-//     //         timer_ = nullptr;
-//     //     }
-
-//     //     if (iothread_ != nullptr) {
-//     //         iothread_->close();
-//     //         iothread_->release_ref();
-//     //         iothread_ = nullptr;
-//     //     }
-//     // }
-
-//     // req
-//     void Send(const transport::protobuf::RoutingMessage& message, const std::string& peer_ip,
-//             uint16_t peer_port) override {
-//         if (message.type() !=  kKadHeartbeatRequest &&
-//                 message.type() !=  kKadHeartbeatResponse)
-//             return;
-
-//         static bool flag_message_size = false;
-//         if (!flag_message_size) {
-//             flag_message_size = true;
-//             TOP_INFO("[ht_state] heartbeat request message size: %d bytes",
-//                 static_cast<int>(message.ByteSizeLong()));
-//         }
-
-//         Guard guard(mutex_);
-//         ++sum_1_;
-//     }
-
-//     void Recv(const transport::protobuf::RoutingMessage& message) {
-//         if (message.type() !=  kKadHeartbeatRequest &&
-//                 message.type() !=  kKadHeartbeatResponse)
-//             return;
-
-//         static bool flag_message_size = false;
-//         if (!flag_message_size) {
-//             flag_message_size = true;
-//             TOP_INFO("[ht_state] heartbeat response message size: %d bytes",
-//                 static_cast<int>(message.ByteSizeLong()));
-//         }
-
-//         Guard guard(mutex_);
-//         ++sum_1_;
-//     }
-
-//     void DumpAndReset_1() {
-//         TOP_DEBUG("[ht_state] %s sum_1: %d", type_.c_str(), sum_1_);
-//         sum_1_ = 0;
-//     }
-
-//     void DumpAndReset_5() {
-//         if (n_calls_ > 0 && n_calls_ % 5 == 0) {
-//             TOP_DEBUG("[ht_state] %s sum_5: %d", type_.c_str(), sum_5_);
-//             sum_5_ = 0;
-//         }
-//     }
-
-//     void DumpAndReset_30() {
-//         if (n_calls_ > 0 && n_calls_ % 30 == 0) {
-//             TOP_DEBUG("[ht_state] %s sum_30: %d", type_.c_str(), sum_30_);
-//             sum_30_ = 0;
-//         }
-//     }
-
-// private:
-//     void TimerProc() {
-//         Guard guard(mutex_);
-//         // sum_1_
-//         sum_5_ += sum_1_;
-//         sum_30_ += sum_1_;
-//         ++n_calls_;
-
-//         // TOP_INFO("[ht_state] ========== begin ========== ");
-//         DumpAndReset_1();
-//         DumpAndReset_5();
-//         DumpAndReset_30();
-//         // TOP_INFO("[ht_state] ========== end ========== ");
-//     }
-
-//     // init
-//     void Init() {
-//         TOP_INFO("[ht_state] initing ...");
-
-//         timer_->Start(
-//                 10 * 1000, 1000 * 1000,
-//                 std::bind(&HeartbeatStateImpl::TimerProc, this));
-//         TOP_INFO("[ht_state] inited");
-//     }
-
-// private:
-//     Mutex mutex_;
-//     std::string type_;
-//     int n_calls_{0};
-//     int sum_1_{0};  // 1 unit
-//     int sum_5_{0};  // 5 units
-//     int sum_30_{0};  // 30 units
-
-//     std::shared_ptr<base::TimerRepeated> timer_{std::make_shared<base::TimerRepeated>()};
-// };
-
-// HeartbeatState& HeartbeatState::Instance() {
-//     static HeartbeatStateImpl ins("send");
-//     return ins;
-// }
-
-// class HeartbeatStateRecvImpl : public HeartbeatStateRecv {
-// public:
-//     void Recv(const transport::protobuf::RoutingMessage& message) override {
-//         recv_state_.Recv(message);
-//     }
-//     // void Join() override {
-//     //     recv_state_.Join();
-//     // }
-
-// private:
-//     HeartbeatStateImpl recv_state_{"recv"};
-// };
-
-// HeartbeatStateRecv& HeartbeatStateRecv::Instance() {
-//     static HeartbeatStateRecvImpl ins;
-//     return ins;
-// }
-
-// }  // namespace kadmlia
-// }  // namespace top
+#include "xkad/routing_table/heartbeat_state.h"
+
+#include <stdio.h>
+
+#include <thread>
+#include <algorithm>
+#include <functional>
+
+#include "xpbase/base/top_log.h"
+
+namespace top {
+
+namespace kadmlia {
+
+std::string TrafficTypeName(int type) {
+    switch (type) {
+    case kKadConnectRequest:
+        return "connect_request";
+    case kKadConnectResponse:
+        return "connect_response";
+    case kKadHandshake:
+        return "handshake";
+    case kKadBootstrapJoinRequest:
+        return "join_request";
+    case kKadBootstrapJoinResponse:
+        return "join_response";
+    case kKadFindNodesRequest:
+        return "find_nodes_request";
+    case kKadFindNodesResponse:
+        return "find_nodes_response";
+    case kKadAck:
+        return "ack";
+    case kKadHeartbeatRequest:
+        return "heartbeat_request";
+    case kKadHeartbeatResponse:
+        return "heartbeat_response";
+    case kKadNatDetectRequest:
+        return "nat_detect_request";
+    case kKadNatDetectResponse:
+        return "nat_detect_response";
+    case kKadNatDetectHandshake2Node:
+        return "nat_handshake_node";
+    case kKadNatDetectHandshake2Boot:
+        return "nat_handshake_boot";
+    case kKadNatDetectFinish:
+        return "nat_detect_finish";
+    case kKadDropNodeRequest:
+        return "drop_node_request";
+    default:
+        return "type_" + std::to_string(type);
+    }
+}
+
+static void Subtract(const TrafficCounters& now, const TrafficCounters& before, TrafficCounters& diff) {
+    diff.sent_messages = now.sent_messages - before.sent_messages;
+    diff.sent_bytes = now.sent_bytes - before.sent_bytes;
+    diff.recv_messages = now.recv_messages - before.recv_messages;
+    diff.recv_bytes = now.recv_bytes - before.recv_bytes;
+}
+
+HeartbeatState* HeartbeatState::Instance() {
+    static HeartbeatState ins;
+    return &ins;
+}
+
+HeartbeatState::HeartbeatState()
+        : history_(),
+          history_mutex_(),
+          timer_(),
+          summary_period_s_(kTrafficStatsSummaryPeriod),
+          ticks_(0),
+          timer_mutex_() {
+    for (auto& shard : shards_) {
+        for (auto& counters : shard.counters) {
+            for (auto& counter : counters) {
+                counter = 0;
+            }
+        }
+    }
+}
+
+HeartbeatState::~HeartbeatState() {
+    Stop();
+}
+
+uint32_t HeartbeatState::ShardIndex() {
+    static thread_local uint32_t shard = static_cast<uint32_t>(
+            std::hash<std::thread::id>()(std::this_thread::get_id()) % kTrafficStatsShards);
+    return shard;
+}
+
+void HeartbeatState::Send(int type, uint32_t bytes) {
+    if (type < 0 || type >= kTrafficStatsTypes) {
+        return;
+    }
+    auto& counters = shards_[ShardIndex()].counters[type];
+    counters[kSentMessages].fetch_add(1, std::memory_order_relaxed);
+    counters[kSentBytes].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void HeartbeatState::Recv(int type, uint32_t bytes) {
+    if (type < 0 || type >= kTrafficStatsTypes) {
+        return;
+    }
+    auto& counters = shards_[ShardIndex()].counters[type];
+    counters[kRecvMessages].fetch_add(1, std::memory_order_relaxed);
+    counters[kRecvBytes].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void HeartbeatState::Sum(std::vector<TrafficCounters>& totals) {
+    totals.assign(kTrafficStatsTypes, TrafficCounters());
+    for (auto& shard : shards_) {
+        for (int i = 0; i < kTrafficStatsTypes; ++i) {
+            auto& counters = shard.counters[i];
+            totals[i].sent_messages += counters[kSentMessages].load(std::memory_order_relaxed);
+            totals[i].sent_bytes += counters[kSentBytes].load(std::memory_order_relaxed);
+            totals[i].recv_messages += counters[kRecvMessages].load(std::memory_order_relaxed);
+            totals[i].recv_bytes += counters[kRecvBytes].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void HeartbeatState::Tick() {
+    std::vector<TrafficCounters> totals;
+    Sum(totals);
+    std::unique_lock<std::mutex> lock(history_mutex_);
+    history_.push_back(totals);
+    while (history_.size() > kTrafficStatsWindows[kTrafficStatsWindowCount - 1] + 1) {
+        history_.pop_front();
+    }
+}
+
+void HeartbeatState::Get(std::vector<TrafficStatsInfo>& infos) {
+    infos.clear();
+    std::vector<TrafficCounters> totals;
+    Sum(totals);
+
+    std::unique_lock<std::mutex> lock(history_mutex_);
+    const TrafficCounters zero;
+    for (int i = 0; i < kTrafficStatsTypes; ++i) {
+        if (totals[i].sent_messages == 0 && totals[i].recv_messages == 0) {
+            continue;
+        }
+
+        TrafficStatsInfo info;
+        info.type = i;
+        info.total = totals[i];
+        // windows end at the last tick, so they cover whole seconds
+        if (!history_.empty()) {
+            const size_t last = history_.size() - 1;
+            for (uint32_t w = 0; w < kTrafficStatsWindowCount; ++w) {
+                const TrafficCounters& before = last >= kTrafficStatsWindows[w] ?
+                        history_[last - kTrafficStatsWindows[w]][i] : zero;
+                Subtract(history_[last][i], before, info.windows[w]);
+            }
+        }
+        infos.push_back(info);
+    }
+    lock.unlock();
+
+    std::sort(infos.begin(), infos.end(), [](const TrafficStatsInfo& a, const TrafficStatsInfo& b) {
+        return a.total.sent_bytes + a.total.recv_bytes > b.total.sent_bytes + b.total.recv_bytes;
+    });
+}
+
+std::string HeartbeatState::Dump() {
+    std::vector<TrafficStatsInfo> infos;
+    Get(infos);
+    std::string result;
+    char line[256];
+    snprintf(line, sizeof(line), "%-20s %10s %12s %10s %12s %10s %10s %10s\n",
+            "type", "sent", "sent_bytes", "recv", "recv_bytes",
+            "B/s_1s", "B/s_5s", "B/s_30s");
+    result += line;
+    for (auto& info : infos) {
+        double rate[kTrafficStatsWindowCount];
+        for (uint32_t w = 0; w < kTrafficStatsWindowCount; ++w) {
+            rate[w] = (double)(info.windows[w].sent_bytes + info.windows[w].recv_bytes)
+                    / kTrafficStatsWindows[w];
+        }
+        snprintf(line, sizeof(line), "%-20s %10llu %12llu %10llu %12llu %10.0f %10.0f %10.0f\n",
+                TrafficTypeName(info.type).c_str(),
+                (unsigned long long)info.total.sent_messages,
+                (unsigned long long)info.total.sent_bytes,
+                (unsigned long long)info.total.recv_messages,
+                (unsigned long long)info.total.recv_bytes,
+                rate[0], rate[1], rate[2]);
+        result += line;
+    }
+    return result;
+}
+
+void HeartbeatState::Reset() {
+    for (auto& shard : shards_) {
+        for (auto& counters : shard.counters) {
+            for (auto& counter : counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(history_mutex_);
+    history_.clear();
+}
+
+void HeartbeatState::Start(base::TimerManager* timer_manager, uint32_t summary_period_s) {
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+    if (timer_) {
+        return;
+    }
+    summary_period_s_ = summary_period_s;
+    timer_ = std::make_shared<base::TimerRepeated>(timer_manager, "HeartbeatState");
+    timer_->Start(
+            1000 * 1000,
+            1000 * 1000,
+            std::bind(&HeartbeatState::TimerProc, this));
+}
+
+void HeartbeatState::Stop() {
+    std::shared_ptr<base::TimerRepeated> timer;
+    {
+        std::unique_lock<std::mutex> lock(timer_mutex_);
+        timer.swap(timer_);
+    }
+    if (timer) {
+        timer->Join();
+    }
+}
+
+void HeartbeatState::TimerProc() {
+    Tick();
+    ++ticks_;
+    if (summary_period_s_ > 0 && ticks_ % summary_period_s_ == 0) {
+        TOP_INFO("[ht_state] traffic by message type:\n%s", Dump().c_str());
+    }
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
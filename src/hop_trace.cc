@@ -0,0 +1,64 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/hop_trace.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+namespace top {
+
+namespace kadmlia {
+
+HopTracer* HopTracer::Instance() {
+    static HopTracer ins(kHopTraceRingSize);
+    return &ins;
+}
+
+HopTracer::HopTracer(uint32_t capacity)
+        : ring_(std::max(capacity, 1u)),
+          sample_one_in_(0) {}
+
+HopTracer::~HopTracer() {}
+
+bool HopTracer::Sampled(uint64_t trace_id) const {
+    const uint32_t one_in = sample_rate();
+    if (one_in == 0) {
+        return false;
+    }
+    // trace ids are hashes, the low bits are as good as random
+    return trace_id % one_in == 0;
+}
+
+void HopTracer::Record(const HopTraceRecord& record) {
+    ring_.Push(record);
+}
+
+void HopTracer::Get(std::vector<HopTraceRecord>& records) {
+    ring_.Get(records);
+}
+
+std::string HopTracer::Dump() {
+    std::vector<HopTraceRecord> records;
+    Get(records);
+    std::string result = "trace_id,arrival_us,node,next_hop,queue_delay_us,type,hop_num\n";
+    char line[192];
+    for (auto& record : records) {
+        snprintf(line, sizeof(line), "%016llx,%llu,%016llx,%016llx,%u,%u,%u\n",
+                (unsigned long long)record.trace_id,
+                (unsigned long long)record.arrival_us,
+                (unsigned long long)record.node_hash,
+                (unsigned long long)record.next_hop_hash,
+                record.queue_delay_us,
+                record.message_type,
+                record.hop_num);
+        result += line;
+    }
+    return result;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -21,6 +21,7 @@
 #include "xkad/routing_table/node_detection_manager.h"
 #include "xkad/routing_table/client_node_manager.h"
 #include "xkad/routing_table/local_node_info.h"
+#include "xkad/routing_table/heartbeat_state.h"
 
 namespace top {
 
@@ -40,77 +41,90 @@ void KadMessageHandler::set_routing_ptr(std::shared_ptr<RoutingTable> routing_pt
 }
 
 void KadMessageHandler::AddBaseHandlers() {
-    message_manager_->RegisterMessageProcessor(kKadConnectRequest, [this](
+    RegisterKadProcessor(kKadConnectRequest, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleConnectRequest(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadHandshake, [this](
+    RegisterKadProcessor(kKadHandshake, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleHandshake(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadBootstrapJoinRequest, [this](
+    RegisterKadProcessor(kKadBootstrapJoinRequest, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleBootstrapJoinRequest(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadBootstrapJoinResponse, [this](
+    RegisterKadProcessor(kKadBootstrapJoinResponse, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleBootstrapJoinResponse(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadFindNodesRequest, [this](
+    RegisterKadProcessor(kKadFindNodesRequest, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleFindNodesRequest(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadFindNodesResponse, [this](
+    RegisterKadProcessor(kKadFindNodesResponse, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleFindNodesResponse(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadHeartbeatRequest, [this](
+    RegisterKadProcessor(kKadHeartbeatRequest, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleHeartbeatRequest(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadHeartbeatResponse, [this](
+    RegisterKadProcessor(kKadHeartbeatResponse, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         HandleHeartbeatResponse(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadAck, [](
+    RegisterKadProcessor(kKadAck, [](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
     });
-    message_manager_->RegisterMessageProcessor(kKadNatDetectRequest, [this](
+    RegisterKadProcessor(kKadNatDetectRequest, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         nat_manager_->PushMessage(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadNatDetectResponse, [this](
+    RegisterKadProcessor(kKadNatDetectResponse, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         nat_manager_->PushMessage(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadNatDetectHandshake2Node, [this](
+    RegisterKadProcessor(kKadNatDetectHandshake2Node, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         nat_manager_->PushMessage(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadNatDetectHandshake2Boot, [this](
+    RegisterKadProcessor(kKadNatDetectHandshake2Boot, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         nat_manager_->PushMessage(message, packet);
     });
-    message_manager_->RegisterMessageProcessor(kKadNatDetectFinish, [this](
+    RegisterKadProcessor(kKadNatDetectFinish, [this](
             transport::protobuf::RoutingMessage& message,
             base::xpacket_t& packet){
         nat_manager_->PushMessage(message, packet);
     });
 }
 
+void KadMessageHandler::RegisterKadProcessor(int type, KadMessageProc proc) {
+    message_manager_->RegisterMessageProcessor(type, [this, type, proc](
+            transport::protobuf::RoutingMessage& message,
+            base::xpacket_t& packet){
+        HeartbeatState::Instance()->Recv(type, packet.get_size());
+        // kad heartbeats are off, received messages tell which members are alive
+        if (routing_ptr_ && message.has_src_node_id()) {
+            routing_ptr_->NodeSeen(message.src_node_id());
+        }
+        proc(message, packet);
+    });
+}
+
 int KadMessageHandler::HandleClientMessage(
         transport::protobuf::RoutingMessage& message,
         base::xpacket_t& packet) {
@@ -4,6 +4,8 @@
 
 #include "xkad/routing_table/local_node_info.h"
 
+#include <string.h>
+
 #include <limits>
 
 #include "xbase/xhash.h"
@@ -19,7 +21,11 @@ namespace top {
 
 namespace kadmlia {
 
-LocalNodeInfo::LocalNodeInfo() {}
+LocalNodeInfo::LocalNodeInfo()
+        : current_identity_(new LocalIdentity()),
+          identity_(current_identity_.get()),
+          retired_identities_() {}
+
 LocalNodeInfo::~LocalNodeInfo() {}
 
 bool LocalNodeInfo::Init(
@@ -31,20 +37,23 @@ bool LocalNodeInfo::Init(
         base::KadmliaKeyPtr kadmlia_key,
         uint64_t service_type,
         uint32_t role) {
-    local_ip_ = local_ip;
-    local_port_ = local_port;
     first_node_ = first_node;
     client_mode_ = client;
-    idtype_ = idtype;
-    kadmlia_key_ = kadmlia_key;
+    set_kadmlia_key(kadmlia_key);
+    UpdateIdentity([&](LocalIdentity& identity) {
+        identity.xid = global_xid->Get();
+        identity.local_ip = local_ip;
+        identity.local_port = local_port;
+        identity.idtype = idtype;
+        if (first_node) {
+            identity.public_ip = local_ip;
+            identity.public_port = local_port;
+        }
+    });
     xip_ = std::make_shared<base::XipParser>(kadmlia_key->Xip());
     TOP_INFO("local_node_start: kad_key[%s]; xip[%s]",
             HexEncode(kad_key()).c_str(),
             HexEncode(xip_->xip()).c_str());
-    if (first_node_) {
-        public_ip_ = local_ip_;
-        public_port_ = local_port_;
-    }
     if (!nat_manager_->GetLocalNatType(nat_type_)
             || nat_type_ == kNatTypeUnknown) {
         TOP_ERROR("bluenat get local nat type(%d) failed", nat_type_);
@@ -59,40 +68,100 @@ bool LocalNodeInfo::Init(
 
 void LocalNodeInfo::Reset() {
     xip_ = nullptr;
-    kadmlia_key_ = nullptr;
-    local_ip_ = "";
-    local_port_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(kadkey_mutex_);
+        kadmlia_key_ = nullptr;
+    }
     first_node_ = false;
     client_mode_ = false;
     private_key_ = "";
     public_key_ = "";
-    public_ip_ = "";
-    public_port_ = 0;
     nat_type_ = kNatTypeUnknown;
-    idtype_ = "";
     role_ = kRoleInvalid;
+    UpdateIdentity([](LocalIdentity& identity) {
+        identity = LocalIdentity();
+    });
 }
 
 bool LocalNodeInfo::IsPublicNode() const {
-    return local_ip_ == public_ip_ && local_port_ == public_port_;
+    const LocalIdentity& local = identity();
+    return local.local_ip == local.public_ip && local.local_port == local.public_port;
 }
-std::string LocalNodeInfo::kad_key() {
-    return id();
-}
-std::string LocalNodeInfo::xid() { return global_xid->Get(); }
+
 std::string LocalNodeInfo::xip() { return GetXipParser().xip(); }
 
+void LocalNodeInfo::UpdateIdentity(std::function<void(LocalIdentity&)> update) {
+    std::lock_guard<std::mutex> lock(identity_mutex_);
+    std::unique_ptr<LocalIdentity> identity(new LocalIdentity(*current_identity_));
+    update(*identity);
+    if (*identity == *current_identity_) {
+        return;
+    }
+    identity->id_bytes.fill(0);
+    if (identity->id.size() == kNodeIdSize) {
+        memcpy(identity->id_bytes.data(), identity->id.data(), kNodeIdSize);
+    }
+
+    // no reader is left on a snapshot replaced a grace period ago
+    auto now = std::chrono::steady_clock::now();
+    while (!retired_identities_.empty() &&
+            now - retired_identities_.front().retired_time >=
+            std::chrono::milliseconds(kLocalIdentityGraceMs)) {
+        retired_identities_.pop_front();
+    }
+
+    identity_.store(identity.get(), std::memory_order_release);
+    RetiredIdentity retired;
+    retired.identity = std::move(current_identity_);
+    retired.retired_time = now;
+    retired_identities_.push_back(std::move(retired));
+    current_identity_ = std::move(identity);
+}
+
+void LocalNodeInfo::set_local_port(uint16_t local_port) {
+    UpdateIdentity([local_port](LocalIdentity& identity) {
+        identity.local_port = local_port;
+    });
+}
+
+void LocalNodeInfo::set_public_ip(const std::string& ip) {
+    UpdateIdentity([&ip](LocalIdentity& identity) {
+        identity.public_ip = ip;
+    });
+}
+
+void LocalNodeInfo::set_public_port(uint16_t port) {
+    UpdateIdentity([port](LocalIdentity& identity) {
+        identity.public_port = port;
+    });
+}
+
+void LocalNodeInfo::set_public_endpoint(const std::string& ip, uint16_t port) {
+    UpdateIdentity([&ip, port](LocalIdentity& identity) {
+        identity.public_ip = ip;
+        identity.public_port = port;
+    });
+}
+
+void LocalNodeInfo::set_kadmlia_key(base::KadmliaKeyPtr kadmlia_key) {
+    std::string id;
+    if (kadmlia_key) {
+        id = kadmlia_key->Get();
+    }
+    {
+        std::lock_guard<std::mutex> lock(kadkey_mutex_);
+        kadmlia_key_ = kadmlia_key;
+    }
+    UpdateIdentity([&id](LocalIdentity& identity) {
+        identity.id = id;
+    });
+}
+
 void LocalNodeInfo::set_xip(const std::string& xip_str) {
     base::XipParser xip(xip_str);
     *xip_ = xip;
 }
 
-std::string LocalNodeInfo::id() {
-    assert(kadmlia_key_);
-    std::lock_guard<std::mutex> lock(kadkey_mutex_);
-    return kadmlia_key_->Get();
-}
-
 base::XipParser& LocalNodeInfo::GetXipParser() {
     if (client_mode_) {
         std::unique_lock<std::mutex> lock(dxip_node_map_mutex_);
@@ -0,0 +1,219 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/lock_stats.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+namespace top {
+
+namespace kadmlia {
+
+static uint64_t ElapsedNs(
+        std::chrono::steady_clock::time_point begin,
+        std::chrono::steady_clock::time_point end) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+}
+
+uint64_t LockStatsPercentileNs(const std::vector<uint64_t>& histogram, double percent) {
+    uint64_t total = 0;
+    for (auto count : histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const double rank = total * percent / 100.0;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < histogram.size(); ++i) {
+        seen += histogram[i];
+        if (seen >= rank && histogram[i] > 0) {
+            return (uint64_t)1 << (i + 1);
+        }
+    }
+    return (uint64_t)1 << histogram.size();
+}
+
+LockStatsEntry::LockStatsEntry(const std::string& name)
+        : name_(name),
+          acquisitions_(0),
+          contended_(0),
+          wait_ns_(0),
+          hold_ns_(0),
+          max_wait_ns_(0),
+          max_hold_ns_(0) {
+    for (uint32_t i = 0; i < kLockStatsBuckets; ++i) {
+        wait_histogram_[i] = 0;
+        hold_histogram_[i] = 0;
+    }
+}
+
+uint32_t LockStatsEntry::Bucket(uint64_t ns) {
+    uint32_t bucket = 0;
+    while (ns > 1 && bucket < kLockStatsBuckets - 1) {
+        ns >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void LockStatsEntry::UpdateMax(std::atomic<uint64_t>& max_ns, uint64_t ns) {
+    uint64_t old_ns = max_ns.load(std::memory_order_relaxed);
+    while (ns > old_ns && !max_ns.compare_exchange_weak(old_ns, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LockStatsEntry::RecordWait(uint64_t wait_ns, bool contended) {
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    if (contended) {
+        contended_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wait_ns_.fetch_add(wait_ns, std::memory_order_relaxed);
+    wait_histogram_[Bucket(wait_ns)].fetch_add(1, std::memory_order_relaxed);
+    UpdateMax(max_wait_ns_, wait_ns);
+}
+
+void LockStatsEntry::RecordHold(uint64_t hold_ns) {
+    hold_ns_.fetch_add(hold_ns, std::memory_order_relaxed);
+    hold_histogram_[Bucket(hold_ns)].fetch_add(1, std::memory_order_relaxed);
+    UpdateMax(max_hold_ns_, hold_ns);
+}
+
+void LockStatsEntry::Get(LockStatsInfo& info) {
+    info.name = name_;
+    info.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+    info.contended = contended_.load(std::memory_order_relaxed);
+    info.wait_ns = wait_ns_.load(std::memory_order_relaxed);
+    info.hold_ns = hold_ns_.load(std::memory_order_relaxed);
+    info.max_wait_ns = max_wait_ns_.load(std::memory_order_relaxed);
+    info.max_hold_ns = max_hold_ns_.load(std::memory_order_relaxed);
+    info.wait_histogram.resize(kLockStatsBuckets);
+    info.hold_histogram.resize(kLockStatsBuckets);
+    for (uint32_t i = 0; i < kLockStatsBuckets; ++i) {
+        info.wait_histogram[i] = wait_histogram_[i].load(std::memory_order_relaxed);
+        info.hold_histogram[i] = hold_histogram_[i].load(std::memory_order_relaxed);
+    }
+}
+
+void LockStatsEntry::Reset() {
+    acquisitions_ = 0;
+    contended_ = 0;
+    wait_ns_ = 0;
+    hold_ns_ = 0;
+    max_wait_ns_ = 0;
+    max_hold_ns_ = 0;
+    for (uint32_t i = 0; i < kLockStatsBuckets; ++i) {
+        wait_histogram_[i] = 0;
+        hold_histogram_[i] = 0;
+    }
+}
+
+LockStats::LockStats() : entries_(), entries_mutex_() {}
+
+LockStats::~LockStats() {}
+
+LockStats* LockStats::Instance() {
+    // never destroyed, locks of static objects may still be used at exit
+    static LockStats* ins = new LockStats();
+    return ins;
+}
+
+LockStatsEntry* LockStats::GetEntry(const std::string& name) {
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    auto iter = entries_.find(name);
+    if (iter != entries_.end()) {
+        return iter->second.get();
+    }
+    auto entry = new LockStatsEntry(name);
+    entries_[name].reset(entry);
+    return entry;
+}
+
+void LockStats::GetAll(std::vector<LockStatsInfo>& infos) {
+    infos.clear();
+    {
+        std::unique_lock<std::mutex> lock(entries_mutex_);
+        for (auto& item : entries_) {
+            LockStatsInfo info;
+            item.second->Get(info);
+            infos.push_back(info);
+        }
+    }
+    std::sort(infos.begin(), infos.end(), [](const LockStatsInfo& a, const LockStatsInfo& b) {
+        return a.wait_ns > b.wait_ns;
+    });
+}
+
+std::string LockStats::Dump() {
+    std::vector<LockStatsInfo> infos;
+    GetAll(infos);
+    std::string result;
+    char line[512];
+    snprintf(line, sizeof(line), "%-44s %10s %8s %12s %12s %12s %12s %12s\n",
+            "lock", "acquire", "cont%", "wait_ms", "wait_p99_ns",
+            "hold_ms", "hold_p99_ns", "hold_max_ns");
+    result += line;
+    for (auto& info : infos) {
+        if (info.acquisitions == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%-44s %10llu %8.2f %12.3f %12llu %12.3f %12llu %12llu\n",
+                info.name.c_str(),
+                (unsigned long long)info.acquisitions,
+                info.contended * 100.0 / info.acquisitions,
+                info.wait_ns / 1e6,
+                (unsigned long long)LockStatsPercentileNs(info.wait_histogram, 99),
+                info.hold_ns / 1e6,
+                (unsigned long long)LockStatsPercentileNs(info.hold_histogram, 99),
+                (unsigned long long)info.max_hold_ns);
+        result += line;
+    }
+    return result;
+}
+
+void LockStats::Reset() {
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    for (auto& item : entries_) {
+        item.second->Reset();
+    }
+}
+
+InstrumentedMutex::InstrumentedMutex(const char* name)
+        : mutex_(),
+          entry_(LockStats::Instance()->GetEntry(name)),
+          acquired_() {}
+
+void InstrumentedMutex::lock() {
+    const auto begin = std::chrono::steady_clock::now();
+    bool contended = false;
+    if (!mutex_.try_lock()) {
+        contended = true;
+        mutex_.lock();
+    }
+    acquired_ = std::chrono::steady_clock::now();
+    entry_->RecordWait(ElapsedNs(begin, acquired_), contended);
+}
+
+bool InstrumentedMutex::try_lock() {
+    if (!mutex_.try_lock()) {
+        return false;
+    }
+    acquired_ = std::chrono::steady_clock::now();
+    entry_->RecordWait(0, false);
+    return true;
+}
+
+void InstrumentedMutex::unlock() {
+    const uint64_t hold_ns = ElapsedNs(acquired_, std::chrono::steady_clock::now());
+    mutex_.unlock();
+    entry_->RecordHold(hold_ns);
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
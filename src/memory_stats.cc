@@ -0,0 +1,139 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/memory_stats.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+
+namespace top {
+
+namespace kadmlia {
+
+static const uint64_t kSmallStringCapacity = 15;  // libstdc++ sso buffer
+
+uint64_t StringHeapBytes(const std::string& str) {
+    if (str.capacity() <= kSmallStringCapacity) {
+        return 0;
+    }
+    return str.capacity() + 1;
+}
+
+uint64_t NodeInfoBytes(const NodeInfo& node) {
+    return sizeof(NodeInfo) + kSharedPtrBlockBytes
+            + StringHeapBytes(node.node_id)
+            + StringHeapBytes(node.public_ip)
+            + StringHeapBytes(node.local_ip)
+            + StringHeapBytes(node.xid)
+            + StringHeapBytes(node.xip);
+}
+
+MemoryStats* MemoryStats::Instance() {
+    // never destroyed, singletons unregister from their destructors at exit
+    static MemoryStats* ins = new MemoryStats();
+    return ins;
+}
+
+MemoryStats::MemoryStats()
+        : reporters_(),
+          peaks_(),
+          next_reporter_id_(0) {}
+
+MemoryStats::~MemoryStats() {
+    Stop();
+}
+
+uint32_t MemoryStats::Register(MemoryReporter reporter) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint32_t reporter_id = ++next_reporter_id_;
+    reporters_[reporter_id] = reporter;
+    return reporter_id;
+}
+
+void MemoryStats::Unregister(uint32_t reporter_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    reporters_.erase(reporter_id);
+}
+
+void MemoryStats::Sample(std::vector<MemoryUsage>& usages) {
+    usages.clear();
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& item : reporters_) {
+        item.second(usages);
+    }
+    for (auto& usage : usages) {
+        Peak& peak = peaks_[usage.name];
+        peak.entries = std::max(peak.entries, usage.entries);
+        peak.bytes = std::max(peak.bytes, usage.bytes);
+        usage.peak_entries = peak.entries;
+        usage.peak_bytes = peak.bytes;
+    }
+}
+
+void MemoryStats::Get(std::vector<MemoryUsage>& usages) {
+    Sample(usages);
+    std::sort(usages.begin(), usages.end(), [](const MemoryUsage& a, const MemoryUsage& b) {
+        return a.bytes > b.bytes;
+    });
+}
+
+std::string MemoryStats::Dump() {
+    std::vector<MemoryUsage> usages;
+    Get(usages);
+    std::string result;
+    char line[256];
+    snprintf(line, sizeof(line), "%-32s %10s %12s %10s %12s\n",
+            "subsystem", "entries", "bytes", "peak_ent", "peak_bytes");
+    result += line;
+    uint64_t total_bytes = 0;
+    for (auto& usage : usages) {
+        snprintf(line, sizeof(line), "%-32s %10llu %12llu %10llu %12llu\n",
+                usage.name.c_str(),
+                (unsigned long long)usage.entries,
+                (unsigned long long)usage.bytes,
+                (unsigned long long)usage.peak_entries,
+                (unsigned long long)usage.peak_bytes);
+        result += line;
+        total_bytes += usage.bytes;
+    }
+    snprintf(line, sizeof(line), "%-32s %10s %12llu\n", "total", "", (unsigned long long)total_bytes);
+    result += line;
+    return result;
+}
+
+void MemoryStats::ResetPeaks() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    peaks_.clear();
+}
+
+void MemoryStats::Start(base::TimerManager* timer_manager, uint32_t sample_period_s) {
+    std::unique_lock<std::mutex> lock(timer_mutex_);
+    if (timer_ || sample_period_s == 0) {
+        return;
+    }
+    timer_ = std::make_shared<base::TimerRepeated>(timer_manager, "MemoryStats");
+    timer_->Start(
+            sample_period_s * 1000 * 1000,
+            sample_period_s * 1000 * 1000,
+            [this]() {
+                std::vector<MemoryUsage> usages;
+                Sample(usages);
+            });
+}
+
+void MemoryStats::Stop() {
+    std::shared_ptr<base::TimerRepeated> timer;
+    {
+        std::unique_lock<std::mutex> lock(timer_mutex_);
+        timer.swap(timer_);
+    }
+    if (timer) {
+        timer->Join();
+    }
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
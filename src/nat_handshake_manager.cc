@@ -5,9 +5,11 @@
 #include "xkad/nat_detect/nat_handshake_manager.h"
 
 #include "xbase/xutl.h"
+#include "xbase/xpacket.h"
 
 #include "xpbase/base/top_utils.h"
 #include "xkad/routing_table/callback_manager.h"
+#include "xkad/routing_table/heartbeat_state.h"
 #include "xtransport/proto/transport.pb.h"
 #include "xkad/proto/kadmlia.pb.h"
 // #include "xkad/nat_detect/nat_log.h"
@@ -45,7 +47,7 @@ void NatHandshakeManager::AddDetection(
     const auto delay_count = delay_ms / kDetectionPeriod;
     TOP_INFO_NAME("add nat detection(%s:%d, detect_port=%d, message_type=%d, delay_ms=%d(%d)",
         ip.c_str(), (int)port, (int)detect_port, message_type, delay_ms, delay_count);
-    const std::string key = ip + "_" + std::to_string(port);
+    const EndpointKey key(ip, port);
     auto ptr = std::make_shared<NatDetectStruct>();
     ptr->ip = ip;
     ptr->port = port;
@@ -62,7 +64,7 @@ void NatHandshakeManager::AddDetection(
 void NatHandshakeManager::RemoveDetection(const std::string& ip, uint16_t port) {
     TOP_INFO_NAME("remove nat detection(%s:%d)",
         ip.c_str(), (int)port);
-    const std::string key = ip + "_" + std::to_string(port);
+    const EndpointKey key(ip, port);
     std::unique_lock<std::mutex> lock(mutex_);
     peers_.erase(key);
 }
@@ -127,11 +129,13 @@ int NatHandshakeManager::DoHandshake(
         return kKadFailed;
     }
     xbyte_buffer_t xdata{msg.begin(), msg.end()};
+    // SendPing adds the xip2 header
+    HeartbeatState::Instance()->Send(message.type(), xdata.size() + enum_xip2_header_len);
     return transport->SendPing(xdata, peer_ip, detect_port);
 }
 
 void NatHandshakeManager::DetectProc() {
-    std::map<std::string, std::shared_ptr<NatDetectStruct>> peers;
+    std::unordered_map<EndpointKey, std::shared_ptr<NatDetectStruct>, EndpointKeyHash> peers;
     {
         std::unique_lock<std::mutex> lock(mutex_);
         peers = peers_;  // yes, copy!
@@ -4,11 +4,13 @@
 
 #include "xkad/nat_detect/nat_manager.h"
 
+#include "xbase/xpacket.h"
 #include "xtransport/message_manager/multi_message_handler.h"
 #include "xkad/nat_detect/nat_handshake_manager.h"
 #include "xkad/nat_detect/nat_defines.h"
 // #include "xkad/nat_detect/nat_log.h"
 #include "xkad/routing_table/callback_manager.h"
+#include "xkad/routing_table/heartbeat_state.h"
 #include "xpbase/base/top_log_name.h"
 
 namespace top {
@@ -169,6 +171,7 @@ void NatManager::HandleNatDetectRequest(
     if (xdata.empty()) {
         return;
     }
+    HeartbeatState::Instance()->Send(res_message.type(), xdata.size() + enum_xip2_header_len);
     transport_->SendPing(xdata, peer_ip, peer_port);
 
     if (detect_res.nat_type() == kNatTypePublic) {
@@ -301,6 +304,7 @@ void NatManager::SendNatDetectRequest(
         return;
     }
     // TOP_FATAL("SendNatDetectRequest(size=%d)", (int)xdata.size());
+    HeartbeatState::Instance()->Send(message.type(), xdata.size() + enum_xip2_header_len);
     if (nat_transport_->SendPing(xdata, peer_ip, peer_port) != kKadSuccess) {
         TOP_INFO_NAME("send nat detect(%s:%d) failed", peer_ip.c_str(), (int)peer_port);
     }
@@ -334,6 +338,7 @@ void NatManager::SendNatDetectFinish(
     if (xdata.empty()) {
         return;
     }
+    HeartbeatState::Instance()->Send(message.type(), xdata.size() + enum_xip2_header_len);
     if (nat_transport_->SendPing(xdata, peer_ip, peer_port) != kKadSuccess) {
         TOP_INFO_NAME("send nat detect(%s:%d) failed", peer_ip.c_str(), (int)peer_port);
     }
@@ -5,11 +5,13 @@
 #include "xkad/routing_table/node_detection_manager.h"
 
 #include "xbase/xutl.h"
+#include "xbase/xpacket.h"
 
 #include "xtransport/transport.h"
 #include "xpbase/base/top_log.h"
 #include "xpbase/base/top_utils.h"
 #include "xkad/routing_table/callback_manager.h"
+#include "xkad/routing_table/heartbeat_state.h"
 #include "xkad/routing_table/node_info.h"
 #include "xtransport/proto/transport.pb.h"
 #include "xkad/proto/kadmlia.pb.h"
@@ -37,6 +39,19 @@ NodeDetectionManager::NodeDetectionManager(base::TimerManager* timer_manager, Ro
             std::bind(&NodeDetectionManager::DoTetection, this));
 }
 
+NodeDetectionManager::NodeDetectionManager(SimSchedulerIntfPtr sim_scheduler, RoutingTable& routing_table)
+        : detection_nodes_map_(),
+          detection_nodes_map_mutex_(),
+          detected_nodes_map_(),
+          detected_nodes_map_mutex_(),
+          routing_table_(routing_table),
+          sim_scheduler_(sim_scheduler) {
+    sim_task_id_ = sim_scheduler_->SchedulePeriodic(
+            kDoDetectionPeriod / 1000,
+            kDoDetectionPeriod / 1000,
+            std::bind(&NodeDetectionManager::DoTetection, this));
+}
+
 NodeDetectionManager::~NodeDetectionManager() {
     Join();
     TOP_INFO("NodeDetectionManager thread joined!");
@@ -45,6 +60,10 @@ NodeDetectionManager::~NodeDetectionManager() {
 void NodeDetectionManager::Join() {
     destroy_ = true;
     timer_ = nullptr;
+    if (sim_scheduler_ && sim_task_id_ != 0) {
+        sim_scheduler_->Cancel(sim_task_id_);
+        sim_task_id_ = 0;
+    }
     {
         std::unique_lock<std::mutex> lock(detection_nodes_map_mutex_);
         detection_nodes_map_.clear();
@@ -78,9 +97,8 @@ int NodeDetectionManager::AddDetectionNode(std::shared_ptr<NodeInfo> node_ptr) {
         node_ptr->detection_delay_count = 0;
     }
 
+    EndpointKey key(node_ptr->public_ip, node_ptr->public_port);
     std::unique_lock<std::mutex> lock(detection_nodes_map_mutex_);
-    std::string key = (node_ptr->public_ip + "_" +
-            base::xstring_utl::tostring(node_ptr->public_port));
     auto ins_iter = detection_nodes_map_.insert(std::make_pair(key, node_ptr));
     if (ins_iter.second) {
         return kKadSuccess;
@@ -90,8 +108,8 @@ int NodeDetectionManager::AddDetectionNode(std::shared_ptr<NodeInfo> node_ptr) {
 }
 
 void NodeDetectionManager::RemoveDetection(const std::string& ip, uint16_t port) {
+    EndpointKey key(ip, port);
     std::unique_lock<std::mutex> lock(detection_nodes_map_mutex_);
-    std::string key = ip + "_" + base::xstring_utl::tostring(port);
     auto iter = detection_nodes_map_.find(key);
     if (iter != detection_nodes_map_.end()) {
         detection_nodes_map_.erase(iter);
@@ -147,6 +165,9 @@ int NodeDetectionManager::Handshake(std::shared_ptr<NodeInfo> node_ptr) {
     // try vlan connect 
     //transport_ptr->SendPing(xdata, node_ptr->local_ip, node_ptr->local_port);
     // try public connect 
+    routing_table_.AddRttRequest(message.id(), message.type());
+    // SendPing adds the xip2 header
+    HeartbeatState::Instance()->Send(message.type(), xdata.size() + enum_xip2_header_len);
     transport_ptr->SendPing(xdata, node_ptr->public_ip, node_ptr->public_port);
     TOP_DEBUG("sendping sendhandshake from:%s:%d to %s:%d size:%d",
             local_node->public_ip().c_str(),
@@ -176,7 +197,7 @@ void NodeDetectionManager::DoTetection() {
             }
 
             if (iter->second->detection_count >= kDetectionTimes) {
-                detection_nodes_map_.erase(iter++);
+                iter = detection_nodes_map_.erase(iter);
                 continue;
             }
 
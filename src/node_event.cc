@@ -0,0 +1,92 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/node_event.h"
+
+#include <vector>
+
+#include "xpbase/base/top_log.h"
+
+namespace top {
+
+namespace kadmlia {
+
+NodeEventDispatcher::NodeEventDispatcher() : NodeEventDispatcher(kNodeEventQueueSize) {}
+
+NodeEventDispatcher::NodeEventDispatcher(uint32_t queue_size)
+        : queue_(queue_size),
+          overflow_(false),
+          last_generation_(0),
+          has_subscriber_(false),
+          subscribers_(),
+          subscribers_mutex_(),
+          next_subscription_id_(0),
+          dispatch_mutex_() {}
+
+NodeEventDispatcher::~NodeEventDispatcher() {}
+
+uint32_t NodeEventDispatcher::Subscribe(NodeEventCallback callback) {
+    std::unique_lock<std::mutex> lock(subscribers_mutex_);
+    uint32_t subscription_id = ++next_subscription_id_;
+    subscribers_[subscription_id] = callback;
+    has_subscriber_ = true;
+    return subscription_id;
+}
+
+void NodeEventDispatcher::Unsubscribe(uint32_t subscription_id) {
+    std::unique_lock<std::mutex> lock(subscribers_mutex_);
+    subscribers_.erase(subscription_id);
+    has_subscriber_ = !subscribers_.empty();
+}
+
+void NodeEventDispatcher::Publish(int type, NodeInfoPtr node, uint64_t generation) {
+    last_generation_ = generation;
+    if (!has_subscriber_) {
+        return;
+    }
+
+    NodeEvent event;
+    event.type = type;
+    event.node = node;
+    event.generation = generation;
+    if (!queue_.Push(std::move(event))) {
+        overflow_ = true;
+    }
+}
+
+uint32_t NodeEventDispatcher::Dispatch() {
+    std::unique_lock<std::mutex> dispatch_lock(dispatch_mutex_);
+    std::vector<NodeEventCallback> callbacks;
+    {
+        std::unique_lock<std::mutex> lock(subscribers_mutex_);
+        for (auto& kv : subscribers_) {
+            callbacks.push_back(kv.second);
+        }
+    }
+
+    uint32_t count = 0;
+    NodeEvent event;
+    while (queue_.Pop(event)) {
+        for (auto& callback : callbacks) {
+            callback(event);
+        }
+        ++count;
+    }
+
+    if (overflow_.exchange(false)) {
+        TOP_WARN("node event queue overflow, subscribers resync");
+        NodeEvent resync;
+        resync.type = kNodeEventResync;
+        resync.generation = last_generation_;
+        for (auto& callback : callbacks) {
+            callback(resync);
+        }
+        ++count;
+    }
+    return count;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -4,6 +4,7 @@
 
 #include "xkad/routing_table/node_info.h"
 #include "xtransport/udp_transport/xudp_socket.h"
+#include "xkad/routing_table/object_pool.h"
 
 namespace top {
 namespace kadmlia {
@@ -19,21 +20,23 @@ NodeInfo::NodeInfo() {
 NodeInfo::NodeInfo(const NodeInfo& other)
         : node_id(other.node_id),
             bucket_index(other.bucket_index),
-            public_ip(other.public_ip),
+            heartbeat_count(other.heartbeat_count),
+            rtt_ms(other.rtt_ms.load(std::memory_order_relaxed)),
             public_port(other.public_port),
-            local_ip(other.local_ip),
             local_port(other.local_port),
+            public_ip(other.public_ip),
+            local_ip(other.local_ip),
+            xid(other.xid),
+            xip(other.xip),
+            service_type(other.service_type),
             connection_id(other.connection_id),
             detection_count(other.detection_count),
             nat_type(other.nat_type),
             detection_delay_count(other.detection_delay_count),
-            heartbeat_count(other.heartbeat_count),
-            service_type(other.service_type),
+            score(other.score),
+            last_seen_ms(other.last_seen_ms.load(std::memory_order_relaxed)),
             is_client(other.is_client),
-            same_vlan(other.same_vlan),
-            xid(other.xid),
-            xip(other.xip),
-            score(other.score) {
+            same_vlan(other.same_vlan) {
     hash64 = base::xhash64_t::digest(xid);
     ResetHeartbeat();
 	udp_property.reset(new top::transport::UdpProperty());	
@@ -44,6 +47,12 @@ NodeInfo::NodeInfo(const std::string& id) : node_id(id) {
 	udp_property.reset(new top::transport::UdpProperty());	
 }
 
+NodeInfo::NodeInfo(const std::string& id, transport::UdpPropertyPtr property)
+        : node_id(id),
+          udp_property(property) {
+    ResetHeartbeat();
+}
+
 NodeInfo::~NodeInfo() {
 	udp_property = nullptr;
 }
@@ -70,10 +79,17 @@ NodeInfo& NodeInfo::operator=(const NodeInfo& other) {
     xid = other.xid;
     xip = other.xip;
     score = other.score;
+    rtt_ms.store(other.rtt_ms.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    last_seen_ms.store(other.last_seen_ms.load(std::memory_order_relaxed), std::memory_order_relaxed);
     hash64 = base::xhash64_t::digest(xid);
     return *this;
 }
 
+NodeInfoPtr NewNodeInfo(const std::string& id) {
+    return std::allocate_shared<NodeInfo>(
+            PoolAllocator<NodeInfo>(), id, transport::UdpPropertyPtr());
+}
+
 bool NodeInfo::operator < (const NodeInfo& other) const {
     return node_id < other.node_id;
 }
@@ -95,15 +111,39 @@ bool NodeInfo::IsTimeToHeartbeat(std::chrono::steady_clock::time_point tp_now) {
 }
 
 void NodeInfo::Heartbeat() {
+    Heartbeat(std::chrono::steady_clock::now());
+}
+
+void NodeInfo::Heartbeat(std::chrono::steady_clock::time_point tp_now) {
     ++heartbeat_count;
-    tp_next_time_to_heartbeat = std::chrono::steady_clock::now() +
-        std::chrono::seconds(kHeartbeatSecondTimeout);
+    tp_next_time_to_heartbeat = tp_now + std::chrono::seconds(kHeartbeatSecondTimeout);
 }
 
 void NodeInfo::ResetHeartbeat() {
+    ResetHeartbeat(std::chrono::steady_clock::now());
+}
+
+void NodeInfo::ResetHeartbeat(std::chrono::steady_clock::time_point tp_now) {
     heartbeat_count = 0;
-    tp_next_time_to_heartbeat = std::chrono::steady_clock::now() +
-        std::chrono::seconds(kHeartbeatFirstTimeout);
+    tp_next_time_to_heartbeat = tp_now + std::chrono::seconds(kHeartbeatFirstTimeout);
+}
+
+void NodeInfo::UpdateRtt(uint32_t sample_ms) {
+    if (sample_ms == 0) {
+        sample_ms = 1;  // 0 means no sample
+    }
+    // read by the forwarding paths without a lock, a racing sample may be lost
+    const uint32_t srtt = rtt_ms.load(std::memory_order_relaxed);
+    if (srtt == 0) {
+        rtt_ms.store(sample_ms, std::memory_order_relaxed);
+        return;
+    }
+    // srtt = 7/8 srtt + 1/8 sample
+    uint32_t new_srtt = static_cast<uint32_t>(((uint64_t)srtt * 7 + sample_ms) / 8);
+    if (new_srtt == 0) {
+        new_srtt = 1;
+    }
+    rtt_ms.store(new_srtt, std::memory_order_relaxed);
 }
 
 }  // namespace kadmlia
@@ -0,0 +1,144 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/peer_rtt.h"
+
+#include "xpbase/base/top_log.h"
+
+namespace top {
+
+namespace kadmlia {
+
+RttSampler::RttSampler(RpcStats* rpc_stats)
+        : pending_(),
+          last_expire_time_(),
+          rpc_stats_(rpc_stats),
+          mutex_() {}
+
+RttSampler::~RttSampler() {}
+
+void RttSampler::Sent(uint32_t message_id, int message_type, TimePoint now) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // timeouts are counted by the sweep, at least once per timeout period
+    if (pending_.size() >= kRttPendingMaxSize ||
+            now - last_expire_time_ > std::chrono::milliseconds(kRttPendingTimeoutMs)) {
+        EraseExpired(now);
+        if (pending_.size() >= kRttPendingMaxSize) {
+            TOP_DEBUG("rtt sampler pending full(%d), skip", (int)pending_.size());
+            return;
+        }
+    }
+    Pending& pending = pending_[message_id];
+    pending.sent_time = now;
+    pending.message_type = message_type;
+    if (rpc_stats_) {
+        rpc_stats_->OnRequest(message_type);
+    }
+}
+
+bool RttSampler::Received(uint32_t message_id, TimePoint now, uint32_t& rtt_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = pending_.find(message_id);
+    if (iter == pending_.end()) {
+        return false;
+    }
+
+    const int message_type = iter->second.message_type;
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            now - iter->second.sent_time).count();
+    pending_.erase(iter);
+    if (elapsed_us < 0) {
+        return false;
+    }
+    if (elapsed_us > static_cast<int64_t>(kRttPendingTimeoutMs) * 1000) {
+        if (rpc_stats_) {
+            rpc_stats_->OnLateResponse(message_type);
+        }
+        return false;
+    }
+    if (rpc_stats_) {
+        rpc_stats_->OnResponse(message_type, static_cast<uint64_t>(elapsed_us));
+    }
+    rtt_ms = static_cast<uint32_t>(elapsed_us / 1000);
+    return true;
+}
+
+uint32_t RttSampler::size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+void RttSampler::EraseExpired(TimePoint now) {
+    last_expire_time_ = now;
+    const auto timeout = std::chrono::milliseconds(kRttPendingTimeoutMs);
+    for (auto iter = pending_.begin(); iter != pending_.end();) {
+        if (now - iter->second.sent_time > timeout) {
+            if (rpc_stats_) {
+                rpc_stats_->OnTimeout(iter->second.message_type);
+            }
+            iter = pending_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+// number of leading bits id shares with target_id
+static int CommonPrefixBits(const std::string& id, const std::string& target_id) {
+    int bits = 0;
+    for (int i = 0; i < kNodeIdSize; ++i) {
+        unsigned char diff = id[i] ^ target_id[i];
+        if (diff == 0) {
+            bits += 8;
+            continue;
+        }
+        while (!(diff & 0x80)) {
+            diff <<= 1;
+            ++bits;
+        }
+        break;
+    }
+    return bits;
+}
+
+NodeInfoPtr SelectLowLatencyNode(
+        const std::string& target_id,
+        const std::vector<NodeInfoPtr>& nodes) {
+    if (nodes.empty()) {
+        return nullptr;
+    }
+    return nodes[SelectLowLatencyIndex(target_id, nodes, 0)];
+}
+
+size_t SelectLowLatencyIndex(
+        const std::string& target_id,
+        const std::vector<NodeInfoPtr>& nodes,
+        size_t start) {
+    if (start >= nodes.size()) {
+        return start;
+    }
+
+    size_t best = start;
+    const int prefix_bits = CommonPrefixBits(nodes[start]->node_id, target_id);
+    const size_t end = std::min(nodes.size(), start + kRttNextHopCandidates);
+    for (size_t i = start + 1; i < end; ++i) {
+        // sorted by distance, the bucket ends at the first shorter prefix
+        if (CommonPrefixBits(nodes[i]->node_id, target_id) != prefix_bits) {
+            break;
+        }
+        const uint32_t rtt_ms = nodes[i]->rtt_ms.load(std::memory_order_relaxed);
+        if (rtt_ms == 0) {
+            continue;
+        }
+        const uint32_t best_rtt_ms = nodes[best]->rtt_ms.load(std::memory_order_relaxed);
+        if (best_rtt_ms == 0 || rtt_ms < best_rtt_ms) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,55 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/peer_store.h"
+
+#include "xtransport/udp_transport/xudp_socket.h"
+
+namespace top {
+namespace kadmlia {
+
+PeerStore* PeerStore::Instance() {
+    static PeerStore ins;
+    return &ins;
+}
+
+PeerStore::PeerStore() : peers_(), gets_since_prune_(0), mutex_() {}
+
+PeerStore::~PeerStore() {}
+
+transport::UdpPropertyPtr PeerStore::GetUdpProperty(const std::string& ip, uint16_t port) {
+    EndpointKey key(ip, port);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (++gets_since_prune_ >= kPeerStorePruneInterval) {
+        Prune();
+    }
+
+    auto& weak_property = peers_[key];
+    auto property = weak_property.lock();
+    if (!property) {
+        property = std::make_shared<transport::UdpProperty>();
+        weak_property = property;
+    }
+    return property;
+}
+
+uint32_t PeerStore::size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Prune();
+    return peers_.size();
+}
+
+void PeerStore::Prune() {
+    gets_since_prune_ = 0;
+    for (auto iter = peers_.begin(); iter != peers_.end();) {
+        if (iter->second.expired()) {
+            iter = peers_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+}  // namespace kadmlia
+}  // namespace top
@@ -0,0 +1,132 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/replacement_cache.h"
+
+#include "xkad/routing_table/memory_stats.h"
+
+#include "xpbase/base/top_log.h"
+
+namespace top {
+
+namespace kadmlia {
+
+ReplacementCache::ReplacementCache()
+        : ReplacementCache(kReplacementCacheSize, kReplacementCacheTimeoutMs) {}
+
+ReplacementCache::ReplacementCache(uint32_t bucket_capacity, uint32_t timeout_ms)
+        : bucket_capacity_(bucket_capacity > 0 ? bucket_capacity : 1),
+          timeout_(timeout_ms),
+          buckets_(),
+          size_(0),
+          mutex_() {}
+
+ReplacementCache::~ReplacementCache() {}
+
+void ReplacementCache::Add(NodeInfoPtr node, TimePoint now) {
+    if (!node || node->bucket_index == kInvalidBucketIndex) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    CandidateList& candidates = buckets_[node->bucket_index];
+    for (auto iter = candidates.begin(); iter != candidates.end(); ++iter) {
+        if (iter->node->node_id == node->node_id) {
+            candidates.erase(iter);
+            --size_;
+            break;
+        }
+    }
+
+    candidates.push_front({ node, now });
+    ++size_;
+    if (candidates.size() > bucket_capacity_) {
+        candidates.pop_back();
+        --size_;
+    }
+}
+
+void ReplacementCache::Remove(const std::string& node_id, int bucket_index) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto bucket_iter = buckets_.find(bucket_index);
+    if (bucket_iter == buckets_.end()) {
+        return;
+    }
+
+    CandidateList& candidates = bucket_iter->second;
+    for (auto iter = candidates.begin(); iter != candidates.end(); ++iter) {
+        if (iter->node->node_id == node_id) {
+            candidates.erase(iter);
+            --size_;
+            break;
+        }
+    }
+    if (candidates.empty()) {
+        buckets_.erase(bucket_iter);
+    }
+}
+
+NodeInfoPtr ReplacementCache::Pop(int bucket_index, TimePoint now) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto bucket_iter = buckets_.find(bucket_index);
+    if (bucket_iter == buckets_.end()) {
+        return nullptr;
+    }
+
+    NodeInfoPtr node;
+    CandidateList& candidates = bucket_iter->second;
+    while (!candidates.empty()) {
+        Candidate candidate = candidates.front();
+        candidates.pop_front();
+        --size_;
+        if (now - candidate.seen <= timeout_) {
+            node = candidate.node;
+            break;
+        }
+        // the rest is older
+        TOP_DEBUG("replacement cache bucket(%d) drop %d stale candidates",
+                bucket_index, (int)candidates.size() + 1);
+        size_ -= candidates.size();
+        candidates.clear();
+    }
+
+    if (candidates.empty()) {
+        buckets_.erase(bucket_iter);
+    }
+    return node;
+}
+
+uint32_t ReplacementCache::size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return size_;
+}
+
+uint32_t ReplacementCache::bucket_size(int bucket_index) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = buckets_.find(bucket_index);
+    if (iter == buckets_.end()) {
+        return 0;
+    }
+    return iter->second.size();
+}
+
+uint64_t ReplacementCache::bytes() {
+    static const uint64_t kListNodeBytes = 16;  // prev and next links
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t bytes = sizeof(ReplacementCache);
+    for (auto& item : buckets_) {
+        bytes += kMapNodeBytes + sizeof(item);
+        for (auto& candidate : item.second) {
+            bytes += kListNodeBytes + sizeof(candidate);
+            if (candidate.node) {
+                bytes += NodeInfoBytes(*candidate.node);
+            }
+        }
+    }
+    return bytes;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
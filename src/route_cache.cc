@@ -0,0 +1,77 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/route_cache.h"
+
+namespace top {
+
+namespace kadmlia {
+
+RouteCache::RouteCache() : RouteCache(kRouteCacheMaxSize) {}
+
+RouteCache::RouteCache(uint32_t max_size)
+        : max_size_(max_size > 0 ? max_size : 1),
+          entries_(),
+          lru_(),
+          mutex_() {}
+
+RouteCache::~RouteCache() {}
+
+void RouteCache::Put(
+        const std::string& des_node_id,
+        uint64_t generation,
+        const std::vector<NodeInfoPtr>& nodes) {
+    const size_t count = std::min(nodes.size(), static_cast<size_t>(kRouteCacheCandidates));
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = entries_.find(des_node_id);
+    if (iter != entries_.end()) {
+        lru_.erase(iter->second.lru_iter);
+        entries_.erase(iter);
+    } else if (entries_.size() >= max_size_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+
+    lru_.push_front(des_node_id);
+    Entry& entry = entries_[des_node_id];
+    entry.generation = generation;
+    entry.nodes.assign(nodes.begin(), nodes.begin() + count);
+    entry.lru_iter = lru_.begin();
+}
+
+bool RouteCache::Get(
+        const std::string& des_node_id,
+        uint64_t generation,
+        std::vector<NodeInfoPtr>& nodes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = entries_.find(des_node_id);
+    if (iter == entries_.end()) {
+        return false;
+    }
+
+    if (iter->second.generation != generation) {
+        lru_.erase(iter->second.lru_iter);
+        entries_.erase(iter);
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, iter->second.lru_iter);
+    nodes = iter->second.nodes;
+    return true;
+}
+
+void RouteCache::Clear() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+uint32_t RouteCache::size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
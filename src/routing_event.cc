@@ -0,0 +1,130 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/routing_event.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <algorithm>
+
+namespace top {
+
+namespace kadmlia {
+
+static uint64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char* RoutingEventTypeName(int type) {
+    switch (type) {
+    case kRoutingEventAdded:
+        return "add";
+    case kRoutingEventRejected:
+        return "reject";
+    case kRoutingEventDropped:
+        return "drop";
+    case kRoutingEventUnjoined:
+        return "unjoin";
+    default:
+        return "unknown";
+    }
+}
+
+const char* RoutingEventReasonName(int reason) {
+    switch (reason) {
+    case kRoutingReasonNone:
+        return "-";
+    case kRoutingReasonApi:
+        return "api";
+    case kRoutingReasonBucketFull:
+        return "bucket_full";
+    case kRoutingReasonHeartbeat:
+        return "heartbeat";
+    case kRoutingReasonEvicted:
+        return "evicted";
+    case kRoutingReasonQuit:
+        return "quit";
+    case kRoutingReasonEmpty:
+        return "empty";
+    case kRoutingReasonOffline:
+        return "offline";
+    default:
+        return "unknown";
+    }
+}
+
+RoutingEventRecorder::RoutingEventRecorder(uint32_t capacity)
+        : ring_(std::max(capacity, 1u)),
+          last_anomaly_us_(0) {}
+
+RoutingEventRecorder::~RoutingEventRecorder() {}
+
+void RoutingEventRecorder::Record(const RoutingEvent& event) {
+    ring_.Push(event);
+}
+
+void RoutingEventRecorder::Record(
+        int type,
+        int reason,
+        uint64_t peer_hash,
+        uint16_t peer_port,
+        int bucket,
+        uint32_t table_size,
+        uint64_t generation) {
+    RoutingEvent event;
+    event.time_us = NowUs();
+    event.peer_hash = peer_hash;
+    event.generation = static_cast<uint32_t>(generation);
+    event.table_size = static_cast<uint16_t>(std::min(table_size, 0xffffu));
+    event.bucket = static_cast<int16_t>(bucket);
+    event.peer_port = peer_port;
+    event.type = static_cast<uint8_t>(type);
+    event.reason = static_cast<uint8_t>(reason);
+    ring_.Push(event);
+}
+
+void RoutingEventRecorder::Get(std::vector<RoutingEvent>& events) {
+    ring_.Get(events);
+}
+
+std::string RoutingEventRecorder::Dump() {
+    std::vector<RoutingEvent> events;
+    Get(events);
+    char line[160];
+    snprintf(line, sizeof(line), "routing events: %u of %llu recorded\n",
+            (uint32_t)events.size(), (unsigned long long)recorded());
+    std::string result = line;
+    for (auto& event : events) {
+        snprintf(line, sizeof(line), "%llu %-6s %-11s peer(%016llx:%u) bucket(%d) size(%u) gen(%u)\n",
+                (unsigned long long)event.time_us,
+                RoutingEventTypeName(event.type),
+                RoutingEventReasonName(event.reason),
+                (unsigned long long)event.peer_hash,
+                (uint32_t)event.peer_port,
+                (int)event.bucket,
+                (uint32_t)event.table_size,
+                event.generation);
+        result += line;
+    }
+    return result;
+}
+
+bool RoutingEventRecorder::DumpAnomaly(std::string& dump) {
+    const uint64_t now_us = NowUs();
+    uint64_t last_us = last_anomaly_us_.load(std::memory_order_relaxed);
+    if (last_us != 0 && now_us < last_us + kRoutingEventDumpInterval * 1000000ull) {
+        return false;
+    }
+    if (!last_anomaly_us_.compare_exchange_strong(last_us, now_us)) {
+        return false;  // another thread dumps this one
+    }
+    dump = Dump();
+    return true;
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -21,6 +21,7 @@
 
 #include "xbase/xpacket.h"
 #include "xbase/xutl.h"
+#include "xbase/xhash.h"
 
 #include "xpbase/base/top_log.h"
 #include "xpbase/base/multirelay_log.h"
@@ -37,6 +38,11 @@
 #include "xkad/routing_table/callback_manager.h"
 #include "xkad/routing_table/nodeid_utils.h"
 #include "xkad/routing_table/local_node_info.h"
+#include "xkad/routing_table/peer_store.h"
+#include "xkad/routing_table/heartbeat_state.h"
+#include "xkad/routing_table/hop_trace.h"
+#include "xkad/routing_table/routing_event.h"
+#include "xkad/routing_table/memory_stats.h"
 #include "xpbase/base/top_string_util.h"
 //#include "xkad/top_main/top_commands.h"
 #include "xpbase/base/kad_key/chain_kadmlia_key.h"
@@ -50,7 +56,9 @@ static const int32_t kHeartbeatPeriod = 1 * 1000 * 1000;  // 2s
 static const int32_t kHeartbeatCheckProcPeriod = 1 * 1000 * 1000;  // 2s
 static const int32_t kRejoinPeriod = 3 * 1000 * 1000;  // 3s
 static const int32_t kFindNeighboursPeriod = 3 * 1000 * 1000;  // 3s
+static const int32_t kNodeEventPeriod = 100 * 1000;  // 100ms
 static const int32_t kDumpRoutingTablePeriod = 1 * 60 * 1000 * 1000; // 5min
+static const int32_t kJoinTemplateRefreshMs = 1000;  // 1s
 
 RoutingTable::RoutingTable(
         std::shared_ptr<transport::Transport> transport_ptr,
@@ -60,37 +68,66 @@ RoutingTable::RoutingTable(
           transport_ptr_(transport_ptr),
           local_node_ptr_(local_node_ptr),
           nodes_(),
-          nodes_mutex_(),
+          nodes_mutex_(XKAD_LOCK_NAME("RoutingTable::nodes_mutex_")),
           node_id_map_(),
-          node_id_map_mutex_(),
+          endpoint_nodes_map_(),
+          node_id_map_mutex_(XKAD_LOCK_NAME("RoutingTable::node_id_map_mutex_")),
           node_hash_map_(std::make_shared<std::map<uint64_t, NodeInfoPtr>>()),
-          node_hash_map_mutex_(),
-          bootstrap_mutex_(),
+          node_hash_map_mutex_(XKAD_LOCK_NAME("RoutingTable::node_hash_map_mutex_")),
+          bootstrap_mutex_(XKAD_LOCK_NAME("RoutingTable::bootstrap_mutex_")),
           bootstrap_cond_(),
+          joined_mutex_(XKAD_LOCK_NAME("RoutingTable::joined_mutex_")),
           joined_(false),
           bootstrap_id_(),
           bootstrap_ip_(),
           bootstrap_port_(0),
-          bootstrap_nodes_mutex_(),
+          bootstrap_nodes_mutex_(XKAD_LOCK_NAME("RoutingTable::bootstrap_nodes_mutex_")),
           find_neighbour_num_(1),
           node_detection_ptr_(nullptr),
           destroy_(false),
           find_nodes_period_(0),
-          set_endpoints_mutex_(),
+          set_endpoints_mutex_(XKAD_LOCK_NAME("RoutingTable::set_endpoints_mutex_")),
           after_join_(false),
           kadmlia_key_len_(kadmlia_key_len),
         //   support_rumor_(false),
         //   rumor_handler_(nullptr),
           dy_manager_(nullptr),
           heart_beat_info_map_(),
-          heart_beat_info_map_mutex_(),
+          heart_beat_info_map_mutex_(XKAD_LOCK_NAME("RoutingTable::heart_beat_info_map_mutex_")),
           heart_beat_callback_(nullptr),
-          heart_beat_callback_mutex_(),
-          security_join_ptr_() {
+          heart_beat_callback_mutex_(XKAD_LOCK_NAME("RoutingTable::heart_beat_callback_mutex_")),
+          security_join_ptr_(),
+          join_limiter_(nullptr),
+          join_msg_template_(),
+          join_res_template_(),
+          join_template_time_(),
+          join_template_mutex_(XKAD_LOCK_NAME("RoutingTable::join_template_mutex_")),
+          join_retry_after_ms_(0),
+          replacement_cache_(std::make_shared<ReplacementCache>()),
+          probe_full_bucket_(false),
+          rtt_sampler_(std::make_shared<RttSampler>(&CallbackManager::Instance()->rpc_stats())),
+          rtt_aware_next_hop_(true),
+          bucket_capacity_policy_(),
+          route_cache_(std::make_shared<RouteCache>()),
+          generation_(0),
+          pending_promotions_(),
+          promoting_(false),
+          promotion_mutex_(XKAD_LOCK_NAME("RoutingTable::promotion_mutex_")),
+          parallel_forward_map_(),
+          parallel_forward_mutex_(XKAD_LOCK_NAME("RoutingTable::parallel_forward_mutex_")),
+          node_event_dispatcher_(std::make_shared<NodeEventDispatcher>()),
+          routing_events_(std::make_shared<RoutingEventRecorder>(kRoutingEventRingSize)),
+          public_nodes_(),
+          public_nodes_mutex_(XKAD_LOCK_NAME("RoutingTable::public_nodes_mutex_")),
+          public_nodes_subscription_(0),
+          memory_reporter_id_(0),
+          sim_scheduler_(),
+          sim_task_ids_() {
     // TOP_FATAL_NAME("new RoutingTable(%p)", this);
 }
 
 RoutingTable::~RoutingTable() {
+    MemoryStats::Instance()->Unregister(memory_reporter_id_);
     // TOP_FATAL_NAME("delete RoutingTable(%p)", this);
     // TOP_FATAL_NAME("~~~~~~~~~~~~~~~~~RoutingTable()");
 }
@@ -114,14 +151,12 @@ bool RoutingTable::Init() {
     local_node_ptr_->set_local_port(local_port);
 
     if (local_node_ptr_->first_node()) {
-        local_node_ptr_->set_public_ip(local_node_ptr_->local_ip());
-        local_node_ptr_->set_public_port(local_node_ptr_->local_port());
+        local_node_ptr_->set_public_endpoint(local_node_ptr_->local_ip(), local_node_ptr_->local_port());
     }
 
     {
-        std::unique_lock<std::mutex> lock_hash(node_hash_map_mutex_);
-        NodeInfoPtr node_ptr;
-        node_ptr.reset(new NodeInfo(local_node_ptr_->id()));
+        std::unique_lock<KadMutex> lock_hash(node_hash_map_mutex_);
+        NodeInfoPtr node_ptr = NewNodeInfo(local_node_ptr_->id());
         node_ptr->local_ip = local_node_ptr_->local_ip();
         node_ptr->local_port = local_node_ptr_->local_port();
         node_ptr->public_ip = local_node_ptr_->public_ip();
@@ -131,14 +166,33 @@ bool RoutingTable::Init() {
         node_hash_map_->insert(std::make_pair(node_ptr->hash64, node_ptr));
     }
 
-    node_detection_ptr_.reset(new NodeDetectionManager(timer_manager_, *this));
+    if (sim_scheduler_) {
+        node_detection_ptr_.reset(new NodeDetectionManager(sim_scheduler_, *this));
+    } else {
+        node_detection_ptr_.reset(new NodeDetectionManager(timer_manager_, *this));
+    }
     dy_manager_.reset(new DynamicXipManager);
+    join_limiter_ = std::make_shared<BootstrapJoinLimiter>();
+    {
+        BucketCapacityPolicy policy;
+        if (GetServiceBucketCapacityPolicy(local_node_ptr_->service_type(), policy)) {
+            set_bucket_capacity_policy(policy);
+        }
+    }
+    public_nodes_subscription_ = node_event_dispatcher_->Subscribe(
+            std::bind(&RoutingTable::OnPublicNodeEvent, this, std::placeholders::_1));
+    if (!sim_scheduler_) {
+        HeartbeatState::Instance()->Start(timer_manager_, kTrafficStatsSummaryPeriod);
+        MemoryStats::Instance()->Start(timer_manager_, kMemoryStatsSamplePeriod);
+    }
+    memory_reporter_id_ = MemoryStats::Instance()->Register(
+            std::bind(&RoutingTable::GetMemoryUsage, this, std::placeholders::_1));
 //     SupportSecurityJoin();
 
     // attention: hearbeat timer does not do hearbeating really(using xudp do)
-    timer_heartbeat_ = std::make_shared<base::TimerRepeated>(timer_manager_, "RoutingTable::HeartbeatProc");
-    timer_heartbeat_->Start(
-            kHeartbeatPeriod,
+    StartTimer(
+            timer_heartbeat_,
+            "RoutingTable::HeartbeatProc",
             kHeartbeatPeriod,
             std::bind(&RoutingTable::HeartbeatProc, shared_from_this()));
 
@@ -148,20 +202,26 @@ bool RoutingTable::Init() {
     //         kHeartbeatCheckProcPeriod,
     //         std::bind(&RoutingTable::HeartbeatCheckProc, shared_from_this()));
     using namespace std::placeholders;
-    HeartbeatManagerIntf::Instance()->Register(std::to_string((long)this), std::bind(&RoutingTable::OnHeartbeatFailed, shared_from_this(), _1, _2));
+    // only called for the endpoints of the nodes in this table
+    HeartbeatManagerIntf::Instance()->RegisterSubscriber(std::to_string((long)this), std::bind(&RoutingTable::OnHeartbeatFailed, shared_from_this(), _1, _2));
     if (!local_node_ptr_->first_node()) {
         TOP_INFO_NAME("RoutingTable Init start Rejoin Timer");
-        timer_rejoin_ = std::make_shared<base::TimerRepeated>(timer_manager_, "RoutingTable::Rejoin");
-        timer_rejoin_->Start(
-                kRejoinPeriod,
+        StartTimer(
+                timer_rejoin_,
+                "RoutingTable::Rejoin",
                 kRejoinPeriod,
                 std::bind(&RoutingTable::Rejoin, shared_from_this()));
     }
-    timer_find_neighbours_ = std::make_shared<base::TimerRepeated>(timer_manager_, "RoutingTable::FindNeighbours");
-    timer_find_neighbours_->Start(
-            kFindNeighboursPeriod,
+    StartTimer(
+            timer_find_neighbours_,
+            "RoutingTable::FindNeighbours",
             kFindNeighboursPeriod,
             std::bind(&RoutingTable::FindNeighbours, shared_from_this()));
+    StartTimer(
+            timer_node_event_,
+            "RoutingTable::DispatchNodeEvents",
+            kNodeEventPeriod,
+            std::bind(&RoutingTable::DispatchNodeEvents, shared_from_this()));
 
     /*
     timer_prt_ = std::make_shared<base::TimerRepeated>(timer_manager_, "RoutingTable::PrintRoutingTable");
@@ -173,6 +233,29 @@ bool RoutingTable::Init() {
     return true;
 }
 
+void RoutingTable::StartTimer(
+        std::shared_ptr<base::TimerRepeated>& timer,
+        const std::string& name,
+        int32_t period_us,
+        std::function<void()> proc) {
+    if (sim_scheduler_) {
+        uint64_t period_ms = period_us / 1000;
+        sim_task_ids_.push_back(sim_scheduler_->SchedulePeriodic(period_ms, period_ms, proc));
+        return;
+    }
+
+    timer = std::make_shared<base::TimerRepeated>(timer_manager_, name);
+    timer->Start(period_us, period_us, proc);
+}
+
+std::chrono::steady_clock::time_point RoutingTable::Now() {
+    if (sim_scheduler_) {
+        return std::chrono::steady_clock::time_point(
+                std::chrono::milliseconds(sim_scheduler_->now_ms()));
+    }
+    return std::chrono::steady_clock::now();
+}
+
 void RoutingTable::PrintRoutingTable() {
     if (destroy_) {
         return;
@@ -181,7 +264,7 @@ void RoutingTable::PrintRoutingTable() {
 
     uint32_t size = 0;
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
         uint32_t tmp_index = ++index;
         std::string file_name = "/tmp/all_node_id_" + HexSubstr(local_node_ptr_->id()) + std::to_string(tmp_index);
         FILE* fd = fopen(file_name.c_str(), "w");
@@ -217,6 +300,8 @@ void RoutingTable::PrintRoutingTable() {
 bool RoutingTable::UnInit() {
     TellNeighborsDropAllNode();
     destroy_ = true;
+    MemoryStats::Instance()->Unregister(memory_reporter_id_);
+    HeartbeatManagerIntf::Instance()->Unregister(std::to_string((long)this));
     // if (rumor_handler_) {
     //     if (!rumor_handler_->UnInit()) {
     //         TOP_ERROR_NAME("RoutingTable::UnInit Failed.RumorHandler::UnInit");
@@ -234,6 +319,14 @@ bool RoutingTable::UnInit() {
     timer_heartbeat_ = nullptr;
     timer_heartbeat_check_ = nullptr;
     timer_prt_ = nullptr;
+    timer_node_event_ = nullptr;
+    if (sim_scheduler_) {
+        for (auto task_id : sim_task_ids_) {
+            sim_scheduler_->Cancel(task_id);
+        }
+        sim_task_ids_.clear();
+    }
+    node_event_dispatcher_->Unsubscribe(public_nodes_subscription_);
 
     if (bootstrap_cache_helper_) {
         bootstrap_cache_helper_->Stop();
@@ -297,7 +390,7 @@ int RoutingTable::MultiJoin(const std::set<std::pair<std::string, uint16_t>>& bo
             TOP_INFO_NAME("  -> Bootstrap(%s:%d) ...", peer_ip.c_str(), peer_port);
         }
 
-        std::unique_lock<std::mutex> lock(bootstrap_mutex_);
+        std::unique_lock<KadMutex> lock(bootstrap_mutex_);
         if (bootstrap_cond_.wait_for(lock, std::chrono::seconds(wait_time), [this] () -> bool {
                     return this->joined_; })) {
             if (joined_) {
@@ -308,6 +401,14 @@ int RoutingTable::MultiJoin(const std::set<std::pair<std::string, uint16_t>>& bo
             }
         }
 
+        uint32_t retry_after_ms = join_retry_after_ms_.exchange(0);
+        if (retry_after_ms > 0) {
+            // bootstrap is overloaded, back off with jitter so joiners spread out
+            retry_after_ms += RandomUint32() % (retry_after_ms / 2 + 1);
+            TOP_INFO_NAME("bootstrap busy, retry join after %u ms", retry_after_ms);
+            std::this_thread::sleep_for(std::chrono::milliseconds(retry_after_ms));
+        }
+
         retried_times += 1;
         if (retried_times > kJoinRetryTimes) {
             wait_time *= 2;
@@ -354,7 +455,7 @@ bool RoutingTable::IsJoined() {
 
 bool RoutingTable::SetJoin(const std::string& boot_id, const std::string& boot_ip,
         int boot_port) {
-    std::unique_lock<std::mutex> lock(joined_mutex_);
+    std::unique_lock<KadMutex> lock(joined_mutex_);
     if (joined_) {
         TOP_INFO_NAME("SetJoin(%s:%d-%s) ignore",
             boot_ip.c_str(), boot_port, HexEncode(boot_id).c_str());
@@ -372,12 +473,12 @@ bool RoutingTable::SetJoin(const std::string& boot_id, const std::string& boot_i
 }
 
 void RoutingTable::SetUnJoin() {
-    std::unique_lock<std::mutex> lock(joined_mutex_);
+    std::unique_lock<KadMutex> lock(joined_mutex_);
     joined_ = false;
 }
 
 void RoutingTable::WakeBootstrap() {
-    std::lock_guard<std::mutex> lock(bootstrap_mutex_);
+    std::lock_guard<KadMutex> lock(bootstrap_mutex_);
     bootstrap_cond_.notify_all();
 }
 
@@ -402,7 +503,22 @@ void RoutingTable::SendToClosestNode(transport::protobuf::RoutingMessage& messag
     SendToClosestNode(message, true);
 }
 
+// the same on every hop, src_node_id and id are kept while a message is routed
+static uint64_t MessageTraceId(const transport::protobuf::RoutingMessage& message) {
+    return base::xhash64_t::digest(
+            message.src_node_id() + ":" + std::to_string(message.id())
+            + ":" + std::to_string(message.type()));
+}
+
 void RoutingTable::RecursiveSend(transport::protobuf::RoutingMessage& message, int retry_times) {
+    const auto arrival = std::chrono::steady_clock::now();
+    uint64_t trace_id = 0;
+    bool traced = false;
+    if (HopTracer::Instance()->enabled()) {
+        trace_id = MessageTraceId(message);
+        traced = HopTracer::Instance()->Sampled(trace_id);
+    }
+
     std::set<std::string> exclude;
     for (int i = 0; i < message.hop_nodes_size(); ++i) {
         auto iter = exclude.find(message.hop_nodes(i).node_id());
@@ -413,30 +529,119 @@ void RoutingTable::RecursiveSend(transport::protobuf::RoutingMessage& message, i
     }
 
     std::vector<NodeInfoPtr> ready_nodes;
-    std::vector<NodeInfoPtr> next_nodes_vec = GetClosestNodes(message.des_node_id(), RoutingMaxNodesSize_, false);
-    for (auto& nptr : next_nodes_vec) {
-        if (nptr->node_id == local_node_ptr_->id()) {
-            continue;
-        }
-        if (nptr->public_ip == local_node_ptr_->public_ip() && nptr->public_port == local_node_ptr_->public_port()) {
-            continue;
+    GetNextHopNodes(message.des_node_id(), exclude, ready_nodes);
+    if (ready_nodes.empty()) {
+        TOP_WARN_NAME("SendToClosestNode get empty nodes, send failed");
+        return;
+    }
+
+    // sorted once, a failed send moves on to the next candidate
+    ForwardCursor cursor(message.des_node_id(), std::move(ready_nodes), rtt_aware_next_hop_);
+    const uint32_t parallel = GetParallelForward(message.type());
+    uint32_t sent = 0;
+    int tries = retry_times;
+    while (sent < parallel && tries < kForwardMaxTries) {
+        NodeInfoPtr node = cursor.Next();
+        if (!node) {
+            break;
         }
-        auto iter = exclude.find(nptr->node_id);
-        if (iter != exclude.end()) {
+        if (SendData(message, node) == kKadSuccess) {
+            ++sent;
+            if (traced) {
+                RecordHop(message, trace_id, arrival, node);
+            }
             continue;
         }
-        ready_nodes.push_back(nptr);
+        ++tries;
+        TOP_DEBUG_NAME("forward to %s:%d failed, try next hop(%u left)",
+                node->public_ip.c_str(), (int)node->public_port, cursor.remaining());
     }
-    if (ready_nodes.empty()) {
-        TOP_WARN_NAME("SendToClosestNode get empty nodes, send failed");
-        return;
+
+    if (sent == 0) {
+        TOP_WARN_NAME("SendToClosestNode all next hops failed, send failed");
     }
+}
 
-    NodeInfoPtr node = ready_nodes[0];
-    if (!node) {
+void RoutingTable::RecordHop(
+        const transport::protobuf::RoutingMessage& message,
+        uint64_t trace_id,
+        std::chrono::steady_clock::time_point arrival,
+        NodeInfoPtr next_hop) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto queue_delay = std::chrono::duration_cast<std::chrono::microseconds>(now - arrival);
+    const auto arrival_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch() - queue_delay);
+    HopTraceRecord record;
+    record.trace_id = trace_id;
+    record.arrival_us = arrival_us.count();
+    record.node_hash = base::xhash64_t::digest(local_node_ptr_->id());
+    record.next_hop_hash = base::xhash64_t::digest(next_hop->node_id);
+    record.queue_delay_us = static_cast<uint32_t>(queue_delay.count());
+    record.message_type = message.type();
+    record.hop_num = message.hop_nodes_size();
+    HopTracer::Instance()->Record(record);
+}
+
+void RoutingTable::SetParallelForward(int message_type, uint32_t count) {
+    count = std::max(count, 1u);
+    count = std::min(count, kParallelForwardMax);
+    std::unique_lock<KadMutex> lock(parallel_forward_mutex_);
+    if (count == 1) {
+        parallel_forward_map_.erase(message_type);
         return;
     }
-    SendData(message, node);
+    parallel_forward_map_[message_type] = count;
+}
+
+uint32_t RoutingTable::GetParallelForward(int message_type) {
+    std::unique_lock<KadMutex> lock(parallel_forward_mutex_);
+    if (parallel_forward_map_.empty()) {
+        return 1;
+    }
+    auto iter = parallel_forward_map_.find(message_type);
+    if (iter == parallel_forward_map_.end()) {
+        return 1;
+    }
+    return iter->second;
+}
+
+void RoutingTable::GetNextHopNodes(
+        const std::string& des_node_id,
+        const std::set<std::string>& exclude,
+        std::vector<NodeInfoPtr>& ready_nodes) {
+    auto filter_exclude = [&exclude, &ready_nodes](const std::vector<NodeInfoPtr>& nodes) {
+        for (auto& nptr : nodes) {
+            if (exclude.find(nptr->node_id) != exclude.end()) {
+                continue;
+            }
+            ready_nodes.push_back(nptr);
+        }
+    };
+
+    const uint64_t generation = generation_;
+    std::vector<NodeInfoPtr> next_nodes_vec;
+    if (route_cache_->Get(des_node_id, generation, next_nodes_vec)) {
+        filter_exclude(next_nodes_vec);
+        if (!ready_nodes.empty()) {
+            return;
+        }
+        // every cached hop is excluded, look at the whole table
+    }
+
+    std::vector<NodeInfoPtr> closest_nodes = GetClosestNodes(des_node_id, RoutingMaxNodesSize_, false);
+    next_nodes_vec.clear();
+    const LocalIdentity& self = local_node_ptr_->identity();
+    for (auto& nptr : closest_nodes) {
+        if (nptr->node_id == self.id) {
+            continue;
+        }
+        if (nptr->public_ip == self.public_ip && nptr->public_port == self.public_port) {
+            continue;
+        }
+        next_nodes_vec.push_back(nptr);
+    }
+    route_cache_->Put(des_node_id, generation, next_nodes_vec);
+    filter_exclude(next_nodes_vec);
 }
 
 // more pure send api
@@ -444,7 +649,18 @@ int RoutingTable::SendData(
         const xbyte_buffer_t& data,
         const std::string& peer_ip,
         uint16_t peer_port,
-        uint16_t priority) {
+        uint16_t priority,
+        int message_type) {
+    return SendPacket(data, peer_ip, peer_port, priority, message_type, nullptr);
+}
+
+int RoutingTable::SendPacket(
+        const xbyte_buffer_t& data,
+        const std::string& peer_ip,
+        uint16_t peer_port,
+        uint16_t priority,
+        int message_type,
+        transport::UdpPropertyPtr* udp_property) {
     uint8_t local_buf[kUdpPacketBufferSize];
     base::xpacket_t packet(base::xcontext_t::instance(), local_buf, sizeof(local_buf), 0,0, false);
     _xip2_header header;
@@ -454,6 +670,12 @@ int RoutingTable::SendData(
     packet.get_body().push_back((uint8_t*)data.data(), data.size());  // NOLINT
     packet.set_to_ip_addr(peer_ip);
     packet.set_to_ip_port(peer_port);
+    // the same unit as the receive side, which counts the whole packet
+    HeartbeatState::Instance()->Send(message_type, packet.get_size());
+    // pooled nodes have none until they are added
+    if (udp_property && *udp_property) {
+        return transport_ptr_->SendDataWithProp(packet, *udp_property);
+    }
     return transport_ptr_->SendData(packet);
 }
 
@@ -471,7 +693,7 @@ int RoutingTable::SendData(
         return kKadFailed;
     }
     xbyte_buffer_t data{msg.begin(), msg.end()};
-    return SendData(data, peer_ip, peer_port, message.priority());
+    return SendPacket(data, peer_ip, peer_port, message.priority(), message.type(), nullptr);
 }
 
 int RoutingTable::SendData(transport::protobuf::RoutingMessage& message, NodeInfoPtr node) {
@@ -489,19 +711,14 @@ int RoutingTable::SendData(transport::protobuf::RoutingMessage& message, NodeInf
 		return kKadFailed;
 	}
 	xbyte_buffer_t data{msg.begin(), msg.end()};
-//	return SendData(data, peer_ip, peer_port, message.priority());
-
-	uint8_t local_buf[kUdpPacketBufferSize];
-	base::xpacket_t packet(base::xcontext_t::instance(), local_buf, sizeof(local_buf), 0,0, false);
-	_xip2_header header;
-	memset(&header, 0, sizeof(header));
-	header.flags |= message.priority();
-	packet.get_body().push_back((uint8_t*)&header, enum_xip2_header_len);
-	packet.get_body().push_back((uint8_t*)data.data(), data.size());  // NOLINT
-	packet.set_to_ip_addr(node->public_ip);
-	packet.set_to_ip_port(node->public_port);
-    TOP_DEBUG_NAME("xkad send message.type:%d size:%d", message.type(), packet.get_size());
-	return transport_ptr_->SendDataWithProp(packet, node->udp_property);
+    TOP_DEBUG_NAME("xkad send message.type:%d size:%d", message.type(), (int)data.size());
+	return SendPacket(
+            data,
+            node->public_ip,
+            node->public_port,
+            message.priority(),
+            message.type(),
+            &node->udp_property);
 }
 
 void RoutingTable::SetTestTraceInfo(transport::protobuf::RoutingMessage& message) {
@@ -538,10 +755,22 @@ void RoutingTable::SetTestTraceInfo(transport::protobuf::RoutingMessage& message
 }
 
 void RoutingTable::ResetNodeHeartbeat(const std::string& id) {
-    std::unique_lock<std::mutex> set_lock(node_id_map_mutex_);
+    std::unique_lock<KadMutex> set_lock(node_id_map_mutex_);
+    auto iter = node_id_map_.find(id);
+    if (iter != node_id_map_.end()) {
+        iter->second->ResetHeartbeat(Now());
+    }
+}
+
+void RoutingTable::NodeSeen(const std::string& id) {
+    const auto now = Now();
+    const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()).count();
+    std::unique_lock<KadMutex> set_lock(node_id_map_mutex_);
     auto iter = node_id_map_.find(id);
     if (iter != node_id_map_.end()) {
-        iter->second->ResetHeartbeat();
+        iter->second->last_seen_ms.store(now_ms, std::memory_order_relaxed);
+        iter->second->ResetHeartbeat(now);
     }
 }
 
@@ -553,7 +782,7 @@ void RoutingTable::HeartbeatProc() {
     // find all nodes need to heartbeat(sort is not nessesary)
     std::vector<NodeInfoPtr> tmp_vec;
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
         int sort_num = SortNodesByTargetXid(local_node_ptr_->id(), RoutingMaxNodesSize_);
         for (int i = 0; i < sort_num; ++i) {
             tmp_vec.push_back(nodes_[i]);
@@ -561,11 +790,12 @@ void RoutingTable::HeartbeatProc() {
     }
     // do heartbeat for every neighbour nodes
     std::string all_ips;
-    const auto tp_now = std::chrono::steady_clock::now();
+    const auto tp_now = Now();
+    const LocalIdentity& self = local_node_ptr_->identity();
     for (uint32_t i = 0; i < tmp_vec.size(); ++i) {
         all_ips += tmp_vec[i]->public_ip + ", ";
-        if (tmp_vec[i]->public_ip == local_node_ptr_->public_ip() &&
-                tmp_vec[i]->public_port == local_node_ptr_->public_port()) {
+        if (tmp_vec[i]->public_ip == self.public_ip &&
+                tmp_vec[i]->public_port == self.public_port) {
             continue;
         }
 
@@ -577,27 +807,28 @@ void RoutingTable::HeartbeatProc() {
                 continue;
             }
             {
-                std::unique_lock<std::mutex> lock(node_id_map_mutex_);
-                tmp_vec[i]->Heartbeat();
+                std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+                tmp_vec[i]->Heartbeat(tp_now);
             }
         }
         */
     }
+    auto kadmlia_key = local_node_ptr_->kadmlia_key();
     TOP_INFO_NAME("[%s][first: %d][%llu][%d][%d][%d][%d][%d][%d][%d] has nodes_ size(nodes size): %d,"
         "set_size: %d, ip: %s, port: %d, heart_size: %d, all ips:[%s]",
-        HexEncode(local_node_ptr_->id()).c_str(),
+        HexEncode(self.id).c_str(),
         local_node_ptr_->first_node(),
-        local_node_ptr_->kadmlia_key()->GetServiceType(),
-        local_node_ptr_->kadmlia_key()->xnetwork_id(),
-        local_node_ptr_->kadmlia_key()->zone_id(),
-        local_node_ptr_->kadmlia_key()->cluster_id(),
-        local_node_ptr_->kadmlia_key()->group_id(),
-        local_node_ptr_->kadmlia_key()->node_id(),
-        local_node_ptr_->kadmlia_key()->network_type(),
-        local_node_ptr_->kadmlia_key()->xip_type(),
+        kadmlia_key->GetServiceType(),
+        kadmlia_key->xnetwork_id(),
+        kadmlia_key->zone_id(),
+        kadmlia_key->cluster_id(),
+        kadmlia_key->group_id(),
+        kadmlia_key->node_id(),
+        kadmlia_key->network_type(),
+        kadmlia_key->xip_type(),
         node_id_map_.size(),
-        nodes_size(), local_node_ptr_->public_ip().c_str(),
-        local_node_ptr_->public_port(), tmp_vec.size(), all_ips.c_str());
+        nodes_size(), self.public_ip.c_str(),
+        self.public_port, tmp_vec.size(), all_ips.c_str());
 }
 
 void RoutingTable::HeartbeatCheckProc() {
@@ -607,26 +838,17 @@ void RoutingTable::HeartbeatCheckProc() {
 
     std::vector<NodeInfoPtr> tmp_vec;
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
         int sort_num = SortNodesByTargetXid(local_node_ptr_->id(), RoutingMaxNodesSize_);
         for (int i = 0; i < sort_num; ++i) {
             tmp_vec.push_back(nodes_[i]);
         }
     }
 
-    const auto tp_now = std::chrono::steady_clock::now();
+    const auto tp_now = Now();
     for (uint32_t i = 0; i < tmp_vec.size(); ++i) {
         if (tmp_vec[i]->IsTimeout(tp_now)) {
-            DropNode(tmp_vec[i]);
-            TOP_WARN_NAME("node heartbeat error after tried: %d times.ID:[%s],"
-                "IP:[%s],Port[%d] to ID:[%s],IP[%s],Port[%d] drop it.",
-                tmp_vec[i]->heartbeat_count,
-                HexSubstr(local_node_ptr_->id()).c_str(),
-                local_node_ptr_->local_ip().c_str(),
-                local_node_ptr_->local_port(),
-                HexSubstr(tmp_vec[i]->node_id).c_str(),
-                tmp_vec[i]->local_ip.c_str(),
-                tmp_vec[i]->local_port);
+            DropNode(tmp_vec[i], kRoutingReasonHeartbeat);
         }
     }
 }
@@ -652,32 +874,48 @@ void RoutingTable::Rejoin() {
     }
 
     do  {
+            bool unjoined = false;
             {
-                std::unique_lock<std::mutex> vec_lock(nodes_mutex_);
+                std::unique_lock<KadMutex> vec_lock(nodes_mutex_);
                 // hearbeat thread may be drop node, finnally nodes_ size become 0
                 if (nodes_.empty()) {
+                    if (joined_) {
+                        RecordRoutingEvent(kRoutingEventUnjoined, kRoutingReasonEmpty, nullptr);
+                        unjoined = true;
+                    }
                     // this is really import,than join will work
                     SetUnJoin();
                 } else {
                     // usually one real node will not create virtual-nodes beyond 5
                     if (nodes_.size() <= 5) {
                         bool offline = true;
+                        const LocalIdentity& self = local_node_ptr_->identity();
                         for (auto& item : nodes_) {
-                            if (item->public_ip != local_node_ptr_->public_ip()
-                                    || item->public_port != local_node_ptr_->public_port()
-                                    || item->local_ip != local_node_ptr_->local_ip()
-                                    || item->local_port != local_node_ptr_->local_port()) {
+                            if (item->public_ip != self.public_ip
+                                    || item->public_port != self.public_port
+                                    || item->local_ip != self.local_ip
+                                    || item->local_port != self.local_port) {
                                 offline = false;
                             }
                         }
                         // all nodes in routing-table is virtual-nodes of local real node
                         if (offline) {
+                            if (joined_) {
+                                RecordRoutingEvent(kRoutingEventUnjoined, kRoutingReasonOffline, nullptr);
+                                unjoined = true;
+                            }
                             SetUnJoin();
                         }
                     } // end if (nodes_...
                 } // end else
             }
 
+            // the recorder tells which drops led here
+            std::string events_dump;
+            if (unjoined && routing_events_->DumpAnomaly(events_dump)) {
+                TOP_WARN_NAME("routing table unjoined, %s", events_dump.c_str());
+            }
+
             TOP_INFO_NAME("Rejoin alive for self_service_type(%llu), now size(%d)",
                     local_node_ptr_->kadmlia_key()->GetServiceType(),
                     nodes_size());
@@ -688,12 +926,16 @@ void RoutingTable::Rejoin() {
                 std::set<std::pair<std::string, uint16_t>> cache_bootstrap_set;
                 GetBootstrapCache(cache_bootstrap_set);
                 {
-                    std::unique_lock<std::mutex> bootstrap_lock(bootstrap_nodes_mutex_);
+                    std::unique_lock<KadMutex> bootstrap_lock(bootstrap_nodes_mutex_);
                     for (auto& node_ptr : bootstrap_nodes_) {
                         cache_bootstrap_set.insert(std::make_pair(node_ptr->public_ip, node_ptr->public_port));
                     }
                 }
-                if (MultiJoin(cache_bootstrap_set) != kKadSuccess) {
+                if (sim_scheduler_) {
+                    // MultiJoin blocks waiting for the response, which never
+                    // comes while the scheduler thread is blocked
+                    MultiJoinAsync(cache_bootstrap_set);
+                } else if (MultiJoin(cache_bootstrap_set) != kKadSuccess) {
                     TOP_ERROR_NAME("Rejoin MultiJoin failed");
                 } else {
                     TOP_INFO_NAME("Rejoin MultiJoin success");
@@ -715,7 +957,7 @@ void RoutingTable::FindNeighbours() {
     if (local_node_ptr_ && transport_ptr_) {
         std::vector<NodeInfoPtr> tmp_vec;
         {
-            std::unique_lock<std::mutex> lock(nodes_mutex_);
+            std::unique_lock<KadMutex> lock(nodes_mutex_);
             int sort_num = SortNodesByTargetXid(local_node_ptr_->id(), RoutingMaxNodesSize_);
             for (int i = 0; i < sort_num; ++i) {
                 tmp_vec.push_back(nodes_[i]);
@@ -752,8 +994,7 @@ void RoutingTable::FindNeighbours() {
     }
 }
 
-int RoutingTable::AddNode(NodeInfoPtr node) {
-    TOP_DEBUG_NAME("node_id(%s), pub(%s:%d)", HexSubstr(node->node_id).c_str(), node->public_ip.c_str(), node->public_port);
+int RoutingTable::PrepareNewNode(NodeInfoPtr node) {
     if (node->nat_type == kNatTypeUnknown) {
         TOP_WARN_NAME("bluenat[%llu] add node(%s:%d-%d) failed: nat_type is unknown",
             local_node_ptr_->service_type(),
@@ -761,10 +1002,11 @@ int RoutingTable::AddNode(NodeInfoPtr node) {
         return kKadFailed;
     }
 
-    if (node->node_id == local_node_ptr_->id()) {
+    const std::string& local_id = local_node_ptr_->id();
+    if (node->node_id == local_id) {
         TOP_DEBUG_NAME("kHandshake: local_node_ptr_->id()[%s][%s][%s][%d][%s][%s]",
                 HexEncode(node->node_id).c_str(),
-                HexEncode(local_node_ptr_->id()).c_str(),
+                HexEncode(local_id).c_str(),
                 node->public_ip.c_str(),
                 node->public_port,
                 HexEncode(node->xid).c_str(),
@@ -786,39 +1028,50 @@ int RoutingTable::AddNode(NodeInfoPtr node) {
         TOP_WARN_NAME("set node bucket index failed![%s]", node->node_id.c_str());
         return kKadFailed;
     }
+    return kKadSuccess;
+}
+
+int RoutingTable::AddNode(NodeInfoPtr node) {
+    int ret = PrepareNewNode(node);
+    if (ret != kKadSuccess) {
+        return ret;
+    }
+    // share the peer's transport state with the tables of other services
+    node->udp_property = PeerStore::Instance()->GetUdpProperty(node->public_ip, node->public_port);
 
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
-        SortNodesByTargetXid(local_node_ptr_->id(), nodes_.size());
-        if (!NewNodeReplaceOldNode(node, true)) {
-            TOP_WARN_NAME("newnodereplaceoldnode failed. node_id:%s, node_bucket:%d, local:%s",
-                    HexEncode(node->node_id).c_str(),
-                    node->bucket_index,
-                    HexEncode(local_node_ptr_->id()).c_str());
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
+        if (!NewNodeReplaceOldNode(node)) {
+            RecordRoutingEvent(kRoutingEventRejected, kRoutingReasonBucketFull, node);
+            lock.unlock();
+            CacheReplacement(node);
             return kKadFailed;
         }
 
-        TOP_WARN_NAME("newnodereplaceoldnode success. node_id:%s, node_bucket:%d, local:%s",
-                HexEncode(node->node_id).c_str(),
-                node->bucket_index,
-                HexEncode(local_node_ptr_->id()).c_str());
-
         if (HasNode(node)) {
             TOP_INFO_NAME("kHandshake: HasNode");
             return kKadNodeHasAdded;
         }
-        TOP_DEBUG_NAME("addnode:[%s] for local_node:[%s]", HexEncode(node->node_id).c_str(), HexEncode(local_node_ptr_->id()).c_str());
-        nodes_.push_back(node);
+        InsertNode(node);
+        node_event_dispatcher_->Publish(kNodeEventAdded, node, ++generation_);
+        RecordRoutingEvent(kRoutingEventAdded, kRoutingReasonNone, node);
         // DumpNodes();
     }
+    replacement_cache_->Remove(node->node_id, node->bucket_index);
 
     {
-        std::unique_lock<std::mutex> lock(node_id_map_mutex_);
-        node_id_map_.insert(std::make_pair(node->node_id, node));
+        std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+        // DropNode unsubscribes once per node id
+        if (node_id_map_.insert(std::make_pair(node->node_id, node)).second) {
+            endpoint_nodes_map_.insert(std::make_pair(
+                    EndpointKey(node->public_ip, node->public_port), node));
+            HeartbeatManagerIntf::Instance()->Subscribe(
+                    std::to_string((long)this), node->public_ip, node->public_port);
+        }
     }
 
     {
-        std::unique_lock<std::mutex> lock_hash(node_hash_map_mutex_);
+        std::unique_lock<KadMutex> lock_hash(node_hash_map_mutex_);
         node_hash_map_->insert(std::make_pair(node->hash64, node));
     }
 
@@ -827,6 +1080,81 @@ int RoutingTable::AddNode(NodeInfoPtr node) {
     return kKadSuccess;
 }
 
+uint32_t RoutingTable::AddNodes(const std::vector<NodeInfoPtr>& nodes) {
+    std::vector<NodeInfoPtr> candidates;
+    for (auto& node : nodes) {
+        if (PrepareNewNode(node) == kKadSuccess) {
+            node->udp_property = PeerStore::Instance()->GetUdpProperty(node->public_ip, node->public_port);
+            candidates.push_back(node);
+        }
+    }
+    if (candidates.empty()) {
+        return 0;
+    }
+
+    std::vector<NodeInfoPtr> added_nodes;
+    std::vector<NodeInfoPtr> rejected_nodes;
+    {
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
+        std::set<std::string> batch_ids;
+        for (auto& node : candidates) {
+            if (!batch_ids.insert(node->node_id).second || HasNode(node)) {
+                continue;
+            }
+            if (!NewNodeReplaceOldNode(node)) {
+                RecordRoutingEvent(kRoutingEventRejected, kRoutingReasonBucketFull, node);
+                rejected_nodes.push_back(node);
+                continue;
+            }
+            InsertNode(node);
+            added_nodes.push_back(node);
+        }
+        if (!added_nodes.empty()) {
+            uint64_t generation = ++generation_;
+            for (auto& node : added_nodes) {
+                node_event_dispatcher_->Publish(kNodeEventAdded, node, generation);
+                RecordRoutingEvent(kRoutingEventAdded, kRoutingReasonNone, node);
+            }
+        }
+    }
+
+    for (auto& node : rejected_nodes) {
+        CacheReplacement(node);
+    }
+    if (added_nodes.empty()) {
+        return 0;
+    }
+
+    {
+        std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+        for (auto& node : added_nodes) {
+            if (!node_id_map_.insert(std::make_pair(node->node_id, node)).second) {
+                continue;
+            }
+            endpoint_nodes_map_.insert(std::make_pair(
+                    EndpointKey(node->public_ip, node->public_port), node));
+            HeartbeatManagerIntf::Instance()->Subscribe(
+                    std::to_string((long)this), node->public_ip, node->public_port);
+        }
+    }
+
+    {
+        std::unique_lock<KadMutex> lock_hash(node_hash_map_mutex_);
+        for (auto& node : added_nodes) {
+            node_hash_map_->insert(std::make_pair(node->hash64, node));
+        }
+    }
+
+    for (auto& node : added_nodes) {
+        replacement_cache_->Remove(node->node_id, node->bucket_index);
+    }
+
+    no_lock_for_use_nodes_.reset();
+    no_lock_for_use_nodes_ = std::make_shared<std::vector<NodeInfoPtr>>(nodes());
+    TOP_DEBUG_NAME("add %d of %d nodes in batch", (int)added_nodes.size(), (int)nodes.size());
+    return added_nodes.size();
+}
+
 void RoutingTable::DumpNodes() {
     // dump all nodes
     {
@@ -875,38 +1203,89 @@ bool RoutingTable::CanAddNode(NodeInfoPtr node) {
         return false;
     }
 
-    std::unique_lock<std::mutex> lock(nodes_mutex_);
-    SortNodesByTargetXid(local_node_ptr_->id(), nodes_.size());
-    NodeInfoPtr remove_node;
-    if (NewNodeReplaceOldNode(node, false)) {
-        return true;
+    {
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
+        if (NewNodeReplaceOldNode(node)) {
+            return true;
+        }
     }
 
     TOP_DEBUG_NAME("replace fail, dis(%d)", node->bucket_index);
+    CacheReplacement(node);
     return false;
 }
 
+void RoutingTable::RecordRoutingEvent(int type, int reason, NodeInfoPtr node) {
+    if (!node) {
+        routing_events_->Record(type, reason, 0, 0, kInvalidBucketIndex, nodes_.size(), generation_);
+        return;
+    }
+    routing_events_->Record(
+            type,
+            reason,
+            base::xhash64_t::digest(node->node_id),
+            node->public_port,
+            node->bucket_index,
+            nodes_.size(),
+            generation_);
+}
+
 int RoutingTable::DropNode(NodeInfoPtr node) {
+    return DropNode(node, kRoutingReasonApi);
+}
+
+int RoutingTable::DropNode(NodeInfoPtr node, int reason) {
+    int bucket_index = kInvalidBucketIndex;
     {
-        std::unique_lock<std::mutex> vec_lock(nodes_mutex_);
+        std::unique_lock<KadMutex> vec_lock(nodes_mutex_);
         for (auto iter = nodes_.begin(); iter != nodes_.end(); ++iter) {
             if ((*iter)->node_id == node->node_id) {
+                NodeInfoPtr dropped_node = *iter;
+                bucket_index = dropped_node->bucket_index;
+                node_event_dispatcher_->Publish(kNodeEventDropped, dropped_node, ++generation_);
                 nodes_.erase(iter);
+                auto bucket_iter = bucket_nodes_.find(bucket_index);
+                if (bucket_iter != bucket_nodes_.end()) {
+                    auto& members = bucket_iter->second;
+                    for (auto member_iter = members.begin(); member_iter != members.end(); ++member_iter) {
+                        if (*member_iter == dropped_node) {
+                            members.erase(member_iter);
+                            break;
+                        }
+                    }
+                    if (members.empty()) {
+                        bucket_nodes_.erase(bucket_iter);
+                    }
+                }
+                RecordRoutingEvent(kRoutingEventDropped, reason, dropped_node);
                 break;
             }
         }
     }
 
     {
-        std::unique_lock<std::mutex> set_lock(node_id_map_mutex_);
+        std::unique_lock<KadMutex> set_lock(node_id_map_mutex_);
         auto iter = node_id_map_.find(node->node_id);
         if (iter != node_id_map_.end()) {
+            // caller may only know the id(node quit), use the endpoint of the added one
+            auto range = endpoint_nodes_map_.equal_range(
+                    EndpointKey(iter->second->public_ip, iter->second->public_port));
+            for (auto ep_iter = range.first; ep_iter != range.second; ++ep_iter) {
+                if (ep_iter->second->node_id == node->node_id) {
+                    endpoint_nodes_map_.erase(ep_iter);
+                    break;
+                }
+            }
+            HeartbeatManagerIntf::Instance()->Unsubscribe(
+                    std::to_string((long)this),
+                    iter->second->public_ip,
+                    iter->second->public_port);
             node_id_map_.erase(iter);
         }
     }
 
     {
-        std::unique_lock<std::mutex> lock_hash(node_hash_map_mutex_);
+        std::unique_lock<KadMutex> lock_hash(node_hash_map_mutex_);
         auto iter = node_hash_map_->find(node->hash64);
         if (iter != node_hash_map_->end()) {
             node_hash_map_->erase(iter);
@@ -914,20 +1293,134 @@ int RoutingTable::DropNode(NodeInfoPtr node) {
     }
 
     // drop dynamic xip distribute by node
-    TOP_DEBUG_NAME("update drop node[%s, %s:%d]",
-            HexSubstr(node->node_id).c_str(),
-            node->public_ip.c_str(), node->public_port);
     local_node_ptr_->DropDxip(node->node_id);
     if(security_join_ptr_) {
         security_join_ptr_->Frozen(node->xid);
     }
     no_lock_for_use_nodes_.reset();
     no_lock_for_use_nodes_ = std::make_shared<std::vector<NodeInfoPtr>>(nodes());
+
+    if (bucket_index != kInvalidBucketIndex && !destroy_) {
+        PromoteReplacements(bucket_index);
+    }
     return kKadSuccess;
 }
 
+void RoutingTable::CacheReplacement(NodeInfoPtr node) {
+    replacement_cache_->Add(node, Now());
+    if (!probe_full_bucket_) {
+        return;
+    }
+
+    // probe the least-recently-seen member of the full bucket, once per
+    // kReplacementProbeIntervalMs per bucket. it is evicted (and the candidate
+    // promoted) after kReplacementProbeMaxMiss unanswered probes
+    const auto now = Now();
+    NodeInfoPtr lrs_node;
+    {
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
+        auto& probe_time = bucket_probe_time_[node->bucket_index];
+        if (now < probe_time) {
+            return;
+        }
+        auto iter = bucket_nodes_.find(node->bucket_index);
+        if (iter == bucket_nodes_.end()) {
+            return;
+        }
+        int64_t lrs_seen_ms = 0;
+        for (auto& n : iter->second) {
+            const int64_t seen_ms = n->last_seen_ms.load(std::memory_order_relaxed);
+            if (!lrs_node || seen_ms < lrs_seen_ms) {
+                lrs_node = n;
+                lrs_seen_ms = seen_ms;
+            }
+        }
+        if (!lrs_node) {
+            return;
+        }
+        probe_time = now + std::chrono::milliseconds(kReplacementProbeIntervalMs);
+    }
+
+    // missed probes are counted by the heartbeat state, guarded by
+    // node_id_map_mutex_ like ResetNodeHeartbeat
+    int32_t lrs_miss = 0;
+    {
+        std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+        lrs_miss = lrs_node->heartbeat_count;
+    }
+
+    if (lrs_miss >= kReplacementProbeMaxMiss) {
+        TOP_INFO_NAME("bucket(%d) member(%s:%d) missed %d probes, evict it",
+                lrs_node->bucket_index,
+                lrs_node->public_ip.c_str(),
+                (int)lrs_node->public_port,
+                lrs_miss);
+        DropNode(lrs_node, kRoutingReasonEvicted);
+        return;
+    }
+
+    if (SendHeartbeat(lrs_node, local_node_ptr_->service_type()) == kKadSuccess) {
+        std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+        lrs_node->Heartbeat(Now());
+    }
+}
+
+void RoutingTable::PromoteReplacements(int bucket_index) {
+    {
+        std::unique_lock<KadMutex> lock(promotion_mutex_);
+        pending_promotions_.push_back(bucket_index);
+        if (promoting_) {
+            return;  // a drop inside a promotion, the running loop takes it
+        }
+        promoting_ = true;
+    }
+
+    while (true) {
+        int next_bucket_index = kInvalidBucketIndex;
+        {
+            std::unique_lock<KadMutex> lock(promotion_mutex_);
+            if (pending_promotions_.empty()) {
+                promoting_ = false;
+                return;
+            }
+            next_bucket_index = pending_promotions_.front();
+            pending_promotions_.pop_front();
+        }
+        PromoteReplacement(next_bucket_index);
+    }
+}
+
+void RoutingTable::PromoteReplacement(int bucket_index) {
+    // bounded, a candidate rejected again is cached again
+    for (uint32_t i = 0; i < kReplacementCacheSize; ++i) {
+        NodeInfoPtr node = replacement_cache_->Pop(bucket_index, Now());
+        if (!node) {
+            return;
+        }
+
+        if (node->nat_type == kNatTypePublic
+                || (node->local_ip == node->public_ip && node->local_port == node->public_port)) {
+            if (AddNode(node) == kKadSuccess) {
+                TOP_DEBUG_NAME("bucket(%d) promote replacement(%s, %s:%d)",
+                        bucket_index,
+                        HexSubstr(node->node_id).c_str(),
+                        node->public_ip.c_str(),
+                        (int)node->public_port);
+                return;
+            }
+            continue;
+        }
+
+        // not reachable directly, handshake before adding
+        if (node_detection_ptr_ && CanAddNode(node)) {
+            node_detection_ptr_->AddDetectionNode(node);
+            return;
+        }
+    }
+}
+
 NodeInfoPtr RoutingTable::GetRandomNode() {
-    std::unique_lock<std::mutex> lock(nodes_mutex_);
+    std::unique_lock<KadMutex> lock(nodes_mutex_);
     if (nodes_.empty()) {
         return nullptr;
     }
@@ -935,7 +1428,7 @@ NodeInfoPtr RoutingTable::GetRandomNode() {
 }
 
 std::vector<NodeInfoPtr> RoutingTable::nodes() {
-    std::unique_lock<std::mutex> lock(nodes_mutex_);
+    std::unique_lock<KadMutex> lock(nodes_mutex_);
     return nodes_;
 }
 
@@ -948,7 +1441,7 @@ void RoutingTable::GetRangeNodes(
         return;
     }
 
-    std::unique_lock<std::mutex> lock(node_hash_map_mutex_);
+    std::unique_lock<KadMutex> lock(node_hash_map_mutex_);
     auto minit = node_hash_map_->lower_bound(min); // the first item not less than
     auto maxit = node_hash_map_->upper_bound(max); // the first item greater than
     for (auto it = minit; it != maxit && it != node_hash_map_->end(); ++it) {
@@ -976,7 +1469,7 @@ void RoutingTable::GetRangeNodes(
         return;
     }
 
-    std::unique_lock<std::mutex> lock(node_hash_map_mutex_);
+    std::unique_lock<KadMutex> lock(node_hash_map_mutex_);
     auto ibegin = node_hash_map_->begin();
     auto nxit_min = std::next(ibegin, min_index);
     auto nxit_max = std::next(ibegin, max_index + 1);
@@ -988,7 +1481,7 @@ void RoutingTable::GetRangeNodes(
 }
 
 int32_t RoutingTable::GetSelfIndex() {
-    std::unique_lock<std::mutex> lock(node_hash_map_mutex_);
+    std::unique_lock<KadMutex> lock(node_hash_map_mutex_);
     auto ifind = node_hash_map_->find(local_node_ptr_->hash64());
     if (ifind == node_hash_map_->end()) {
         //std::cout << "not found" << std::endl;
@@ -999,13 +1492,65 @@ int32_t RoutingTable::GetSelfIndex() {
     return index;
 }
 
+void RoutingTable::GetMemoryUsage(std::vector<MemoryUsage>& usages) {
+    const uint64_t service_type = local_node_ptr_->service_type();
+    MemoryUsage usage;
+    usage.name = base::StringUtil::str_fmt("routing_table(%llu)", service_type);
+    usage.bytes = sizeof(RoutingTable);
+    {
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
+        usage.entries = nodes_.size();
+        usage.bytes += nodes_.capacity() * sizeof(NodeInfoPtr);
+        for (auto& node : nodes_) {
+            usage.bytes += NodeInfoBytes(*node);
+        }
+    }
+    {
+        std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+        for (auto& item : node_id_map_) {
+            usage.bytes += kMapNodeBytes + sizeof(item) + StringHeapBytes(item.first);
+        }
+        usage.bytes += endpoint_nodes_map_.size()
+                * (kHashNodeBytes + sizeof(decltype(endpoint_nodes_map_)::value_type));
+        usage.bytes += endpoint_nodes_map_.bucket_count() * sizeof(void*);
+    }
+    {
+        std::unique_lock<KadMutex> lock(node_hash_map_mutex_);
+        usage.bytes += node_hash_map_->size()
+                * (kMapNodeBytes + sizeof(std::map<uint64_t, NodeInfoPtr>::value_type));
+    }
+    {
+        std::unique_lock<KadMutex> lock(public_nodes_mutex_);
+        for (auto& item : public_nodes_) {
+            usage.bytes += kHashNodeBytes + sizeof(item) + StringHeapBytes(item.first);
+        }
+        usage.bytes += public_nodes_.bucket_count() * sizeof(void*);
+    }
+    usage.bytes += replacement_cache_->bytes();
+    usage.bytes += routing_events_->bytes();
+    usages.push_back(usage);
+
+    if (dy_manager_) {
+        MemoryUsage dy_usage;
+        dy_usage.name = base::StringUtil::str_fmt("dynamic_xip(%llu)", service_type);
+        dy_manager_->GetMemoryUsage(dy_usage);
+        usages.push_back(dy_usage);
+    }
+    if (bootstrap_cache_helper_) {
+        MemoryUsage cache_usage;
+        cache_usage.name = base::StringUtil::str_fmt("bootstrap_cache(%llu)", service_type);
+        bootstrap_cache_helper_->GetMemoryUsage(cache_usage);
+        usages.push_back(cache_usage);
+    }
+}
+
 uint32_t RoutingTable::nodes_size() {
-    std::unique_lock<std::mutex> lock(nodes_mutex_);
+    std::unique_lock<KadMutex> lock(nodes_mutex_);
     return nodes_.size();
 }
 
 NodeInfoPtr RoutingTable::GetNode(const std::string& id) {
-    std::unique_lock<std::mutex> set_lock(node_id_map_mutex_);
+    std::unique_lock<KadMutex> set_lock(node_id_map_mutex_);
     auto iter = node_id_map_.find(id);
     if (iter != node_id_map_.end()) {
         return iter->second;
@@ -1096,7 +1641,7 @@ std::vector<NodeInfoPtr> RoutingTable::GetClosestNodes(
     const std::string& target_id,
     uint32_t number_to_get,
     bool base_xip) {
-    std::unique_lock<std::mutex> lock(nodes_mutex_);
+    std::unique_lock<KadMutex> lock(nodes_mutex_);
     if (number_to_get == 0) {
         return std::vector<NodeInfoPtr>();
     }
@@ -1117,14 +1662,23 @@ std::vector<NodeInfoPtr> RoutingTable::GetClosestNodes(
                std::begin(nodes_) + static_cast<size_t>(sorted_count));
 }
 
+bool RoutingTable::IsNewNodeCandidate(const std::string& id, int32_t nat_type) {
+    if (nat_type == kNatTypeUnknown || id.size() != kNodeIdSize || id == local_node_ptr_->id()) {
+        return false;
+    }
+
+    std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+    return node_id_map_.find(id) == node_id_map_.end();
+}
+
 bool RoutingTable::HasNode(NodeInfoPtr node) {
-    std::unique_lock<std::mutex> lock(node_id_map_mutex_);
+    std::unique_lock<KadMutex> lock(node_id_map_mutex_);
     auto iter = node_id_map_.find(node->node_id);
     return iter != node_id_map_.end();
 }
 
 NodeInfoPtr RoutingTable::FindLocalNode(const std::string node_id) {
-    std::unique_lock<std::mutex> lock(node_id_map_mutex_);
+    std::unique_lock<KadMutex> lock(node_id_map_mutex_);
     auto iter = node_id_map_.find(node_id);
     if (iter != node_id_map_.end()) {
         return iter->second;
@@ -1146,12 +1700,13 @@ bool RoutingTable::ValidNode(NodeInfoPtr node) {
 }
 
 int RoutingTable::SetNodeBucket(NodeInfoPtr node) {
+    const LocalIdentity& self = local_node_ptr_->identity();
     int id_bit_index(0);
     while (id_bit_index != kNodeIdSize) {
-        if (local_node_ptr_->id()[id_bit_index] != node->node_id[id_bit_index]) {
-            std::bitset<8> holder_byte(static_cast<int>(
-                        local_node_ptr_->id()[id_bit_index]));
-            std::bitset<8> node_byte(static_cast<int>(node->node_id[id_bit_index]));
+        const uint8_t node_id_byte = static_cast<uint8_t>(node->node_id[id_bit_index]);
+        if (self.id_bytes[id_bit_index] != node_id_byte) {
+            std::bitset<8> holder_byte(static_cast<int>(self.id_bytes[id_bit_index]));
+            std::bitset<8> node_byte(static_cast<int>(node_id_byte));
             int bit_index(0);
             while (bit_index != 8U) {
                 if (holder_byte[7U - bit_index] != node_byte[7U - bit_index]) {
@@ -1226,27 +1781,74 @@ bool RoutingTable::CloserToTarget(
     return false;
 }
 
-bool RoutingTable::NewNodeReplaceOldNode(NodeInfoPtr node, bool remove) {
-    int sum = 0;
-    for (auto& n : nodes_) {
-        if (n->bucket_index == node->bucket_index) {
-            sum += 1;
-        }
+bool RoutingTable::NewNodeReplaceOldNode(NodeInfoPtr node) {
+    uint32_t sum = 0;
+    auto iter = bucket_nodes_.find(node->bucket_index);
+    if (iter != bucket_nodes_.end()) {
+        sum = iter->second.size();
     }
 
     // the k-bucket is full
-    if (sum >= kKadParamK) {
-        TOP_DEBUG_NAME("k-bucket(%d) is full", node->bucket_index);
+    const uint32_t capacity = bucket_capacity_policy_.Capacity(node->bucket_index);
+    if (sum >= capacity) {
+        TOP_DEBUG_NAME("k-bucket(%d) is full(%u)", node->bucket_index, capacity);
         return false;
     }
 
     return true;
 }
 
+void RoutingTable::InsertNode(NodeInfoPtr node) {
+    // a new member is the most recently seen one of its bucket, its
+    // heartbeat deadline moves onto the table clock
+    const auto now = Now();
+    node->last_seen_ms.store(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count(),
+            std::memory_order_relaxed);
+    node->ResetHeartbeat(now);
+    nodes_.push_back(node);
+    bucket_nodes_[node->bucket_index].push_back(node);
+}
+
+void RoutingTable::set_bucket_capacity_policy(const BucketCapacityPolicy& policy) {
+    if (!policy.Valid()) {
+        TOP_WARN_NAME("invalid bucket capacity policy(%u, %u, %u)",
+                policy.near_bucket_count, policy.near_k, policy.far_k);
+        return;
+    }
+
+    // buckets over their new capacity keep the first nodes, the rest are dropped
+    std::vector<NodeInfoPtr> trimmed_nodes;
+    {
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
+        bucket_capacity_policy_ = policy;
+        std::map<int, uint32_t> bucket_sizes;
+        for (auto& node : nodes_) {
+            if (++bucket_sizes[node->bucket_index] > policy.Capacity(node->bucket_index)) {
+                trimmed_nodes.push_back(node);
+            }
+        }
+    }
+
+    for (auto& node : trimmed_nodes) {
+        TOP_INFO_NAME("bucket(%d) over capacity(%u), drop %s:%d",
+                node->bucket_index,
+                policy.Capacity(node->bucket_index),
+                node->public_ip.c_str(),
+                (int)node->public_port);
+        DropNode(node, kRoutingReasonEvicted);
+    }
+}
+
+BucketCapacityPolicy RoutingTable::bucket_capacity_policy() {
+    std::unique_lock<KadMutex> lock(nodes_mutex_);
+    return bucket_capacity_policy_;
+}
+
 void RoutingTable::GetRandomAlphaNodes(std::map<std::string, std::string>& query_nodes) {
     query_nodes.clear();
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
         if (nodes_.size() == 0) {
             return;
         }
@@ -1265,7 +1867,7 @@ void RoutingTable::GetRandomAlphaNodes(std::map<std::string, std::string>& query
 void RoutingTable::GetClosestAlphaNodes(std::map<std::string, std::string>& query_nodes) {
     query_nodes.clear();
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
+        std::unique_lock<KadMutex> lock(nodes_mutex_);
         // when nodes_.size is not enough
         if (nodes_.size() <= kKadParamAlpha + kKadParamAlphaRandom) {
             for (auto& node : nodes_) {
@@ -1432,6 +2034,7 @@ int RoutingTable::SendFindClosestNodes(
             message.des_service_type(),
             local_node_ptr_->kadmlia_key()->GetServiceType());
     TOP_DEBUG_NAME("bluefind send_find to node: %s", HexSubstr(node_ptr->node_id).c_str());
+    rtt_sampler_->Sent(message.id(), message.type(), Now());
     SendData(message, node_ptr);
     return kKadSuccess;
 }
@@ -1449,7 +2052,7 @@ int RoutingTable::SendHeartbeat(NodeInfoPtr node_ptr, uint64_t des_service_type)
         = heart_beat_info.mutable_extinfo_map();
 
     {
-        std::unique_lock<std::mutex> lock(heart_beat_info_map_mutex_);
+        std::unique_lock<KadMutex> lock(heart_beat_info_map_mutex_);
         for (auto& item : heart_beat_info_map_) {
             (*extinfo_map)[item.first] = item.second;
         }
@@ -1480,7 +2083,8 @@ void RoutingTable::GetExistsNodesBloomfilter(
 void RoutingTable::HandleMessage(transport::protobuf::RoutingMessage& message, base::xpacket_t& packet) {}
 
 bool RoutingTable::IsDestination(const std::string& des_node_id, bool check_closest) {
-    if (des_node_id == local_node_ptr_->id()) {
+    const std::string& local_id = local_node_ptr_->id();
+    if (des_node_id == local_id) {
         return true;
     }
 
@@ -1492,7 +2096,7 @@ bool RoutingTable::IsDestination(const std::string& des_node_id, bool check_clos
     if (ClosestToTarget(des_node_id, closest) != kKadSuccess) {
         TOP_WARN_NAME("this message must drop! this node is not des "
             "but nearest node is this node![%s] to [%s]",
-            HexSubstr(local_node_ptr_->id()).c_str(),
+            HexSubstr(local_id).c_str(),
             HexSubstr(des_node_id).c_str());
         return false;
     }
@@ -1500,6 +2104,36 @@ bool RoutingTable::IsDestination(const std::string& des_node_id, bool check_clos
     return closest;
 }
 
+void RoutingTable::GetClosestNodesResponse(
+        const std::string& target_id,
+        uint32_t max_bytes,
+        protobuf::FindClosestNodesResponse& find_nodes_res) {
+    std::vector<NodeInfoPtr> closest_nodes = GetClosestNodes(target_id, kKadParamK + 1);
+    for (uint32_t i = 0; i < closest_nodes.size(); ++i) {
+        if (find_nodes_res.nodes_size() >= kKadParamK) {
+            break;
+        }
+
+        if (closest_nodes[i]->node_id == target_id) {
+            continue;
+        }
+
+        protobuf::NodeInfo* tmp_node = find_nodes_res.add_nodes();
+        tmp_node->set_id(closest_nodes[i]->node_id);
+        tmp_node->set_public_ip(closest_nodes[i]->public_ip);
+        tmp_node->set_public_port(closest_nodes[i]->public_port);
+        tmp_node->set_local_ip(closest_nodes[i]->local_ip);
+        tmp_node->set_local_port(closest_nodes[i]->local_port);
+        tmp_node->set_nat_type(closest_nodes[i]->nat_type);
+        tmp_node->set_xip(closest_nodes[i]->xip);
+        tmp_node->set_xid(closest_nodes[i]->xid);
+        if (find_nodes_res.ByteSizeLong() > max_bytes) {
+            find_nodes_res.mutable_nodes()->RemoveLast();
+            break;
+        }
+    }
+}
+
 void RoutingTable::HandleFindNodesRequest(
         transport::protobuf::RoutingMessage& message,
         base::xpacket_t& packet) {
@@ -1524,20 +2158,19 @@ void RoutingTable::HandleFindNodesRequest(
     }
 
     // asker node canadd to local routingtable?
-    auto src_nodeinfo = find_nodes_req.src_nodeinfo();
-    NodeInfoPtr req_src_node_ptr;
-    req_src_node_ptr.reset(new NodeInfo(src_nodeinfo.id()));
-    req_src_node_ptr->local_ip = src_nodeinfo.local_ip();
-    req_src_node_ptr->local_port = src_nodeinfo.local_port();
-    req_src_node_ptr->public_ip = src_nodeinfo.public_ip();
-    req_src_node_ptr->public_port = src_nodeinfo.public_port();
-    req_src_node_ptr->nat_type = src_nodeinfo.nat_type();
-    req_src_node_ptr->xip = src_nodeinfo.xip();
-    req_src_node_ptr->xid = src_nodeinfo.xid();
-    req_src_node_ptr->hash64 = base::xhash64_t::digest(req_src_node_ptr->xid);
-
+    const auto& src_nodeinfo = find_nodes_req.src_nodeinfo();
     // just consider public ip here
-    if (req_src_node_ptr->nat_type == kNatTypePublic){
+    if (src_nodeinfo.nat_type() == kNatTypePublic &&
+            IsNewNodeCandidate(src_nodeinfo.id(), src_nodeinfo.nat_type())) {
+        NodeInfoPtr req_src_node_ptr = NewNodeInfo(src_nodeinfo.id());
+        req_src_node_ptr->local_ip = src_nodeinfo.local_ip();
+        req_src_node_ptr->local_port = src_nodeinfo.local_port();
+        req_src_node_ptr->public_ip = src_nodeinfo.public_ip();
+        req_src_node_ptr->public_port = src_nodeinfo.public_port();
+        req_src_node_ptr->nat_type = src_nodeinfo.nat_type();
+        req_src_node_ptr->xip = src_nodeinfo.xip();
+        req_src_node_ptr->xid = src_nodeinfo.xid();
+        req_src_node_ptr->hash64 = base::xhash64_t::digest(req_src_node_ptr->xid);
         if (CanAddNode(req_src_node_ptr)) {
             AddNode(req_src_node_ptr);
         }
@@ -1664,11 +2297,26 @@ void RoutingTable::HandleFindNodesResponse(
     }
 
     TOP_DEBUG_NAME("HandleFindNodesResponse get %d nodes", find_nodes_res.nodes_size());
+    UpdateNodeRtt(message, nullptr);
+    HandleClosestNodes(find_nodes_res, message, packet);
+}
+
+void RoutingTable::HandleClosestNodes(
+        const protobuf::FindClosestNodesResponse& find_nodes_res,
+        transport::protobuf::RoutingMessage& message,
+        base::xpacket_t& packet) {
+    // directly reachable nodes are added in one batch
+    std::vector<NodeInfoPtr> add_nodes;
+    const LocalIdentity& self = local_node_ptr_->identity();
     for (int i = 0; i < find_nodes_res.nodes_size(); ++i) {
         // TOP_FATAL_NAME("find nodes: %s(%s:%d)", HexEncode(find_nodes_res.nodes(i).id()).c_str(),
         //     find_nodes_res.nodes(i).public_ip().c_str(), (int)find_nodes_res.nodes(i).public_port());
-        NodeInfoPtr node_ptr;
-        node_ptr.reset(new NodeInfo(find_nodes_res.nodes(i).id()));
+        // most entries of a converged table are known, reject them before allocating
+        if (!IsNewNodeCandidate(find_nodes_res.nodes(i).id(), find_nodes_res.nodes(i).nat_type())) {
+            continue;
+        }
+
+        NodeInfoPtr node_ptr = NewNodeInfo(find_nodes_res.nodes(i).id());
         node_ptr->local_ip = find_nodes_res.nodes(i).local_ip();
         node_ptr->local_port = find_nodes_res.nodes(i).local_port();
         node_ptr->public_ip = find_nodes_res.nodes(i).public_ip();
@@ -1678,50 +2326,54 @@ void RoutingTable::HandleFindNodesResponse(
         node_ptr->xip = find_nodes_res.nodes(i).xip();
         node_ptr->xid = find_nodes_res.nodes(i).xid();
         node_ptr->hash64 = base::xhash64_t::digest(node_ptr->xid);
-        if (CanAddNode(node_ptr)) {
-            if (node_ptr->public_ip == local_node_ptr_->public_ip() &&
-                    node_ptr->public_port == local_node_ptr_->public_port()) {
-                if (node_ptr->node_id != local_node_ptr_->id()) {
-                    TOP_DEBUG_NAME("bluenat[%d] get nat_type(%d) of node(%s:%d-%d)",
-                        local_node_ptr_->service_type(), node_ptr->nat_type,
-                        node_ptr->public_ip.c_str(), node_ptr->public_port, node_ptr->service_type);
-                    node_ptr->xid = global_xid->Get();
-                    node_ptr->hash64 = base::xhash64_t::digest(node_ptr->xid);
-                    if (AddNode(node_ptr) == kKadSuccess) {
-                        TOP_DEBUG_NAME("update add_node(%s) from find node response(%s, %s:%d)",
-                                HexSubstr(node_ptr->node_id).c_str(), HexSubstr(message.src_node_id()).c_str(),
-                                packet.get_from_ip_addr().c_str(), packet.get_from_ip_port());
-                    }
-                }
-                continue;
+        if (node_ptr->public_ip == self.public_ip &&
+                node_ptr->public_port == self.public_port) {
+            if (node_ptr->node_id != self.id) {
+                TOP_DEBUG_NAME("bluenat[%d] get nat_type(%d) of node(%s:%d-%d)",
+                    local_node_ptr_->service_type(), node_ptr->nat_type,
+                    node_ptr->public_ip.c_str(), node_ptr->public_port, node_ptr->service_type);
+                node_ptr->xid = global_xid->Get();
+                node_ptr->hash64 = base::xhash64_t::digest(node_ptr->xid);
+                add_nodes.push_back(node_ptr);
             }
+            continue;
+        }
 
-            if (local_node_ptr_->nat_type() == kNatTypeConeAbnormal
-                    && node_ptr->nat_type == kNatTypeConeAbnormal) {
-                TOP_DEBUG_NAME("bluenat[%d] both node is abnormal, ignore connect",
-                    local_node_ptr_->service_type());
-                continue;
-            }
+        if (local_node_ptr_->nat_type() == kNatTypeConeAbnormal
+                && node_ptr->nat_type == kNatTypeConeAbnormal) {
+            TOP_DEBUG_NAME("bluenat[%d] both node is abnormal, ignore connect",
+                local_node_ptr_->service_type());
+            continue;
+        }
 
-            TOP_DEBUG("find node: %s:%d public:%d",
-                    node_ptr->public_ip.c_str(),
-                    node_ptr->public_port,
-                    (node_ptr->nat_type == kNatTypePublic)?true:false);
-            if (node_ptr->nat_type == kNatTypePublic
-                    || (node_ptr->local_ip == node_ptr->public_ip && node_ptr->local_port == node_ptr->public_port)) {
-                AddNode(node_ptr);
-            } else {
-                node_detection_ptr_->AddDetectionNode(node_ptr);
-                //SendConnectRequest(find_nodes_res.nodes(i).id(), message.src_service_type());
-                SendConnectRequest(
-                        message.src_node_id(),
-                        packet.get_from_ip_addr(),
-                        packet.get_from_ip_port(),
-                        find_nodes_res.nodes(i).id(),
-                        message.src_service_type());
-            }
+        TOP_DEBUG("find node: %s:%d public:%d",
+                node_ptr->public_ip.c_str(),
+                node_ptr->public_port,
+                (node_ptr->nat_type == kNatTypePublic)?true:false);
+        if (node_ptr->nat_type == kNatTypePublic
+                || (node_ptr->local_ip == node_ptr->public_ip && node_ptr->local_port == node_ptr->public_port)) {
+            add_nodes.push_back(node_ptr);
+            continue;
+        }
+
+        if (CanAddNode(node_ptr)) {
+            node_detection_ptr_->AddDetectionNode(node_ptr);
+            //SendConnectRequest(find_nodes_res.nodes(i).id(), message.src_service_type());
+            SendConnectRequest(
+                    message.src_node_id(),
+                    packet.get_from_ip_addr(),
+                    packet.get_from_ip_port(),
+                    find_nodes_res.nodes(i).id(),
+                    message.src_service_type());
         } // end if (CanAddNode ..
     }
+
+    if (!add_nodes.empty()) {
+        uint32_t added = AddNodes(add_nodes);
+        TOP_DEBUG_NAME("update add %u nodes from find node response(%s, %s:%d)",
+                added, HexSubstr(message.src_node_id()).c_str(),
+                packet.get_from_ip_addr().c_str(), packet.get_from_ip_port());
+    }
 }
 
 void RoutingTable::SendConnectRequest(const std::string& id, uint64_t service_type) {
@@ -1827,26 +2479,15 @@ void RoutingTable::SendDropNodeRequest(const std::string& id) {
 void RoutingTable::OnHeartbeatFailed(const std::string& ip, uint16_t port) {
     std::vector<NodeInfoPtr> failed_nodes;
     {
-        std::unique_lock<std::mutex> lock(nodes_mutex_);
-        for (auto& node : nodes_) {
-            if (node->public_ip == ip && node->public_port == port) {
-                failed_nodes.push_back(node);
-            }
+        std::unique_lock<KadMutex> lock(node_id_map_mutex_);
+        auto range = endpoint_nodes_map_.equal_range(EndpointKey(ip, port));
+        for (auto iter = range.first; iter != range.second; ++iter) {
+            failed_nodes.push_back(iter->second);
         }
     }
 
     for (auto& node : failed_nodes) {
-        DropNode(node);
-        TOP_WARN_NAME("[%ld] node heartbeat error after tried: %d times.ID:[%s],"
-                "IP:[%s],Port[%d] to ID:[%s],IP[%s],Port[%d] drop it.",
-                (long)this,
-                node->heartbeat_count,
-                HexSubstr(local_node_ptr_->id()).c_str(),
-                local_node_ptr_->local_ip().c_str(),
-                local_node_ptr_->local_port(),
-                HexSubstr(node->node_id).c_str(),
-                node->local_ip.c_str(),
-                node->local_port);
+        DropNode(node, kRoutingReasonHeartbeat);
     }
 }
 
@@ -1856,11 +2497,10 @@ void RoutingTable::HandleNodeQuit(
     if (!IsDestination(message.des_node_id(), false)) {
         return;
     }
-    NodeInfoPtr node_ptr;
-    node_ptr.reset(new NodeInfo(message.src_node_id()));
+    NodeInfoPtr node_ptr = NewNodeInfo(message.src_node_id());
     node_ptr->xid = message.xid();
     node_ptr->hash64 = base::xhash64_t::digest(node_ptr->xid);
-    DropNode(node_ptr);
+    DropNode(node_ptr, kRoutingReasonQuit);
 }
 
 void RoutingTable::HandleConnectRequest(
@@ -1878,8 +2518,7 @@ void RoutingTable::HandleConnectRequest(
         return;
     }
 
-    NodeInfoPtr node_ptr;
-    node_ptr.reset(new NodeInfo(message.src_node_id()));
+    NodeInfoPtr node_ptr = NewNodeInfo(message.src_node_id());
     node_ptr->local_ip = conn_req.local_ip();
     node_ptr->local_port = conn_req.local_port();
     node_ptr->public_ip = conn_req.public_ip();
@@ -1919,8 +2558,7 @@ void RoutingTable::HandleHandshake(
         return;
     }
 
-    NodeInfoPtr node_ptr;
-    node_ptr.reset(new NodeInfo(message.src_node_id()));
+    NodeInfoPtr node_ptr = NewNodeInfo(message.src_node_id());
     std::string pub_ip = handshake.public_ip();
     uint16_t pub_port = handshake.public_port();
     if (pub_ip.empty()) {
@@ -1945,6 +2583,12 @@ void RoutingTable::HandleHandshake(
             node_ptr->same_vlan = true;
         }
 
+        // sample on the stored node if the peer is in the table already
+        if (FindLocalNode(message.src_node_id())) {
+            UpdateNodeRtt(message, nullptr);
+        } else {
+            UpdateNodeRtt(message, node_ptr);
+        }
         if (!message.has_client_msg() || !message.client_msg()) {
             if (AddNode(node_ptr) == kKadSuccess) {
                 TOP_DEBUG_NAME("update add_node(%s) from handshake(%s, %s:%d)",
@@ -2007,6 +2651,22 @@ void RoutingTable::HandleBootstrapJoinRequest(
         base::xpacket_t& packet) {
     TOP_DEBUG_NAME("HandleBootstrapJoinRequest from %s:%d",
         packet.get_from_ip_addr().c_str(), (int)packet.get_from_ip_port());
+    if (join_limiter_) {
+        uint32_t retry_after_ms = 0;
+        int admit = join_limiter_->Admit(
+                packet.get_from_ip_addr(),
+                packet.get_from_ip_port(),
+                Now(),
+                retry_after_ms);
+        if (admit == kJoinRetryLater) {
+            SendBootstrapJoinRetryLater(message, packet, retry_after_ms);
+            return;
+        }
+        if (admit == kJoinDrop) {
+            return;
+        }
+    }
+
     bool allow_add = true;
     if (!message.has_data() || message.data().empty()) {
         TOP_INFO_NAME("HandleBootstrapJoinRequest request in data is empty.");
@@ -2019,8 +2679,7 @@ void RoutingTable::HandleBootstrapJoinRequest(
         return;
     }
 
-    NodeInfoPtr node_ptr;
-    node_ptr.reset(new NodeInfo(message.src_node_id()));
+    NodeInfoPtr node_ptr = NewNodeInfo(message.src_node_id());
     node_ptr->local_ip = join_req.local_ip();
     node_ptr->local_port = join_req.local_port();
     node_ptr->public_ip = packet.get_from_ip_addr();
@@ -2052,26 +2711,16 @@ void RoutingTable::SendBootstrapJoinResponse(
         base::xpacket_t& packet) {
     TOP_DEBUG_NAME("SendBootstrapJoinResponse to (%s:%d)",
         packet.get_from_ip_addr().c_str(), (int)packet.get_from_ip_port());
-    transport::protobuf::RoutingMessage res_message;
-    // TODO(smaug) message.des_service_type maybe not equal the service_type of this routing table
-    SetFreqMessage(res_message);
-    res_message.set_src_service_type(message.des_service_type());
-    res_message.set_des_service_type(message.src_service_type());
-    res_message.set_des_node_id(message.src_node_id());
-    res_message.set_type(kKadBootstrapJoinResponse);
-    res_message.set_id(message.id());
-    message.set_priority(enum_xpacket_priority_type_flash);
-    res_message.set_debug("join res");
-    res_message.set_status(message.status());
-    if (message.has_client_msg() && message.client_msg()) {
-        res_message.set_client_msg(true);
+    if (packet.get_from_ip_addr().empty() || packet.get_from_ip_port() <= 0) {
+        TOP_WARN_NAME("join node [%s] get public ip or public port failed!",
+            HexSubstr(message.src_node_id()).c_str());
+        return;
     }
 
+    // just the per-joiner fields, the rest comes from the template
     protobuf::BootstrapJoinResponse join_res;
     join_res.set_public_ip(packet.get_from_ip_addr());
     join_res.set_public_port(packet.get_from_ip_port());
-    join_res.set_xid(global_xid->Get());
-    join_res.set_xip(local_node_ptr_->xip());
 
     // dispatch dynamic xip for bootstrap node TODO(smaug) may be just for client
     if (message.has_client_msg() && message.client_msg()) {
@@ -2085,27 +2734,136 @@ void RoutingTable::SendBootstrapJoinResponse(
                 HexEncode(dy_xip).c_str(),
                 packet.get_from_ip_addr().c_str(),
                 packet.get_from_ip_port());
+    } else {
+        // give the joiner its first neighbours now, saves a find nodes round-trip
+        protobuf::FindClosestNodesResponse find_nodes_res;
+        GetClosestNodesResponse(
+                message.src_node_id(),
+                kJoinResponseClosestNodesMaxBytes,
+                find_nodes_res);
+        if (find_nodes_res.nodes_size() > 0) {
+            std::string closest_nodes;
+            if (find_nodes_res.SerializeToString(&closest_nodes)) {
+                join_res.set_closest_nodes(closest_nodes);
+            }
+        }
     }
 
-    if (join_res.public_ip().empty() || join_res.public_port() <= 0) {
-        TOP_WARN_NAME("join node [%s] get public ip or public port failed!",
-            HexSubstr(message.src_node_id()).c_str());
-        return;
+    SendJoinResponseFromTemplate(message, packet, join_res);
+}
+
+void RoutingTable::SetJoinLimits(uint32_t max_per_second, uint32_t source_burst) {
+    if (join_limiter_) {
+        join_limiter_->SetLimits(max_per_second, source_burst);
+    }
+}
+
+void RoutingTable::SendBootstrapJoinRetryLater(
+        transport::protobuf::RoutingMessage& message,
+        base::xpacket_t& packet,
+        uint32_t retry_after_ms) {
+    TOP_DEBUG_NAME("bootstrap overloaded, %s:%d retry after %u ms",
+        packet.get_from_ip_addr().c_str(), (int)packet.get_from_ip_port(), retry_after_ms);
+    // not the join template: joiners that do not know retry_after_ms would take
+    // it for a join without a public endpoint. they drop forbidden replies, and
+    // the reply stays smaller than the request
+    transport::protobuf::RoutingMessage res_message;
+    SetFreqMessage(res_message);
+    res_message.set_src_service_type(message.des_service_type());
+    res_message.set_des_service_type(message.src_service_type());
+    res_message.set_des_node_id(message.src_node_id());
+    res_message.set_type(kKadBootstrapJoinResponse);
+    res_message.set_id(message.id());
+    res_message.set_status(kKadForbidden);
+    if (message.has_client_msg() && message.client_msg()) {
+        res_message.set_client_msg(true);
     }
 
-    join_res.set_bootstrap_id(local_node_ptr_->id());
-    join_res.set_nat_type(local_node_ptr_->nat_type());
+    protobuf::BootstrapJoinResponse join_res;
+    join_res.set_retry_after_ms(retry_after_ms);
     std::string data;
     if (!join_res.SerializeToString(&data)) {
-        TOP_INFO_NAME("ConnectResponse SerializeToString failed!");
+        TOP_INFO_NAME("BootstrapJoinResponse SerializeToString failed!");
         return;
     }
 
     res_message.set_data(data);
-    SendData(
-        res_message,
+    SendData(res_message, packet.get_from_ip_addr(), packet.get_from_ip_port());
+}
+
+void RoutingTable::GetJoinResponseTemplate(std::string& msg_template, std::string& res_template) {
+    std::unique_lock<KadMutex> lock(join_template_mutex_);
+    auto now = Now();
+    if (join_msg_template_.empty() ||
+            now - join_template_time_ >= std::chrono::milliseconds(kJoinTemplateRefreshMs)) {
+        // TODO(smaug) message.des_service_type maybe not equal the service_type of this routing table
+        transport::protobuf::RoutingMessage res_message;
+        SetFreqMessage(res_message);
+        res_message.set_type(kKadBootstrapJoinResponse);
+        res_message.set_debug("join res");
+        SetVersion(res_message);
+
+        protobuf::BootstrapJoinResponse join_res;
+        join_res.set_xid(global_xid->Get());
+        join_res.set_xip(local_node_ptr_->xip());
+        join_res.set_bootstrap_id(local_node_ptr_->id());
+        join_res.set_nat_type(local_node_ptr_->nat_type());
+
+        std::string msg_data;
+        std::string res_data;
+        if (!res_message.SerializePartialToString(&msg_data) ||
+                !join_res.SerializeToString(&res_data)) {
+            TOP_WARN_NAME("join response template SerializeToString failed!");
+        } else {
+            join_msg_template_.swap(msg_data);
+            join_res_template_.swap(res_data);
+            join_template_time_ = now;
+        }
+    }
+
+    msg_template = join_msg_template_;
+    res_template = join_res_template_;
+}
+
+int RoutingTable::SendJoinResponseFromTemplate(
+        transport::protobuf::RoutingMessage& message,
+        base::xpacket_t& packet,
+        const protobuf::BootstrapJoinResponse& join_res) {
+    std::string msg;
+    std::string data;
+    GetJoinResponseTemplate(msg, data);
+    if (msg.empty() || data.empty()) {
+        return kKadFailed;
+    }
+
+    // fields serialized after the template override the template ones when parsed
+    if (!join_res.AppendToString(&data)) {
+        TOP_INFO_NAME("BootstrapJoinResponse SerializeToString failed!");
+        return kKadFailed;
+    }
+
+    transport::protobuf::RoutingMessage res_message;
+    res_message.set_src_service_type(message.des_service_type());
+    res_message.set_des_service_type(message.src_service_type());
+    res_message.set_des_node_id(message.src_node_id());
+    res_message.set_id(message.id());
+    res_message.set_status(message.status());
+    if (message.has_client_msg() && message.client_msg()) {
+        res_message.set_client_msg(true);
+    }
+    res_message.set_data(data);
+    if (!res_message.AppendPartialToString(&msg)) {
+        TOP_INFO_NAME("RoutingMessage SerializeToString failed!");
+        return kKadFailed;
+    }
+
+    xbyte_buffer_t buffer{msg.begin(), msg.end()};
+    return SendData(
+        buffer,
         packet.get_from_ip_addr(),
-        packet.get_from_ip_port());
+        packet.get_from_ip_port(),
+        enum_xpacket_priority_type_routine,
+        kKadBootstrapJoinResponse);
 }
 
 void RoutingTable::HandleBootstrapJoinResponse(
@@ -2132,14 +2890,24 @@ void RoutingTable::HandleBootstrapJoinResponse(
         return;
     }
 
+    // retry-later replies are forbidden ones too
+    if (join_res.has_retry_after_ms() && join_res.retry_after_ms() > 0) {
+        TOP_INFO_NAME("bootstrap %s:%d overloaded, retry after %u ms",
+            packet.get_from_ip_addr().c_str(), (int)packet.get_from_ip_port(),
+            join_res.retry_after_ms());
+        if (join_res.retry_after_ms() > join_retry_after_ms_) {
+            join_retry_after_ms_ = join_res.retry_after_ms();
+        }
+        return;
+    }
+
     if(kadmlia::kKadForbidden == message.status()) {
         TOP_INFO_NAME("BootstrapJoin Request Is Forbidden.");
         return;
     }
 
 
-    NodeInfoPtr node_ptr;
-    node_ptr.reset(new NodeInfo(message.src_node_id()));
+    NodeInfoPtr node_ptr = NewNodeInfo(message.src_node_id());
     node_ptr->local_ip = packet.get_from_ip_addr();
     node_ptr->local_port = packet.get_from_ip_port();
     node_ptr->public_ip = packet.get_from_ip_addr();
@@ -2151,9 +2919,8 @@ void RoutingTable::HandleBootstrapJoinResponse(
     node_ptr->xip = join_res.xip();
 
     {
-        std::unique_lock<std::mutex> lock(joined_mutex_);
-        local_node_ptr_->set_public_ip(join_res.public_ip());
-        local_node_ptr_->set_public_port(join_res.public_port());
+        std::unique_lock<KadMutex> lock(joined_mutex_);
+        local_node_ptr_->set_public_endpoint(join_res.public_ip(), join_res.public_port());
         // TODO(smaug) just set dynamic xip for real client
         if (local_node_ptr_->client_mode()) {
             local_node_ptr_->AddDxip(message.src_node_id(), join_res.dxip());
@@ -2163,7 +2930,7 @@ void RoutingTable::HandleBootstrapJoinResponse(
     }
     int ret = AddNode(node_ptr);
     {
-        std::unique_lock<std::mutex> bootstrap_lock(bootstrap_nodes_mutex_);
+        std::unique_lock<KadMutex> bootstrap_lock(bootstrap_nodes_mutex_);
         bootstrap_nodes_.push_back(node_ptr);
         TOP_INFO("add bootstrap node success. id:%s ip:%s port:%d", HexEncode(node_ptr->node_id).c_str(), (node_ptr->public_ip).c_str(), node_ptr->public_port);
     }
@@ -2178,6 +2945,18 @@ void RoutingTable::HandleBootstrapJoinResponse(
                 packet.get_from_ip_addr().c_str(), packet.get_from_ip_port());
     }
 
+    // the closest nodes are useful even when this node joined already
+    if (join_res.has_closest_nodes() && !join_res.closest_nodes().empty()) {
+        protobuf::FindClosestNodesResponse find_nodes_res;
+        if (find_nodes_res.ParseFromString(join_res.closest_nodes())) {
+            TOP_DEBUG_NAME("BootstrapJoinResponse carry %d closest nodes",
+                    find_nodes_res.nodes_size());
+            HandleClosestNodes(find_nodes_res, message, packet);
+        } else {
+            TOP_WARN_NAME("BootstrapJoinResponse closest_nodes ParseFromString failed!");
+        }
+    }
+
     if (!SetJoin(
             join_res.bootstrap_id(),
             packet.get_from_ip_addr(),
@@ -2233,6 +3012,79 @@ void RoutingTable::HandleHeartbeatResponse(
     ResetNodeHeartbeat(message.src_node_id());
 }
 
+void RoutingTable::AddRttRequest(uint32_t message_id, int message_type) {
+    rtt_sampler_->Sent(message_id, message_type, Now());
+}
+
+void RoutingTable::UpdateNodeRtt(
+        const transport::protobuf::RoutingMessage& message,
+        NodeInfoPtr node_ptr) {
+    uint32_t rtt_ms = 0;
+    if (!rtt_sampler_->Received(message.id(), Now(), rtt_ms)) {
+        return;
+    }
+
+    // a given node is not in the table yet(handshake)
+    bool in_table = !node_ptr;
+    if (!node_ptr) {
+        node_ptr = FindLocalNode(message.src_node_id());
+        if (!node_ptr) {
+            return;
+        }
+    }
+    node_ptr->UpdateRtt(rtt_ms);
+    if (in_table) {
+        node_event_dispatcher_->Publish(kNodeEventUpdated, node_ptr, generation_);
+    }
+    TOP_DEBUG_NAME("rtt of %s:%d sample(%u) smoothed(%u)",
+            node_ptr->public_ip.c_str(), (int)node_ptr->public_port,
+            rtt_ms, node_ptr->rtt_ms.load(std::memory_order_relaxed));
+}
+
+uint32_t RoutingTable::SubscribeNodeEvents(NodeEventCallback callback) {
+    return node_event_dispatcher_->Subscribe(callback);
+}
+
+void RoutingTable::UnsubscribeNodeEvents(uint32_t subscription_id) {
+    node_event_dispatcher_->Unsubscribe(subscription_id);
+}
+
+void RoutingTable::DispatchNodeEvents() {
+    if (destroy_) {
+        return;
+    }
+    node_event_dispatcher_->Dispatch();
+}
+
+void RoutingTable::OnPublicNodeEvent(const NodeEvent& event) {
+    if (event.type == kNodeEventResync) {
+        // from nodes_ itself, AddNode and DropNode reset GetUnLockNodes() for a moment
+        std::vector<NodeInfoPtr> all_nodes = nodes();
+        std::unique_lock<KadMutex> lock(public_nodes_mutex_);
+        public_nodes_.clear();
+        for (auto& node_ptr : all_nodes) {
+            if (node_ptr->IsPublicNode()) {
+                public_nodes_[node_ptr->node_id] = node_ptr;
+            }
+        }
+        return;
+    }
+
+    std::unique_lock<KadMutex> lock(public_nodes_mutex_);
+    switch (event.type) {
+    case kNodeEventAdded:
+        if (event.node->IsPublicNode()) {
+            public_nodes_[event.node->node_id] = event.node;
+        }
+        break;
+    case kNodeEventDropped:
+        public_nodes_.erase(event.node->node_id);
+        break;
+    default:
+        break;
+    }
+}
+
 void RoutingTable::SupportSecurityJoin() {
     security_join_ptr_.reset(new security::XSecurityJoin(timer_manager_));
 }
@@ -2367,10 +3219,9 @@ void RoutingTable::SmartSendReply(transport::protobuf::RoutingMessage& res_messa
 bool RoutingTable::StartBootstrapCacheSaver() {
     auto get_public_nodes = [this](std::vector<NodeInfoPtr>& nodes) {
         {
-            std::unique_lock<std::mutex> lock(nodes_mutex_);
-            for (auto& node_ptr : nodes_) {
-                if (node_ptr->IsPublicNode())
-                    nodes.push_back(node_ptr);
+            std::unique_lock<KadMutex> lock(public_nodes_mutex_);
+            for (auto& item : public_nodes_) {
+                nodes.push_back(item.second);
             }
         }
 
@@ -2434,24 +3285,24 @@ void RoutingTable::SetSpeClientMessage(transport::protobuf::RoutingMessage& mess
 
 
 uint32_t RoutingTable::AddHeartbeatInfo(const std::string& key, const std::string& value) {
-    std::unique_lock<std::mutex> lock(heart_beat_info_map_mutex_);
+    std::unique_lock<KadMutex> lock(heart_beat_info_map_mutex_);
     heart_beat_info_map_[key] = value;
     return heart_beat_info_map_.size();
 }
 
 void RoutingTable::ClearHeartbeatInfo() {
-    std::unique_lock<std::mutex> lock(heart_beat_info_map_mutex_);
+    std::unique_lock<KadMutex> lock(heart_beat_info_map_mutex_);
     heart_beat_info_map_.clear();
 }
 
 void RoutingTable::RegisterHeartbeatInfoCallback(on_heart_beat_info_receive_callback_t heart_beat_callback) {
-    std::unique_lock<std::mutex> lock(heart_beat_info_map_mutex_);
+    std::unique_lock<KadMutex> lock(heart_beat_info_map_mutex_);
     assert(heart_beat_callback_ == nullptr);
     heart_beat_callback_ = heart_beat_callback;
 }
 
 void RoutingTable::UnRegisterHeartbeatInfoCallback() {
-    std::unique_lock<std::mutex> lock(heart_beat_info_map_mutex_);
+    std::unique_lock<KadMutex> lock(heart_beat_info_map_mutex_);
     heart_beat_callback_ = nullptr;
 }
 
@@ -0,0 +1,207 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "xkad/routing_table/rpc_stats.h"
+
+#include <stdio.h>
+
+namespace top {
+
+namespace kadmlia {
+
+static uint32_t FloorLog2(uint64_t value) {
+    uint32_t log2 = 0;
+    while (value > 1) {
+        value >>= 1;
+        ++log2;
+    }
+    return log2;
+}
+
+RpcLatencyHistogram::RpcLatencyHistogram() : count_(0), sum_(0), max_(0) {
+    for (auto& bucket : buckets_) {
+        bucket = 0;
+    }
+}
+
+uint32_t RpcLatencyHistogram::BucketIndex(uint64_t value_us) {
+    if (value_us < 2 * kRpcHistogramSubBuckets) {
+        return static_cast<uint32_t>(value_us);
+    }
+    // value >> shift keeps the 5 leading bits, 16..31
+    const uint32_t shift = FloorLog2(value_us) - 4;
+    const uint32_t index = (shift + 1) * kRpcHistogramSubBuckets
+            + static_cast<uint32_t>(value_us >> shift) - kRpcHistogramSubBuckets;
+    return index < kRpcHistogramBuckets ? index : kRpcHistogramBuckets - 1;
+}
+
+uint64_t RpcLatencyHistogram::BucketHighest(uint32_t index) {
+    if (index < 2 * kRpcHistogramSubBuckets) {
+        return index;
+    }
+    const uint32_t shift = index / kRpcHistogramSubBuckets - 1;
+    const uint64_t mantissa = index % kRpcHistogramSubBuckets + kRpcHistogramSubBuckets;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void RpcLatencyHistogram::Record(uint64_t value_us) {
+    buckets_[BucketIndex(value_us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value_us, std::memory_order_relaxed);
+    uint64_t old_max = max_.load(std::memory_order_relaxed);
+    while (value_us > old_max && !max_.compare_exchange_weak(old_max, value_us, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t RpcLatencyHistogram::Percentile(double percent) const {
+    uint64_t total = 0;
+    for (auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const double rank = total * percent / 100.0;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kRpcHistogramBuckets; ++i) {
+        const uint64_t count = buckets_[i].load(std::memory_order_relaxed);
+        seen += count;
+        if (count > 0 && seen >= rank) {
+            return BucketHighest(i);
+        }
+    }
+    return BucketHighest(kRpcHistogramBuckets - 1);
+}
+
+uint64_t RpcLatencyHistogram::count() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t RpcLatencyHistogram::sum() const {
+    return sum_.load(std::memory_order_relaxed);
+}
+
+uint64_t RpcLatencyHistogram::max() const {
+    return max_.load(std::memory_order_relaxed);
+}
+
+void RpcLatencyHistogram::Reset() {
+    for (auto& bucket : buckets_) {
+        bucket = 0;
+    }
+    count_ = 0;
+    sum_ = 0;
+    max_ = 0;
+}
+
+RpcStats::RpcStats() : entries_(), entries_mutex_() {}
+
+RpcStats::~RpcStats() {}
+
+RpcStats::Entry* RpcStats::GetEntry(int type) {
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    auto& entry = entries_[type];
+    if (!entry) {
+        entry.reset(new Entry());
+    }
+    return entry.get();
+}
+
+void RpcStats::OnRequest(int type) {
+    GetEntry(type)->requests.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RpcStats::OnResponse(int type, uint64_t rtt_us) {
+    GetEntry(type)->rtt.Record(rtt_us);
+}
+
+void RpcStats::OnTimeout(int type) {
+    GetEntry(type)->timeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RpcStats::OnLateResponse(int type) {
+    GetEntry(type)->late_responses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RpcStats::OnCancel(int type) {
+    GetEntry(type)->cancelled.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RpcStats::GetInfo(int type, Entry& entry, RpcStatsInfo& info) {
+    info.type = type;
+    info.requests = entry.requests.load(std::memory_order_relaxed);
+    info.responses = entry.rtt.count();
+    info.timeouts = entry.timeouts.load(std::memory_order_relaxed);
+    info.late_responses = entry.late_responses.load(std::memory_order_relaxed);
+    info.cancelled = entry.cancelled.load(std::memory_order_relaxed);
+    info.mean_us = info.responses == 0 ? 0 : entry.rtt.sum() / info.responses;
+    info.p50_us = entry.rtt.Percentile(50);
+    info.p90_us = entry.rtt.Percentile(90);
+    info.p99_us = entry.rtt.Percentile(99);
+    info.p999_us = entry.rtt.Percentile(99.9);
+    info.max_us = entry.rtt.max();
+}
+
+void RpcStats::Get(std::vector<RpcStatsInfo>& infos) {
+    infos.clear();
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    for (auto& item : entries_) {
+        RpcStatsInfo info;
+        GetInfo(item.first, *item.second, info);
+        infos.push_back(info);
+    }
+}
+
+bool RpcStats::Get(int type, RpcStatsInfo& info) {
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    auto iter = entries_.find(type);
+    if (iter == entries_.end()) {
+        return false;
+    }
+    GetInfo(type, *iter->second, info);
+    return true;
+}
+
+std::string RpcStats::Dump() {
+    std::vector<RpcStatsInfo> infos;
+    Get(infos);
+    std::string result;
+    char line[256];
+    snprintf(line, sizeof(line), "%6s %10s %10s %9s %6s %9s %9s %9s %9s %9s %10s\n",
+            "type", "requests", "responses", "timeouts", "late", "cancelled",
+            "mean_us", "p50_us", "p99_us", "p999_us", "max_us");
+    result += line;
+    for (auto& info : infos) {
+        snprintf(line, sizeof(line), "%6d %10llu %10llu %9llu %6llu %9llu %9llu %9llu %9llu %9llu %10llu\n",
+                info.type,
+                (unsigned long long)info.requests,
+                (unsigned long long)info.responses,
+                (unsigned long long)info.timeouts,
+                (unsigned long long)info.late_responses,
+                (unsigned long long)info.cancelled,
+                (unsigned long long)info.mean_us,
+                (unsigned long long)info.p50_us,
+                (unsigned long long)info.p99_us,
+                (unsigned long long)info.p999_us,
+                (unsigned long long)info.max_us);
+        result += line;
+    }
+    return result;
+}
+
+void RpcStats::Reset() {
+    std::unique_lock<std::mutex> lock(entries_mutex_);
+    for (auto& item : entries_) {
+        item.second->requests = 0;
+        item.second->timeouts = 0;
+        item.second->late_responses = 0;
+        item.second->cancelled = 0;
+        item.second->rtt.Reset();
+    }
+}
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -4,6 +4,8 @@
 
 #include "xkad/gossip/rumor_filter.h"
 
+#include <algorithm>
+
 #include "xkad/gossip/rumor_def.h"
 #include "xkad/routing_table/routing_utils.h"
 #include "xpbase/base/top_log.h"
@@ -16,6 +18,26 @@ RumorFilter* RumorFilter::Instance() {
     return &ins;
 }
 
+RumorFilter::RumorFilter() {
+    memory_reporter_id_ = kadmlia::MemoryStats::Instance()->Register(
+            [this](std::vector<kadmlia::MemoryUsage>& usages) {
+        kadmlia::MemoryUsage usage;
+        GetMemoryUsage(usage);
+        usages.push_back(usage);
+    });
+}
+
+RumorFilter::~RumorFilter() {
+    kadmlia::MemoryStats::Instance()->Unregister(memory_reporter_id_);
+}
+
+void RumorFilter::GetMemoryUsage(kadmlia::MemoryUsage& usage) {
+    const uint64_t capacity = (uint64_t)kDefaultFilterSize * kRepeatedValueNum;
+    usage.name = "rumor_filter";
+    usage.entries = std::min(added_count_.load(std::memory_order_relaxed), capacity);
+    usage.bytes = std::max((uint64_t)sizeof(RumorFilter), capacity * sizeof(uint32_t));
+}
+
 bool RumorFilter::FiltMessage(
     transport::protobuf::RoutingMessage& message) {
     auto gossip = message.gossip();
@@ -32,6 +54,7 @@ bool RumorFilter::FiltMessage(
                 gossip.msg_hash());
         return true;
     }
+    added_count_.fetch_add(1, std::memory_order_relaxed);
     return false;
 }
 
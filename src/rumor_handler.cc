@@ -26,12 +26,22 @@ bool RumorHandler::Init(
         return false;
     }
     kad_routing_table_ = kad_routing_table;
+    node_events_subscription_ = kad_routing_table_->SubscribeNodeEvents(
+            std::bind(&RumorHandler::OnNodeEvent, this, std::placeholders::_1));
+    ResyncNeighbors();
     inited_ = true;
     TOP_DEBUG("RumorHandler::Init Success.");
     return true;
 }
 
 bool RumorHandler::UnInit() {
+    if (kad_routing_table_) {
+        kad_routing_table_->UnsubscribeNodeEvents(node_events_subscription_);
+    }
+    {
+        std::unique_lock<std::mutex> lock(neighbors_mutex_);
+        neighbors_.clear();
+    }
     kad_routing_table_.reset();
     inited_ = false;
     return true;
@@ -71,36 +81,69 @@ void RumorHandler::GetAllRumorMessage(
 
 void RumorHandler::GetAllNeighborNodes(
     std::vector<kadmlia::NodeInfoPtr>& all_neighbors) {
-    auto local_node_info_ptr = kad_routing_table_->get_local_node_info();
-    if (!local_node_info_ptr) {
-        TOP_WARN("kadmlia::LocalNodeInfo is invalid");
-        return;
-    }
-    std::string node_id = local_node_info_ptr->id();
-    auto tmp_all_neighbors = kad_routing_table_->nodes();
+    std::unique_lock<std::mutex> lock(neighbors_mutex_);
     if (!just_root_) {
-        all_neighbors.swap(tmp_all_neighbors);
+        for (auto& item : neighbors_) {
+            all_neighbors.push_back(item.second);
+        }
         return;
     }
 
+    // one node per root xid
     std::set<std::string> getted_nodes;
-    for (auto iter = tmp_all_neighbors.begin(); iter != tmp_all_neighbors.end(); ++iter) {
-        if ((*iter)->xid.empty()) {
+    for (auto& item : neighbors_) {
+        if (!getted_nodes.insert(item.second->xid).second) {
             continue;
         }
+        all_neighbors.push_back(item.second);
+    }
+}
 
-        base::KadmliaKeyPtr xid = base::GetKadmliaKey((*iter)->xid);
-        if (xid->xnetwork_id() != kRoot) {
-            continue;
+bool RumorHandler::IsNeighbor(kadmlia::NodeInfoPtr node) {
+    if (!just_root_) {
+        return true;
+    }
+    if (node->xid.empty()) {
+        return false;
+    }
+    base::KadmliaKeyPtr xid = base::GetKadmliaKey(node->xid);
+    return xid->xnetwork_id() == kRoot;
+}
+
+void RumorHandler::OnNodeEvent(const kadmlia::NodeEvent& event) {
+    switch (event.type) {
+    case kadmlia::kNodeEventAdded:
+        if (IsNeighbor(event.node)) {
+            std::unique_lock<std::mutex> lock(neighbors_mutex_);
+            neighbors_[event.node->node_id] = event.node;
         }
+        break;
+    case kadmlia::kNodeEventDropped: {
+        std::unique_lock<std::mutex> lock(neighbors_mutex_);
+        neighbors_.erase(event.node->node_id);
+        break;
+    }
+    case kadmlia::kNodeEventResync:
+        ResyncNeighbors();
+        break;
+    default:
+        break;
+    }
+}
 
-        auto getted_iter = getted_nodes.find((*iter)->xid);
-        if (getted_iter != getted_nodes.end()) {
-            continue;
+void RumorHandler::ResyncNeighbors() {
+    auto routing_table = kad_routing_table_;
+    if (!routing_table) {
+        return;
+    }
+    std::map<std::string, kadmlia::NodeInfoPtr> neighbors;
+    for (auto& node : routing_table->nodes()) {
+        if (IsNeighbor(node)) {
+            neighbors[node->node_id] = node;
         }
-        getted_nodes.insert((*iter)->xid);
-        all_neighbors.push_back(*iter);
     }
+    std::unique_lock<std::mutex> lock(neighbors_mutex_);
+    neighbors_.swap(neighbors);
 }
 
 void RumorHandler::SpreadNeighbors(
@@ -0,0 +1,118 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/bootstrap_join_limiter.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestBootstrapJoinLimiter : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestBootstrapJoinLimiter, SourceBurst) {
+    BootstrapJoinLimiter limiter(1000, 3);
+    auto now = std::chrono::steady_clock::now();
+    uint32_t retry_after_ms = 0;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    }
+    // a flooding source is told to come back once per retry window
+    ASSERT_EQ(kJoinRetryLater, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    ASSERT_GE(retry_after_ms, kJoinRetryAfterMinMs);
+    ASSERT_EQ(kJoinDrop, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    // other sources are not affected, peers behind one nat included
+    ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.2", 9000, now, retry_after_ms));
+    ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9001, now, retry_after_ms));
+
+    // refill one token per kJoinSourceRefillMs
+    now += std::chrono::milliseconds(kJoinSourceRefillMs);
+    ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    ASSERT_EQ(kJoinRetryLater, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    ASSERT_EQ(3u, limiter.sources_size());
+}
+
+TEST_F(TestBootstrapJoinLimiter, IpBurst) {
+    BootstrapJoinLimiter limiter(1000, 2);
+    auto now = std::chrono::steady_clock::now();
+    uint32_t retry_after_ms = 0;
+    // a fresh port does not give a fresh burst past kJoinIpSources sources
+    const uint32_t ip_burst = 2 * kJoinIpSources;
+    for (uint32_t i = 0; i < ip_burst; ++i) {
+        ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9000 + i, now, retry_after_ms));
+    }
+    ASSERT_EQ(kJoinRetryLater, limiter.Admit("10.0.0.1", 9100, now, retry_after_ms));
+    ASSERT_EQ(kJoinDrop, limiter.Admit("10.0.0.1", 9101, now, retry_after_ms));
+    ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.2", 9000, now, retry_after_ms));
+
+    // the ip bucket refills kJoinIpSources times as fast as a source one
+    now += std::chrono::milliseconds(kJoinSourceRefillMs / kJoinIpSources);
+    ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9102, now, retry_after_ms));
+}
+
+TEST_F(TestBootstrapJoinLimiter, OneJoin) {
+    // every request of one join of a node is admitted by default
+    BootstrapJoinLimiter limiter;
+    auto now = std::chrono::steady_clock::now();
+    uint32_t retry_after_ms = 0;
+    for (int i = 0; i < kJoinRetryTimes; ++i) {
+        ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    }
+}
+
+TEST_F(TestBootstrapJoinLimiter, Disabled) {
+    BootstrapJoinLimiter limiter(1, 1);
+    limiter.SetLimits(0, 0);
+    auto now = std::chrono::steady_clock::now();
+    uint32_t retry_after_ms = 0;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.0.1", 9000, now, retry_after_ms));
+    }
+    ASSERT_EQ(0u, limiter.sources_size());
+}
+
+TEST_F(TestBootstrapJoinLimiter, RetryLater) {
+    BootstrapJoinLimiter limiter(10, 1);
+    auto now = std::chrono::steady_clock::now();
+    uint32_t retry_after_ms = 0;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.1." + std::to_string(i), 9000, now, retry_after_ms));
+        ASSERT_EQ(0u, retry_after_ms);
+    }
+
+    ASSERT_EQ(kJoinRetryLater, limiter.Admit("10.0.2.1", 9000, now, retry_after_ms));
+    ASSERT_GE(retry_after_ms, kJoinRetryAfterMinMs);
+    ASSERT_LE(retry_after_ms, kJoinRetryAfterMaxMs);
+
+    // later overflow is pushed to later windows
+    uint32_t last_retry_after_ms = retry_after_ms;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(kJoinRetryLater, limiter.Admit("10.0.3." + std::to_string(i), 9000, now, retry_after_ms));
+    }
+    ASSERT_GT(retry_after_ms, last_retry_after_ms);
+
+    // next window admits again
+    now += std::chrono::milliseconds(1000);
+    ASSERT_EQ(kJoinAdmit, limiter.Admit("10.0.4.1", 9000, now, retry_after_ms));
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
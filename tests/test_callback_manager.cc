@@ -150,6 +150,41 @@ TEST_F(TestCallbackManager, Instance) {
     ASSERT_NE(nullptr, CallbackManager::Instance());
 }
 
+TEST_F(TestCallbackManager, RpcStats) {
+    CallbackManager callback_mgr;
+    auto callback = [](
+        int status, transport::protobuf::RoutingMessage & tmp_message, base::xpacket_t& packet) {};
+    top::transport::protobuf::RoutingMessage message;
+    message.set_type(kKadFindNodesResponse);
+    base::xpacket_t packet;
+
+    callback_mgr.Add(1, 5, callback, 1, kKadFindNodesRequest);
+    callback_mgr.Add(2, 5, callback, 1, kKadFindNodesRequest);
+    callback_mgr.Add(3, 5, callback, 1, kKadFindNodesRequest);
+    callback_mgr.Callback(1, message, packet);
+    callback_mgr.Timeout(2);
+    callback_mgr.Cancel(3, 1);
+    // response to the timed out request
+    callback_mgr.Callback(2, message, packet);
+    // already answered, not late
+    callback_mgr.Callback(1, message, packet);
+
+    RpcStatsInfo info;
+    ASSERT_TRUE(callback_mgr.rpc_stats().Get(kKadFindNodesRequest, info));
+    ASSERT_EQ(3u, info.requests);
+    ASSERT_EQ(1u, info.responses);
+    ASSERT_EQ(1u, info.timeouts);
+    ASSERT_EQ(1u, info.late_responses);
+    ASSERT_EQ(1u, info.cancelled);
+
+    // without a request type the response type is used
+    callback_mgr.Add(4, 5, callback, 1);
+    callback_mgr.Callback(4, message, packet);
+    ASSERT_TRUE(callback_mgr.rpc_stats().Get(kKadFindNodesResponse, info));
+    ASSERT_EQ(0u, info.requests);
+    ASSERT_EQ(1u, info.responses);
+}
+
 TEST_F(TestCallbackManager, TimeoutCheck) {
     CallbackManager callback_mgr;
     callback_mgr.TimeoutCheck();
@@ -0,0 +1,74 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/endpoint_key.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestEndpointKey : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestEndpointKey, Ipv4) {
+    EndpointKey key1("192.168.1.2", 9000);
+    EndpointKey key2("192.168.1.2", 9000);
+    EndpointKey key3("192.168.1.2", 9001);
+    EndpointKey key4("192.168.1.3", 9000);
+    ASSERT_TRUE(key1.IsIpv4());
+    ASSERT_EQ(key1, key2);
+    ASSERT_NE(key1, key3);
+    ASSERT_NE(key1, key4);
+    ASSERT_EQ(EndpointKeyHash()(key1), EndpointKeyHash()(key2));
+    ASSERT_EQ("192.168.1.2:9000", key1.string());
+
+    // ipv4-mapped ipv6 is the same endpoint
+    ASSERT_EQ(key1, EndpointKey("::ffff:192.168.1.2", 9000));
+}
+
+TEST_F(TestEndpointKey, Ipv6) {
+    EndpointKey key1("2001:db8::1", 9000);
+    ASSERT_FALSE(key1.IsIpv4());
+    ASSERT_EQ(key1, EndpointKey("2001:0db8:0000::0001", 9000));
+    ASSERT_NE(key1, EndpointKey("2001:db8::2", 9000));
+    ASSERT_EQ("2001:db8::1:9000", key1.string());
+}
+
+TEST_F(TestEndpointKey, NotIp) {
+    EndpointKey key1("abcd", 1234);
+    ASSERT_FALSE(key1.IsIpv4());
+    ASSERT_EQ(key1, EndpointKey("abcd", 1234));
+    ASSERT_NE(key1, EndpointKey("abce", 1234));
+    ASSERT_NE(EndpointKey(), EndpointKey("", 0));
+}
+
+TEST_F(TestEndpointKey, HashMap) {
+    std::unordered_map<EndpointKey, int, EndpointKeyHash> endpoint_map;
+    for (int i = 0; i < 100; ++i) {
+        endpoint_map[EndpointKey("10.0.0." + std::to_string(i), 8000)] = i;
+    }
+    ASSERT_EQ(100u, endpoint_map.size());
+    ASSERT_EQ(42, endpoint_map[EndpointKey("10.0.0.42", 8000)]);
+    ASSERT_EQ(0u, endpoint_map.count(EndpointKey("10.0.0.42", 8001)));
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,68 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/forward_cursor.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestForwardCursor : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static NodeInfoPtr CreateNode(uint8_t first_byte, uint8_t last_byte, uint32_t rtt_ms) {
+    std::string node_id(kNodeIdSize, '\x00');
+    node_id[0] = (char)first_byte;
+    node_id[kNodeIdSize - 1] = (char)last_byte;
+    auto node = std::make_shared<NodeInfo>(node_id);
+    node->rtt_ms = rtt_ms;
+    return node;
+}
+
+TEST_F(TestForwardCursor, Order) {
+    const std::string target_id(kNodeIdSize, '\x00');
+    auto node1 = CreateNode(0x01, 0x01, 100);
+    auto node2 = CreateNode(0x01, 0x02, 10);
+    auto node3 = CreateNode(0x02, 0x01, 1);
+    std::vector<NodeInfoPtr> nodes = { node1, node2, node3 };
+
+    {
+        ForwardCursor cursor(target_id, std::vector<NodeInfoPtr>(nodes), false);
+        ASSERT_EQ(3u, cursor.remaining());
+        ASSERT_EQ(node1, cursor.Next());
+        ASSERT_EQ(node2, cursor.Next());
+        ASSERT_EQ(node3, cursor.Next());
+        ASSERT_EQ(nullptr, cursor.Next());
+        ASSERT_EQ(0u, cursor.remaining());
+    }
+
+    // the faster node of the same bucket goes first, the rest keeps its order
+    {
+        ForwardCursor cursor(target_id, std::vector<NodeInfoPtr>(nodes), true);
+        ASSERT_EQ(node2, cursor.Next());
+        ASSERT_EQ(node1, cursor.Next());
+        ASSERT_EQ(node3, cursor.Next());
+        ASSERT_EQ(nullptr, cursor.Next());
+    }
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,80 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/heartbeat_manager.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestHeartbeatManager : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestHeartbeatManager, TargetedDispatch) {
+    HeartbeatManager manager;
+    int count_a = 0;
+    int count_b = 0;
+    int count_all = 0;
+    manager.RegisterSubscriber("a", [&count_a](const std::string&, uint16_t) { ++count_a; });
+    manager.RegisterSubscriber("b", [&count_b](const std::string&, uint16_t) { ++count_b; });
+    manager.Register("all", [&count_all](const std::string&, uint16_t) { ++count_all; });
+
+    manager.Subscribe("a", "10.0.0.1", 9000);
+    manager.Subscribe("a", "10.0.0.1", 9000);  // two nodes on one endpoint
+    manager.Subscribe("b", "10.0.0.2", 9000);
+
+    manager.OnHeartbeatFailed("10.0.0.1", 9000);
+    ASSERT_EQ(1, count_a);
+    ASSERT_EQ(0, count_b);
+    ASSERT_EQ(1, count_all);
+
+    manager.OnHeartbeatFailed("10.0.0.3", 9000);
+    ASSERT_EQ(1, count_a);
+    ASSERT_EQ(0, count_b);
+    ASSERT_EQ(2, count_all);
+
+    // still one node left on the endpoint
+    manager.Unsubscribe("a", "10.0.0.1", 9000);
+    manager.OnHeartbeatFailed("10.0.0.1", 9000);
+    ASSERT_EQ(2, count_a);
+    manager.Unsubscribe("a", "10.0.0.1", 9000);
+    manager.OnHeartbeatFailed("10.0.0.1", 9000);
+    ASSERT_EQ(2, count_a);
+
+    manager.Unregister("b");
+    manager.OnHeartbeatFailed("10.0.0.2", 9000);
+    ASSERT_EQ(0, count_b);
+}
+
+TEST_F(TestHeartbeatManager, UnsubscribeInCallback) {
+    HeartbeatManager manager;
+    int count = 0;
+    manager.RegisterSubscriber("a", [&manager, &count](const std::string& ip, uint16_t port) {
+        ++count;
+        manager.Unsubscribe("a", ip, port);
+    });
+    manager.Subscribe("a", "10.0.0.1", 9000);
+    manager.OnHeartbeatFailed("10.0.0.1", 9000);
+    manager.OnHeartbeatFailed("10.0.0.1", 9000);
+    ASSERT_EQ(1, count);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
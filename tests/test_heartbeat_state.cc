@@ -2,51 +2,134 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-// #include <string.h>
-
-// #include <string>
-
-// #include <gtest/gtest.h>
-// #include <unistd.h>
-
-// #include "xkad/routing_table/heartbeat_state.h"
-// #include "xkad/routing_table/routing_utils.h"
-// #include "xtransport/proto/transport.pb.h"
-// #include "xwrouter/wrouter_utils/wrouter_utils.h"
-
-// namespace top {
-
-// namespace kadmlia {
-
-// namespace test {
-
-// class TestHeartbeatState : public testing::Test {
-// public:
-//     static void SetUpTestCase() {
-
-//     }
-
-//     static void TearDownTestCase() {
-//     }
-
-//     virtual void SetUp() {
-
-//     }
-
-//     virtual void TearDown() {
-//     }
-// };
-
-// TEST_F(TestHeartbeatState, HeartbeatState) {
-//     transport::protobuf::RoutingMessage message;
-//     message.set_type(kKadHeartbeatRequest);
-//     HeartbeatState::Instance().Send(message, "1", 2);
-//     HeartbeatStateRecv::Instance().Recv(message);
-//     ::sleep(2);
-// }
-
-// }  // namespace test
-
-// }  // namespace kadmlia
-
-// }  // namespace top
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/heartbeat_state.h"
+#include "xkad/routing_table/routing_utils.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestHeartbeatState : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static bool FindInfo(HeartbeatState& state, int type, TrafficStatsInfo& info) {
+    std::vector<TrafficStatsInfo> infos;
+    state.Get(infos);
+    for (auto& item : infos) {
+        if (item.type == type) {
+            info = item;
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_F(TestHeartbeatState, Counters) {
+    HeartbeatState state;
+    state.Send(kKadHeartbeatRequest, 100);
+    state.Send(kKadHeartbeatRequest, 50);
+    state.Recv(kKadHeartbeatResponse, 70);
+    state.Send(kKadFindNodesRequest, 1000);
+    state.Recv(kKadMessageTypeMax + 100, 10);
+    state.Recv(kKadMessageTypeMax + 200, 20);
+
+    std::vector<TrafficStatsInfo> infos;
+    state.Get(infos);
+    ASSERT_EQ(3u, infos.size());
+    // the most bytes first
+    ASSERT_EQ(kKadFindNodesRequest, infos[0].type);
+
+    TrafficStatsInfo info;
+    ASSERT_TRUE(FindInfo(state, kKadHeartbeatRequest, info));
+    ASSERT_EQ(2u, info.total.sent_messages);
+    ASSERT_EQ(150u, info.total.sent_bytes);
+    ASSERT_EQ(0u, info.total.recv_messages);
+    ASSERT_TRUE(FindInfo(state, kKadHeartbeatResponse, info));
+    ASSERT_EQ(1u, info.total.recv_messages);
+    ASSERT_EQ(70u, info.total.recv_bytes);
+    // upper layer types are not counted
+    ASSERT_FALSE(FindInfo(state, kKadMessageTypeMax, info));
+    ASSERT_FALSE(FindInfo(state, kKadHandshake, info));
+
+    ASSERT_NE(std::string::npos, state.Dump().find("find_nodes_request"));
+    state.Reset();
+    state.Get(infos);
+    ASSERT_TRUE(infos.empty());
+}
+
+TEST_F(TestHeartbeatState, Windows) {
+    HeartbeatState state;
+    TrafficStatsInfo info;
+    // one message per second for 40 seconds
+    for (int i = 0; i < 40; ++i) {
+        state.Send(kKadHandshake, 10);
+        state.Tick();
+    }
+    ASSERT_TRUE(FindInfo(state, kKadHandshake, info));
+    ASSERT_EQ(40u, info.total.sent_messages);
+    for (uint32_t w = 0; w < kTrafficStatsWindowCount; ++w) {
+        ASSERT_EQ(kTrafficStatsWindows[w], info.windows[w].sent_messages);
+        ASSERT_EQ(kTrafficStatsWindows[w] * 10, info.windows[w].sent_bytes);
+    }
+
+    // traffic after the last tick is in the total only
+    state.Send(kKadHandshake, 10);
+    ASSERT_TRUE(FindInfo(state, kKadHandshake, info));
+    ASSERT_EQ(41u, info.total.sent_messages);
+    ASSERT_EQ(1u, info.windows[0].sent_messages);
+
+    // idle seconds empty the short windows first
+    for (int i = 0; i < 5; ++i) {
+        state.Tick();
+    }
+    ASSERT_TRUE(FindInfo(state, kKadHandshake, info));
+    ASSERT_EQ(0u, info.windows[0].sent_messages);
+    ASSERT_EQ(1u, info.windows[1].sent_messages);
+    ASSERT_EQ(26u, info.windows[2].sent_messages);
+}
+
+TEST_F(TestHeartbeatState, Threads) {
+    HeartbeatState state;
+    const int kThreads = 8;
+    const int kMessages = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.push_back(std::thread([&state]() {
+            for (int i = 0; i < kMessages; ++i) {
+                state.Send(kKadFindNodesResponse, 3);
+                state.Recv(kKadFindNodesResponse, 2);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    TrafficStatsInfo info;
+    ASSERT_TRUE(FindInfo(state, kKadFindNodesResponse, info));
+    ASSERT_EQ((uint64_t)kThreads * kMessages, info.total.sent_messages);
+    ASSERT_EQ((uint64_t)kThreads * kMessages * 3, info.total.sent_bytes);
+    ASSERT_EQ((uint64_t)kThreads * kMessages, info.total.recv_messages);
+    ASSERT_EQ((uint64_t)kThreads * kMessages * 2, info.total.recv_bytes);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,115 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/hop_trace.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestHopTrace : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static HopTraceRecord CreateRecord(uint64_t trace_id, uint32_t hop_num) {
+    HopTraceRecord record;
+    record.trace_id = trace_id;
+    record.arrival_us = 1000 + hop_num;
+    record.node_hash = 0x1111000000000000ull + hop_num;
+    record.next_hop_hash = 0x1111000000000000ull + hop_num + 1;
+    record.queue_delay_us = 70000;
+    record.message_type = 5;
+    record.hop_num = hop_num;
+    return record;
+}
+
+TEST_F(TestHopTrace, Sampling) {
+    HopTracer tracer(16);
+    ASSERT_FALSE(tracer.enabled());
+    ASSERT_FALSE(tracer.Sampled(0));
+    tracer.set_sample_rate(1);
+    ASSERT_TRUE(tracer.Sampled(12345));
+    tracer.set_sample_rate(4);
+    ASSERT_TRUE(tracer.Sampled(8));
+    ASSERT_FALSE(tracer.Sampled(9));
+}
+
+TEST_F(TestHopTrace, Ring) {
+    HopTracer tracer(10);  // 16 slots
+    std::vector<HopTraceRecord> records;
+    tracer.Get(records);
+    ASSERT_TRUE(records.empty());
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        tracer.Record(CreateRecord(7, i));
+    }
+    tracer.Get(records);
+    ASSERT_EQ(3u, records.size());
+    ASSERT_EQ(7u, records[2].trace_id);
+    ASSERT_EQ(2u, records[2].hop_num);
+    ASSERT_EQ(70000u, records[2].queue_delay_us);
+    ASSERT_EQ(5u, records[2].message_type);
+    ASSERT_EQ(0x1111000000000003ull, records[2].next_hop_hash);
+
+    // the oldest records are overwritten
+    for (uint32_t i = 0; i < 20; ++i) {
+        tracer.Record(CreateRecord(100 + i, i));
+    }
+    tracer.Get(records);
+    ASSERT_EQ(16u, records.size());
+    ASSERT_EQ(104u, records.front().trace_id);
+    ASSERT_EQ(119u, records.back().trace_id);
+
+    auto dump = tracer.Dump();
+    ASSERT_EQ(0u, dump.find("trace_id,"));
+    ASSERT_NE(std::string::npos, dump.find("0000000000000077,"));
+}
+
+TEST_F(TestHopTrace, Threads) {
+    HopTracer tracer(1024);
+    const int kThreads = 4;
+    const int kRecords = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.push_back(std::thread([&tracer, t]() {
+            for (int i = 0; i < kRecords; ++i) {
+                tracer.Record(CreateRecord(t, i % 100));
+            }
+        }));
+    }
+    std::vector<HopTraceRecord> records;
+    tracer.Get(records);  // while writing, only whole records
+    for (auto& record : records) {
+        ASSERT_EQ(record.node_hash + 1, record.next_hop_hash);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // a slot written late by a writer lapped by another one is skipped
+    tracer.Get(records);
+    ASSERT_LE(records.size(), 1024u);
+    ASSERT_GT(records.size(), 1000u);
+    for (auto& record : records) {
+        ASSERT_LT(record.trace_id, (uint64_t)kThreads);
+        ASSERT_EQ(1000u + record.hop_num, record.arrival_us);
+    }
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -73,6 +73,60 @@ TEST_F(TestLocalNodeInfo, All) {
     local_node_info.Reset();
 }
 
+TEST_F(TestLocalNodeInfo, IdentitySnapshot) {
+    std::string idtype(top::kadmlia::GenNodeIdType("CN", "VPN"));
+    LocalNodeInfo local_node_info;
+    ASSERT_TRUE(local_node_info.id().empty());
+    NatManagerIntf::Instance()->SetNatType(kNatTypePublic);
+    local_node_info.nat_type_ = kNatTypePublic;
+    auto kad_key = std::make_shared<base::PlatformKadmliaKey>();
+    kad_key->set_xnetwork_id(kEdgeXVPN);
+    ASSERT_TRUE(local_node_info.Init(
+            "127.0.0.1", 15943, false, false, idtype, kad_key, kEdgeXVPN, kRoleEdge));
+    ASSERT_EQ(kad_key->Get(), local_node_info.id());
+    ASSERT_EQ(local_node_info.id(), local_node_info.kad_key());
+    ASSERT_EQ("127.0.0.1", local_node_info.local_ip());
+    ASSERT_EQ(15943, local_node_info.local_port());
+    ASSERT_TRUE(local_node_info.public_ip().empty());
+    ASSERT_FALSE(local_node_info.IsPublicNode());
+
+    ASSERT_EQ(0, memcmp(
+            local_node_info.identity().id_bytes.data(),
+            kad_key->Get().data(),
+            kNodeIdSize));
+
+    // a snapshot taken before a change keeps the old values
+    const LocalIdentity& old_identity = local_node_info.identity();
+    local_node_info.set_public_endpoint("127.0.0.1", 15943);
+    ASSERT_TRUE(old_identity.public_ip.empty());
+    ASSERT_EQ(0, old_identity.public_port);
+    ASSERT_EQ("127.0.0.1", local_node_info.public_ip());
+    ASSERT_EQ(15943, local_node_info.public_port());
+    ASSERT_TRUE(local_node_info.IsPublicNode());
+    ASSERT_EQ(kad_key->Get(), local_node_info.identity().id);
+    ASSERT_EQ(old_identity.id_bytes, local_node_info.identity().id_bytes);
+
+    // an unchanged value publishes nothing
+    const LocalIdentity* identity = &local_node_info.identity();
+    auto retired_size = local_node_info.retired_identities_.size();
+    local_node_info.set_public_endpoint("127.0.0.1", 15943);
+    local_node_info.set_public_port(15943);
+    ASSERT_EQ(identity, &local_node_info.identity());
+    ASSERT_EQ(retired_size, local_node_info.retired_identities_.size());
+
+    // replaced snapshots are freed a grace period after the change
+    for (auto& retired : local_node_info.retired_identities_) {
+        retired.retired_time -= std::chrono::milliseconds(kLocalIdentityGraceMs);
+    }
+    local_node_info.set_public_port(15944);
+    ASSERT_EQ(1u, local_node_info.retired_identities_.size());
+    ASSERT_EQ(identity, local_node_info.retired_identities_.front().identity.get());
+
+    local_node_info.Reset();
+    ASSERT_TRUE(local_node_info.id().empty());
+    ASSERT_TRUE(local_node_info.public_ip().empty());
+}
+
 TEST_F(TestLocalNodeInfo, set_xip) {
     
 }
@@ -0,0 +1,119 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/lock_stats.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestLockStats : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static bool FindInfo(const std::string& name, LockStatsInfo& info) {
+    std::vector<LockStatsInfo> infos;
+    LockStats::Instance()->GetAll(infos);
+    for (auto& item : infos) {
+        if (item.name == name) {
+            info = item;
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_F(TestLockStats, Percentile) {
+    std::vector<uint64_t> histogram(kLockStatsBuckets, 0);
+    ASSERT_EQ(0u, LockStatsPercentileNs(histogram, 99));
+    histogram[3] = 99;
+    histogram[10] = 1;
+    ASSERT_EQ(16u, LockStatsPercentileNs(histogram, 50));
+    ASSERT_EQ(16u, LockStatsPercentileNs(histogram, 99));
+    ASSERT_EQ(2048u, LockStatsPercentileNs(histogram, 100));
+}
+
+TEST_F(TestLockStats, Uncontended) {
+    const std::string name = "TestLockStats::Uncontended";
+    InstrumentedMutex mutex(name.c_str());
+    LockStats::Instance()->GetEntry(name)->Reset();
+    for (int i = 0; i < 10; ++i) {
+        std::unique_lock<InstrumentedMutex> lock(mutex);
+    }
+    ASSERT_TRUE(mutex.try_lock());
+    ASSERT_FALSE(mutex.try_lock());
+    mutex.unlock();
+
+    LockStatsInfo info;
+    ASSERT_TRUE(FindInfo(name, info));
+    ASSERT_EQ(11u, info.acquisitions);
+    ASSERT_EQ(0u, info.contended);
+    ASSERT_EQ(kLockStatsBuckets, info.wait_histogram.size());
+    uint64_t holds = 0;
+    for (auto count : info.hold_histogram) {
+        holds += count;
+    }
+    ASSERT_EQ(11u, holds);
+
+    // a second lock of the same name shares the entry
+    InstrumentedMutex other(name.c_str());
+    {
+        std::lock_guard<InstrumentedMutex> lock(other);
+    }
+    ASSERT_TRUE(FindInfo(name, info));
+    ASSERT_EQ(12u, info.acquisitions);
+
+    LockStats::Instance()->Reset();
+    ASSERT_TRUE(FindInfo(name, info));
+    ASSERT_EQ(0u, info.acquisitions);
+    ASSERT_EQ(0u, info.hold_ns);
+}
+
+TEST_F(TestLockStats, Contended) {
+    const std::string name = "TestLockStats::Contended";
+    InstrumentedMutex mutex(name.c_str());
+    LockStats::Instance()->GetEntry(name)->Reset();
+
+    std::atomic<bool> locked(false);
+    std::thread holder([&]() {
+        std::unique_lock<InstrumentedMutex> lock(mutex);
+        locked = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    });
+    while (!locked) {
+        std::this_thread::yield();
+    }
+    {
+        std::unique_lock<InstrumentedMutex> lock(mutex);
+    }
+    holder.join();
+
+    LockStatsInfo info;
+    ASSERT_TRUE(FindInfo(name, info));
+    ASSERT_EQ(2u, info.acquisitions);
+    ASSERT_EQ(1u, info.contended);
+    ASSERT_GE(info.max_hold_ns, 40u * 1000 * 1000);
+    ASSERT_GT(info.max_wait_ns, 0u);
+    ASSERT_NE(std::string::npos, LockStats::Instance()->Dump().find(name));
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,180 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "xbase/xpacket.h"
+#include "xtransport/proto/transport.pb.h"
+#include "xkad/routing_table/routing_utils.h"
+#include "xkad/sim/loopback_network.h"
+#include "xkad/sim/loopback_transport.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestLoopbackNetwork : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestLoopbackNetwork, Latency) {
+    uint64_t now_ms = 1000;
+    LoopbackNetwork network(1, [&now_ms]() { return now_ms; });
+    LoopbackLink link;
+    link.latency_ms = 50;
+    network.set_default_link(link);
+
+    std::vector<std::string> received;
+    ASSERT_TRUE(network.Register("10.0.0.1", 1000, kNatTypePublic, nullptr));
+    ASSERT_TRUE(network.Register("10.0.0.2", 1000, kNatTypePublic,
+            [&received](const std::string& ip, uint16_t port, const std::string& data) {
+        received.push_back(ip + ":" + std::to_string(port) + " " + data);
+    }));
+    ASSERT_FALSE(network.Register("10.0.0.2", 1000, kNatTypePublic, nullptr));
+
+    ASSERT_EQ(kKadSuccess, network.Send("10.0.0.1", 1000, "10.0.0.2", 1000, "a"));
+    ASSERT_EQ(kKadSuccess, network.Send("10.0.0.1", 1000, "10.0.0.2", 1000, "b"));
+    ASSERT_EQ(0u, network.Deliver());
+    uint64_t deliver_ms = 0;
+    ASSERT_TRUE(network.NextDeliveryMs(deliver_ms));
+    ASSERT_EQ(1050u, deliver_ms);
+
+    now_ms = 1050;
+    ASSERT_EQ(2u, network.Deliver());
+    ASSERT_EQ(2u, received.size());
+    ASSERT_EQ("10.0.0.1:1000 a", received[0]);
+    ASSERT_EQ("10.0.0.1:1000 b", received[1]);
+    ASSERT_FALSE(network.NextDeliveryMs(deliver_ms));
+    ASSERT_EQ(2u, network.stats().delivered);
+}
+
+TEST_F(TestLoopbackNetwork, Nat) {
+    uint64_t now_ms = 0;
+    LoopbackNetwork network(1, [&now_ms]() { return now_ms; });
+    uint32_t received = 0;
+    auto receiver = [&received](const std::string&, uint16_t, const std::string&) {
+        ++received;
+    };
+    network.Register("10.0.0.1", 1000, kNatTypePublic, receiver);
+    network.Register("192.168.0.1", 1000, kNatTypeConeNormal, receiver);
+
+    // unsolicited packet to a nat endpoint is dropped
+    network.Send("10.0.0.1", 1000, "192.168.0.1", 1000, "a");
+    ASSERT_EQ(0u, network.Deliver());
+    ASSERT_EQ(1u, network.stats().dropped_nat);
+
+    // after the nat endpoint sent to the peer, replies pass
+    network.Send("192.168.0.1", 1000, "10.0.0.1", 1000, "b");
+    network.Send("10.0.0.1", 1000, "192.168.0.1", 1000, "c");
+    ASSERT_EQ(2u, network.Deliver());
+    ASSERT_EQ(2u, received);
+
+    network.Send("10.0.0.1", 1000, "10.0.0.9", 1000, "d");
+    ASSERT_EQ(0u, network.Deliver());
+    ASSERT_EQ(1u, network.stats().dropped_unreachable);
+}
+
+TEST_F(TestLoopbackNetwork, LossAndPartition) {
+    uint64_t now_ms = 0;
+    LoopbackNetwork network(7, [&now_ms]() { return now_ms; });
+    uint32_t received = 0;
+    auto receiver = [&received](const std::string&, uint16_t, const std::string&) {
+        ++received;
+    };
+    network.Register("10.0.0.1", 1000, kNatTypePublic, receiver);
+    network.Register("10.0.0.2", 1000, kNatTypePublic, receiver);
+    network.Register("10.0.0.3", 1000, kNatTypePublic, receiver);
+    LoopbackLink lossy;
+    lossy.loss = 0.5;
+    network.SetLink("10.0.0.2", "10.0.0.1", lossy);
+    for (int i = 0; i < 1000; ++i) {
+        network.Send("10.0.0.1", 1000, "10.0.0.2", 1000, "a");
+    }
+    network.Deliver();
+    ASSERT_GT(received, 400u);
+    ASSERT_LT(received, 600u);
+    ASSERT_EQ(1000u, received + network.stats().dropped_loss);
+
+    received = 0;
+    network.Partition({ "10.0.0.1" }, { "10.0.0.3" });
+    network.Send("10.0.0.1", 1000, "10.0.0.3", 1000, "a");
+    network.Send("10.0.0.3", 1000, "10.0.0.1", 1000, "a");
+    ASSERT_EQ(0u, network.Deliver());
+    network.Heal();
+    network.Send("10.0.0.1", 1000, "10.0.0.3", 1000, "a");
+    ASSERT_EQ(1u, network.Deliver());
+}
+
+TEST_F(TestLoopbackNetwork, TransportSendReceive) {
+    uint64_t now_ms = 0;
+    auto network = std::make_shared<LoopbackNetwork>(1, [&now_ms]() { return now_ms; });
+    LoopbackTransport sender(network, "10.0.0.1", 1000, kNatTypePublic);
+    LoopbackTransport receiver(network, "10.0.0.2", 2000, kNatTypePublic);
+    std::vector<transport::protobuf::RoutingMessage> received;
+    std::string from;
+    receiver.set_message_handler([&received, &from](
+            transport::protobuf::RoutingMessage& message,
+            base::xpacket_t& packet) {
+        received.push_back(message);
+        from = packet.get_from_ip_addr() + ":" + std::to_string(packet.get_from_ip_port());
+    });
+
+    transport::protobuf::RoutingMessage message;
+    message.set_hop_num(0);
+    message.set_src_node_id("node1");
+    message.set_des_node_id("node2");
+    message.set_type(kKadHandshake);
+    message.set_id(7);
+    std::string data;
+    ASSERT_TRUE(message.SerializeToString(&data));
+
+    uint8_t local_buf[kUdpPacketBufferSize];
+    base::xpacket_t packet(base::xcontext_t::instance(), local_buf, sizeof(local_buf), 0, 0, false);
+    _xip2_header header;
+    memset(&header, 0, sizeof(header));
+    packet.get_body().push_back((uint8_t*)&header, enum_xip2_header_len);
+    packet.get_body().push_back((uint8_t*)data.data(), data.size());  // NOLINT
+    packet.set_to_ip_addr("10.0.0.2");
+    packet.set_to_ip_port(2000);
+
+    // not started, no endpoint to send from
+    ASSERT_EQ(kKadFailed, sender.SendData(packet));
+    ASSERT_EQ(kKadSuccess, sender.Start("", 0, nullptr));
+    ASSERT_EQ(kKadSuccess, receiver.Start("", 0, nullptr));
+    LoopbackTransport duplicate(network, "10.0.0.2", 2000, kNatTypePublic);
+    ASSERT_EQ(kKadFailed, duplicate.Start("", 0, nullptr));
+
+    ASSERT_EQ(kKadSuccess, sender.SendData(packet));
+    ASSERT_EQ(1u, network->Deliver());
+    ASSERT_EQ(1u, received.size());
+    ASSERT_EQ(kKadHandshake, received[0].type());
+    ASSERT_EQ(7u, received[0].id());
+    ASSERT_EQ("node1", received[0].src_node_id());
+    ASSERT_EQ("10.0.0.1:1000", from);
+
+    // a stopped transport leaves the network
+    receiver.Stop();
+    ASSERT_EQ(kKadSuccess, sender.SendData(packet));
+    ASSERT_EQ(0u, network->Deliver());
+    ASSERT_EQ(1u, received.size());
+    ASSERT_EQ(1u, network->stats().dropped_unreachable);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,101 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/memory_stats.h"
+#include "xkad/routing_table/replacement_cache.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestMemoryStats : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestMemoryStats, StringBytes) {
+    ASSERT_EQ(0u, StringHeapBytes(std::string("127.0.0.1")));
+    std::string node_id(36, 'a');
+    ASSERT_GE(StringHeapBytes(node_id), 37u);
+
+    NodeInfo node(node_id);
+    node.public_ip = "127.0.0.1";
+    ASSERT_EQ(sizeof(NodeInfo) + kSharedPtrBlockBytes + StringHeapBytes(node.node_id),
+            NodeInfoBytes(node));
+}
+
+TEST_F(TestMemoryStats, ReplacementCache) {
+    ReplacementCache cache;
+    const uint64_t empty_bytes = cache.bytes();
+    ASSERT_EQ(sizeof(ReplacementCache), empty_bytes);
+    NodeInfoPtr node = NewNodeInfo(std::string(36, 'b'));
+    node->bucket_index = 100;
+    cache.Add(node);
+    ASSERT_GT(cache.bytes(), empty_bytes + NodeInfoBytes(*node));
+}
+
+TEST_F(TestMemoryStats, Reporters) {
+    MemoryStats stats;
+    uint64_t entries = 10;
+    uint32_t id = stats.Register([&entries](std::vector<MemoryUsage>& usages) {
+        MemoryUsage usage;
+        usage.name = "small";
+        usage.entries = entries;
+        usage.bytes = entries * 100;
+        usages.push_back(usage);
+    });
+    stats.Register([](std::vector<MemoryUsage>& usages) {
+        MemoryUsage usage;
+        usage.name = "large";
+        usage.entries = 1;
+        usage.bytes = 1000000;
+        usages.push_back(usage);
+    });
+
+    std::vector<MemoryUsage> usages;
+    stats.Get(usages);
+    ASSERT_EQ(2u, usages.size());
+    ASSERT_EQ("large", usages[0].name);  // the largest first
+    ASSERT_EQ(1000u, usages[1].bytes);
+    ASSERT_EQ(1000u, usages[1].peak_bytes);
+
+    // the high-water marks stay after the usage drops
+    entries = 50;
+    stats.Get(usages);
+    entries = 5;
+    stats.Get(usages);
+    ASSERT_EQ(5u, usages[1].entries);
+    ASSERT_EQ(50u, usages[1].peak_entries);
+    ASSERT_EQ(5000u, usages[1].peak_bytes);
+
+    auto dump = stats.Dump();
+    ASSERT_NE(std::string::npos, dump.find("small"));
+    ASSERT_NE(std::string::npos, dump.find("total"));
+    ASSERT_NE(std::string::npos, dump.find("1000500"));
+
+    stats.ResetPeaks();
+    stats.Get(usages);
+    ASSERT_EQ(5u, usages[1].peak_entries);
+
+    stats.Unregister(id);
+    stats.Get(usages);
+    ASSERT_EQ(1u, usages.size());
+    ASSERT_EQ("large", usages[0].name);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,119 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/lock_free_queue.h"
+#include "xkad/routing_table/node_event.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestNodeEvent : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestNodeEvent, LockFreeQueue) {
+    LockFreeQueue<int> queue(3);
+    ASSERT_EQ(4u, queue.capacity());
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.Push(i));
+    }
+    ASSERT_FALSE(queue.Push(4));
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.Pop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(queue.Pop(value));
+}
+
+TEST_F(TestNodeEvent, LockFreeQueueMultiProducer) {
+    LockFreeQueue<int> queue(4096);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([&queue, t] {
+            for (int i = 0; i < 1000; ++i) {
+                queue.Push(t * 1000 + i);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> last(4, -1);
+    int value = 0;
+    int count = 0;
+    while (queue.Pop(value)) {
+        // order is kept per producer
+        ASSERT_GT(value % 1000, last[value / 1000]);
+        last[value / 1000] = value % 1000;
+        ++count;
+    }
+    ASSERT_EQ(4000, count);
+}
+
+TEST_F(TestNodeEvent, Dispatch) {
+    NodeEventDispatcher dispatcher(8);
+    // nothing is queued without subscribers
+    dispatcher.Publish(kNodeEventAdded, std::make_shared<NodeInfo>("a"), 1);
+    ASSERT_EQ(0u, dispatcher.Dispatch());
+
+    std::vector<NodeEvent> events;
+    uint32_t id = dispatcher.Subscribe([&events](const NodeEvent& event) {
+        events.push_back(event);
+    });
+    dispatcher.Publish(kNodeEventAdded, std::make_shared<NodeInfo>("b"), 2);
+    dispatcher.Publish(kNodeEventDropped, std::make_shared<NodeInfo>("a"), 3);
+    ASSERT_EQ(2u, dispatcher.Dispatch());
+    ASSERT_EQ(2u, events.size());
+    ASSERT_EQ(kNodeEventAdded, events[0].type);
+    ASSERT_EQ("b", events[0].node->node_id);
+    ASSERT_EQ(kNodeEventDropped, events[1].type);
+    ASSERT_EQ(3u, events[1].generation);
+
+    dispatcher.Unsubscribe(id);
+    dispatcher.Publish(kNodeEventAdded, std::make_shared<NodeInfo>("c"), 4);
+    ASSERT_EQ(0u, dispatcher.Dispatch());
+    ASSERT_EQ(2u, events.size());
+}
+
+TEST_F(TestNodeEvent, OverflowResync) {
+    NodeEventDispatcher dispatcher(4);
+    std::vector<NodeEvent> events;
+    dispatcher.Subscribe([&events](const NodeEvent& event) {
+        events.push_back(event);
+    });
+    for (int i = 0; i < 6; ++i) {
+        dispatcher.Publish(kNodeEventAdded, std::make_shared<NodeInfo>(std::to_string(i)), i + 1);
+    }
+    ASSERT_EQ(5u, dispatcher.Dispatch());
+    ASSERT_EQ(5u, events.size());
+    ASSERT_EQ(kNodeEventResync, events[4].type);
+    ASSERT_EQ(nullptr, events[4].node);
+    ASSERT_EQ(6u, events[4].generation);
+
+    // overflow is reported once
+    ASSERT_EQ(0u, dispatcher.Dispatch());
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,84 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/object_pool.h"
+#include "xkad/routing_table/node_info.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestObjectPool : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestObjectPool, Reuse) {
+    PoolAllocator<uint64_t> allocator;
+    size_t free_size = PoolAllocator<uint64_t>::free_size();
+    uint64_t* first = allocator.allocate(1);
+    allocator.deallocate(first, 1);
+    ASSERT_EQ(free_size + 1, PoolAllocator<uint64_t>::free_size());
+    uint64_t* second = allocator.allocate(1);
+    ASSERT_EQ(first, second);
+    allocator.deallocate(second, 1);
+
+    // arrays are not pooled
+    uint64_t* array = allocator.allocate(4);
+    allocator.deallocate(array, 4);
+    ASSERT_EQ(free_size + 1, PoolAllocator<uint64_t>::free_size());
+}
+
+TEST_F(TestObjectPool, MaxFree) {
+    PoolAllocator<uint32_t> allocator;
+    std::vector<uint32_t*> blocks;
+    for (uint32_t i = 0; i < kObjectPoolMaxFree + 10; ++i) {
+        blocks.push_back(allocator.allocate(1));
+    }
+    for (auto block : blocks) {
+        allocator.deallocate(block, 1);
+    }
+    ASSERT_EQ(kObjectPoolMaxFree, PoolAllocator<uint32_t>::free_size());
+}
+
+TEST_F(TestObjectPool, NewNodeInfo) {
+    NodeInfo* last = nullptr;
+    for (int i = 0; i < 3; ++i) {
+        NodeInfoPtr node = NewNodeInfo("node" + std::to_string(i));
+        ASSERT_EQ("node" + std::to_string(i), node->node_id);
+        ASSERT_EQ(kInvalidBucketIndex, node->bucket_index);
+        ASSERT_EQ(nullptr, node->udp_property);  // the PeerStore one is set on admission
+        if (last != nullptr) {
+            ASSERT_EQ(last, node.get());
+        }
+        last = node.get();
+    }
+
+    // freed on another thread
+    NodeInfoPtr node = NewNodeInfo("node");
+    std::thread thread([&node] {
+        node = nullptr;
+    });
+    thread.join();
+    ASSERT_EQ(nullptr, node);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,112 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/peer_rtt.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestPeerRtt : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static NodeInfoPtr CreateNode(uint8_t first_byte, uint8_t last_byte, uint32_t rtt_ms) {
+    std::string node_id(kNodeIdSize, '\x00');
+    node_id[0] = (char)first_byte;
+    node_id[kNodeIdSize - 1] = (char)last_byte;
+    auto node = std::make_shared<NodeInfo>(node_id);
+    node->rtt_ms = rtt_ms;
+    return node;
+}
+
+TEST_F(TestPeerRtt, Sampler) {
+    RpcStats rpc_stats;
+    RttSampler sampler(&rpc_stats);
+    auto now = std::chrono::steady_clock::now();
+    sampler.Sent(1, kKadFindNodesRequest, now);
+    sampler.Sent(2, kKadFindNodesRequest, now);
+    ASSERT_EQ(2u, sampler.size());
+
+    uint32_t rtt_ms = 0;
+    ASSERT_TRUE(sampler.Received(1, now + std::chrono::milliseconds(35), rtt_ms));
+    ASSERT_EQ(35u, rtt_ms);
+    // answered once only
+    ASSERT_FALSE(sampler.Received(1, now + std::chrono::milliseconds(40), rtt_ms));
+    ASSERT_FALSE(sampler.Received(3, now, rtt_ms));
+
+    // too late to be a sample
+    ASSERT_FALSE(sampler.Received(
+            2, now + std::chrono::milliseconds(kRttPendingTimeoutMs + 1), rtt_ms));
+    ASSERT_EQ(0u, sampler.size());
+
+    // unanswered requests time out on a later send
+    sampler.Sent(3, kKadHandshake, now);
+    sampler.Sent(4, kKadHandshake, now + std::chrono::milliseconds(kRttPendingTimeoutMs * 2 + 1));
+    ASSERT_EQ(1u, sampler.size());
+
+    RpcStatsInfo info;
+    ASSERT_TRUE(rpc_stats.Get(kKadFindNodesRequest, info));
+    ASSERT_EQ(2u, info.requests);
+    ASSERT_EQ(1u, info.responses);
+    ASSERT_EQ(1u, info.late_responses);
+    ASSERT_TRUE(rpc_stats.Get(kKadHandshake, info));
+    ASSERT_EQ(2u, info.requests);
+    ASSERT_EQ(1u, info.timeouts);
+}
+
+TEST_F(TestPeerRtt, UpdateRtt) {
+    NodeInfo node;
+    ASSERT_EQ(0u, node.rtt_ms.load());
+    node.UpdateRtt(200);
+    ASSERT_EQ(200u, node.rtt_ms.load());
+    node.UpdateRtt(40);
+    ASSERT_EQ(180u, node.rtt_ms.load());
+    node.UpdateRtt(0);
+    ASSERT_GT(node.rtt_ms.load(), 0u);
+}
+
+TEST_F(TestPeerRtt, SelectLowLatencyNode) {
+    const std::string target_id(kNodeIdSize, '\x00');
+    ASSERT_EQ(nullptr, SelectLowLatencyNode(target_id, {}));
+
+    // same bucket of target: first byte 0x01, sorted by distance
+    auto near_slow = CreateNode(0x01, 0x01, 200);
+    auto near_fast = CreateNode(0x01, 0x02, 5);
+    auto near_unknown = CreateNode(0x01, 0x03, 0);
+    auto far_fastest = CreateNode(0x02, 0x01, 1);
+    std::vector<NodeInfoPtr> nodes = { near_slow, near_fast, near_unknown, far_fastest };
+    ASSERT_EQ(near_fast, SelectLowLatencyNode(target_id, nodes));
+
+    // no sample, keep the closest
+    near_slow->rtt_ms = 0;
+    near_fast->rtt_ms = 0;
+    ASSERT_EQ(near_slow, SelectLowLatencyNode(target_id, nodes));
+
+    // a closer bucket always wins
+    auto exact = CreateNode(0x00, 0x01, 300);
+    nodes.insert(nodes.begin(), exact);
+    near_fast->rtt_ms = 5;
+    ASSERT_EQ(exact, SelectLowLatencyNode(target_id, nodes));
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
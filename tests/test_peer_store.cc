@@ -0,0 +1,60 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/peer_store.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestPeerStore : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestPeerStore, SharePeer) {
+    PeerStore store;
+    auto property = store.GetUdpProperty("10.0.0.1", 9000);
+    ASSERT_TRUE(property != nullptr);
+    // same endpoint in another table gets the same record
+    ASSERT_EQ(property, store.GetUdpProperty("10.0.0.1", 9000));
+    ASSERT_NE(property, store.GetUdpProperty("10.0.0.1", 9001));
+    ASSERT_EQ(1u, store.size());
+
+    auto other = store.GetUdpProperty("10.0.0.2", 9000);
+    ASSERT_EQ(2u, store.size());
+    other = nullptr;
+    ASSERT_EQ(1u, store.size());
+
+    // released with the last node, a new record afterwards
+    property = nullptr;
+    ASSERT_EQ(0u, store.size());
+    ASSERT_TRUE(store.GetUdpProperty("10.0.0.1", 9000) != nullptr);
+}
+
+TEST_F(TestPeerStore, Prune) {
+    PeerStore store;
+    auto property = store.GetUdpProperty("10.0.0.1", 9000);
+    for (uint32_t i = 0; i < kPeerStorePruneInterval * 2; ++i) {
+        store.GetUdpProperty("10.0.1.1", i);
+    }
+    ASSERT_EQ(1u, store.size());
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,77 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/replacement_cache.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestReplacementCache : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static NodeInfoPtr CreateNode(const std::string& id, int bucket_index) {
+    auto node = std::make_shared<NodeInfo>(id);
+    node->bucket_index = bucket_index;
+    return node;
+}
+
+TEST_F(TestReplacementCache, LruPerBucket) {
+    ReplacementCache cache(3, 1000);
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        cache.Add(CreateNode("node" + std::to_string(i), 10), now);
+    }
+    cache.Add(CreateNode("other", 11), now);
+    ASSERT_EQ(3u, cache.bucket_size(10));
+    ASSERT_EQ(4u, cache.size());
+
+    // seen again, becomes the most recent
+    cache.Add(CreateNode("node2", 10), now);
+    ASSERT_EQ(3u, cache.bucket_size(10));
+
+    ASSERT_EQ("node2", cache.Pop(10, now)->node_id);
+    ASSERT_EQ("node3", cache.Pop(10, now)->node_id);
+    cache.Remove("node1", 10);
+    ASSERT_EQ(nullptr, cache.Pop(10, now));  // node0 was evicted
+    ASSERT_EQ(1u, cache.size());
+    ASSERT_EQ("other", cache.Pop(11, now)->node_id);
+    ASSERT_EQ(0u, cache.size());
+}
+
+TEST_F(TestReplacementCache, StaleCandidate) {
+    ReplacementCache cache(4, 1000);
+    auto now = std::chrono::steady_clock::now();
+    cache.Add(CreateNode("old0", 5), now);
+    cache.Add(CreateNode("old1", 5), now);
+    cache.Add(CreateNode("new", 5), now + std::chrono::milliseconds(1500));
+    now += std::chrono::milliseconds(2000);
+    ASSERT_EQ("new", cache.Pop(5, now)->node_id);
+    ASSERT_EQ(nullptr, cache.Pop(5, now));
+    ASSERT_EQ(0u, cache.size());
+
+    // invalid bucket is ignored
+    cache.Add(CreateNode("invalid", kInvalidBucketIndex), now);
+    ASSERT_EQ(0u, cache.size());
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,78 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/route_cache.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestRouteCache : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+static std::vector<NodeInfoPtr> CreateNodes(int count) {
+    std::vector<NodeInfoPtr> nodes;
+    for (int i = 0; i < count; ++i) {
+        nodes.push_back(std::make_shared<NodeInfo>("node" + std::to_string(i)));
+    }
+    return nodes;
+}
+
+TEST_F(TestRouteCache, Generation) {
+    RouteCache cache;
+    std::vector<NodeInfoPtr> nodes;
+    ASSERT_FALSE(cache.Get("des", 1, nodes));
+
+    cache.Put("des", 1, CreateNodes(kRouteCacheCandidates + 4));
+    ASSERT_TRUE(cache.Get("des", 1, nodes));
+    ASSERT_EQ(kRouteCacheCandidates, nodes.size());
+    ASSERT_EQ("node0", nodes[0]->node_id);
+
+    // table changed, entry is dropped
+    ASSERT_FALSE(cache.Get("des", 2, nodes));
+    ASSERT_EQ(0u, cache.size());
+}
+
+TEST_F(TestRouteCache, Lru) {
+    RouteCache cache(2);
+    std::vector<NodeInfoPtr> nodes;
+    cache.Put("des1", 1, CreateNodes(1));
+    cache.Put("des2", 1, CreateNodes(2));
+    ASSERT_TRUE(cache.Get("des1", 1, nodes));  // des2 is the least recent now
+    cache.Put("des3", 1, CreateNodes(3));
+    ASSERT_EQ(2u, cache.size());
+    ASSERT_FALSE(cache.Get("des2", 1, nodes));
+    ASSERT_TRUE(cache.Get("des1", 1, nodes));
+    ASSERT_TRUE(cache.Get("des3", 1, nodes));
+    ASSERT_EQ(3u, nodes.size());
+
+    // put again replaces the entry
+    cache.Put("des3", 2, CreateNodes(1));
+    ASSERT_TRUE(cache.Get("des3", 2, nodes));
+    ASSERT_EQ(1u, nodes.size());
+    ASSERT_EQ(2u, cache.size());
+
+    cache.Clear();
+    ASSERT_EQ(0u, cache.size());
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,118 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/seq_ring.h"
+#include "xkad/routing_table/routing_event.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestRoutingEvent : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+struct OddRecord {
+    uint32_t a;
+    uint8_t b;  // not a multiple of 8 bytes
+};
+
+TEST_F(TestRoutingEvent, SeqRing) {
+    SeqRing<OddRecord> ring(5);  // 8 slots
+    ASSERT_EQ(8u, ring.capacity());
+    std::vector<OddRecord> records;
+    ring.Get(records);
+    ASSERT_TRUE(records.empty());
+
+    for (uint32_t i = 0; i < 11; ++i) {
+        OddRecord record;
+        record.a = i;
+        record.b = static_cast<uint8_t>(i + 1);
+        ring.Push(record);
+    }
+    ASSERT_EQ(11u, ring.pushed());
+    ring.Get(records);
+    ASSERT_EQ(8u, records.size());
+    ASSERT_EQ(3u, records.front().a);
+    ASSERT_EQ(10u, records.back().a);
+    ASSERT_EQ(11u, records.back().b);
+}
+
+TEST_F(TestRoutingEvent, Record) {
+    RoutingEventRecorder recorder(16);
+    recorder.Record(kRoutingEventAdded, kRoutingReasonNone, 0xabcdull, 9000, 250, 1, 1);
+    recorder.Record(kRoutingEventRejected, kRoutingReasonBucketFull, 0xbcdeull, 9001, 250, 1, 1);
+    recorder.Record(kRoutingEventDropped, kRoutingReasonHeartbeat, 0xabcdull, 9000, 250, 0, 2);
+    recorder.Record(kRoutingEventUnjoined, kRoutingReasonEmpty, 0, 0, -1, 0, 2);
+
+    std::vector<RoutingEvent> events;
+    recorder.Get(events);
+    ASSERT_EQ(4u, events.size());
+    ASSERT_EQ(kRoutingEventAdded, events[0].type);
+    ASSERT_EQ(0xabcdull, events[0].peer_hash);
+    ASSERT_EQ(9000u, events[0].peer_port);
+    ASSERT_EQ(250, events[0].bucket);
+    ASSERT_EQ(kRoutingReasonHeartbeat, events[2].reason);
+    ASSERT_EQ(0u, events[2].table_size);
+    ASSERT_EQ(2u, events[2].generation);
+    ASSERT_EQ(-1, events[3].bucket);
+    ASSERT_LE(events[0].time_us, events[3].time_us);
+
+    auto dump = recorder.Dump();
+    ASSERT_NE(std::string::npos, dump.find("4 of 4 recorded"));
+    ASSERT_NE(std::string::npos, dump.find("bucket_full"));
+    ASSERT_NE(std::string::npos, dump.find("peer(000000000000abcd:9000)"));
+    ASSERT_NE(std::string::npos, dump.find("unjoin"));
+
+    // anomaly dumps are rate limited
+    std::string anomaly;
+    ASSERT_TRUE(recorder.DumpAnomaly(anomaly));
+    ASSERT_EQ(dump, anomaly);
+    ASSERT_FALSE(recorder.DumpAnomaly(anomaly));
+}
+
+TEST_F(TestRoutingEvent, Threads) {
+    RoutingEventRecorder recorder(256);
+    const int kThreads = 4;
+    const int kEvents = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.push_back(std::thread([&recorder, t]() {
+            for (int i = 0; i < kEvents; ++i) {
+                recorder.Record(kRoutingEventAdded, kRoutingReasonNone, t, t, t, i, i);
+            }
+        }));
+    }
+    std::vector<RoutingEvent> events;
+    recorder.Get(events);  // while writing, only whole events
+    for (auto& event : events) {
+        ASSERT_EQ(event.peer_hash, event.peer_port);
+        ASSERT_EQ(event.generation, event.table_size);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ((uint64_t)kThreads * kEvents, recorder.recorded());
+    recorder.Get(events);
+    ASSERT_LE(events.size(), 256u);
+    ASSERT_GT(events.size(), 240u);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -77,7 +77,7 @@ public:
         ASSERT_EQ(res, kKadSuccess);
         ASSERT_TRUE(routing_table_ptr_->IsJoined());
         {
-            std::unique_lock<std::mutex> lock(routing_table_ptr_->nodes_mutex_);
+            std::unique_lock<KadMutex> lock(routing_table_ptr_->nodes_mutex_);
             ASSERT_FALSE(routing_table_ptr_->nodes_.empty());
         }
     }
@@ -166,7 +166,7 @@ TEST_F(TestRoutingTable, ClosestToTarget) {
 
     NodeInfoPtr closest_node;
     {
-        std::unique_lock<std::mutex> lock(routing_table_ptr_->nodes_mutex_);
+        std::unique_lock<KadMutex> lock(routing_table_ptr_->nodes_mutex_);
         if (routing_table_ptr_->nodes_.empty()) {
             ASSERT_TRUE(false);
         }
@@ -181,7 +181,7 @@ TEST_F(TestRoutingTable, ClosestToTarget) {
 TEST_F(TestRoutingTable, SendHeartbeat) {
     NodeInfoPtr closest_node;
     {
-        std::unique_lock<std::mutex> lock(routing_table_ptr_->nodes_mutex_);
+        std::unique_lock<KadMutex> lock(routing_table_ptr_->nodes_mutex_);
         if (routing_table_ptr_->nodes_.empty()) {
             ASSERT_TRUE(false);
         }
@@ -191,10 +191,19 @@ TEST_F(TestRoutingTable, SendHeartbeat) {
     routing_table_ptr_->SendHeartbeat(closest_node,kRoot);
 }
 
+TEST_F(TestRoutingTable, GetMemoryUsage) {
+    std::vector<MemoryUsage> usages;
+    routing_table_ptr_->GetMemoryUsage(usages);
+    ASSERT_FALSE(usages.empty());
+    ASSERT_EQ(0u, usages[0].name.find("routing_table("));
+    ASSERT_EQ(routing_table_ptr_->nodes_size(), usages[0].entries);
+    ASSERT_GT(usages[0].bytes, usages[0].entries * sizeof(NodeInfo));
+}
+
 TEST_F(TestRoutingTable, DropNode) {
     NodeInfoPtr drop_node;
     {
-        std::unique_lock<std::mutex> lock(routing_table_ptr_->nodes_mutex_);
+        std::unique_lock<KadMutex> lock(routing_table_ptr_->nodes_mutex_);
         if (routing_table_ptr_->nodes_.empty()) {
             ASSERT_TRUE(false);
         }
@@ -202,20 +211,27 @@ TEST_F(TestRoutingTable, DropNode) {
     }
     int res = routing_table_ptr_->DropNode(drop_node);
     ASSERT_EQ(res, kKadSuccess);
+
+    std::vector<RoutingEvent> events;
+    routing_table_ptr_->routing_events()->Get(events);
+    ASSERT_FALSE(events.empty());
+    ASSERT_EQ(kRoutingEventDropped, events.back().type);
+    ASSERT_EQ(kRoutingReasonApi, events.back().reason);
 }
 
 TEST_F(TestRoutingTable, Rejoin) {
     routing_table_ptr_->joined_ = true;
     {
-        std::unique_lock<std::mutex> lock(routing_table_ptr_->nodes_mutex_);
+        std::unique_lock<KadMutex> lock(routing_table_ptr_->nodes_mutex_);
         routing_table_ptr_->nodes_.clear();
+        routing_table_ptr_->bucket_nodes_.clear();
         routing_table_ptr_->node_id_map_.clear();
     }
     routing_table_ptr_->Rejoin();
     SleepUs(1 * 1000 * 1000);
     ASSERT_TRUE(routing_table_ptr_->joined_);
     {
-        std::unique_lock<std::mutex> lock(routing_table_ptr_->nodes_mutex_);
+        std::unique_lock<KadMutex> lock(routing_table_ptr_->nodes_mutex_);
         ASSERT_FALSE(routing_table_ptr_->nodes_.empty());
     }
 }
@@ -69,7 +69,7 @@ TEST_F(TestRoutingTable3, SetNodeBucket_1) {
     auto rt = std::make_shared<RoutingTable>(nullptr, 0, nullptr);
     auto kad_key = std::make_shared<MockKadKey>();
     auto local_node = std::make_shared<LocalNodeInfo>();
-    local_node->kadmlia_key_ = kad_key;
+    local_node->set_kadmlia_key(kad_key);
     rt->local_node_ptr_ = local_node;
 
     // same id
@@ -105,6 +105,146 @@ TEST_F(TestRoutingTable3, SetNodeBucket_1) {
     }
 }
 
+TEST_F(TestRoutingTable3, GetClosestNodesResponse) {
+    auto rt = std::make_shared<RoutingTable>(nullptr, 0, nullptr);
+    auto kad_key = std::make_shared<MockKadKey>();
+    auto local_node = std::make_shared<LocalNodeInfo>();
+    local_node->set_kadmlia_key(kad_key);
+    rt->local_node_ptr_ = local_node;
+
+    std::string target_id;
+    for (int i = 0; i < 2 * kKadParamK; ++i) {
+        auto node = std::make_shared<NodeInfo>();
+        node->node_id = local_node->id();
+        node->node_id[kNodeIdSize - 1] = (char)(i + 1);
+        node->nat_type = kNatTypePublic;
+        node->public_ip = "192.168.0.1";
+        node->public_port = 10000 + i;
+        node->xip = std::string(8, 'x');
+        node->xid = std::string(8, 'i');
+        rt->nodes_.push_back(node);
+        if (i == 0) {
+            target_id = node->node_id;
+        }
+    }
+
+    // the target itself is never returned, at most k nodes
+    {
+        protobuf::FindClosestNodesResponse find_nodes_res;
+        rt->GetClosestNodesResponse(target_id, kJoinResponseClosestNodesMaxBytes, find_nodes_res);
+        ASSERT_EQ(kKadParamK, find_nodes_res.nodes_size());
+        ASSERT_LE(find_nodes_res.ByteSizeLong(), kJoinResponseClosestNodesMaxBytes);
+        for (int i = 0; i < find_nodes_res.nodes_size(); ++i) {
+            ASSERT_NE(target_id, find_nodes_res.nodes(i).id());
+        }
+    }
+
+    // byte budget cuts the node list
+    {
+        const uint32_t max_bytes = 300;
+        protobuf::FindClosestNodesResponse find_nodes_res;
+        rt->GetClosestNodesResponse(target_id, max_bytes, find_nodes_res);
+        ASSERT_GT(find_nodes_res.nodes_size(), 0);
+        ASSERT_LT(find_nodes_res.nodes_size(), kKadParamK);
+        ASSERT_LE(find_nodes_res.ByteSizeLong(), max_bytes);
+    }
+}
+
+TEST_F(TestRoutingTable3, BucketCapacityPolicy) {
+    auto rt = std::make_shared<RoutingTable>(nullptr, 0, nullptr);
+    auto kad_key = std::make_shared<MockKadKey>();
+    auto local_node = std::make_shared<LocalNodeInfo>();
+    local_node->set_kadmlia_key(kad_key);
+    rt->local_node_ptr_ = local_node;
+
+    BucketCapacityPolicy policy;
+    policy.near_bucket_count = 5;
+    policy.near_k = 12;
+    policy.far_k = 4;
+    rt->set_bucket_capacity_policy(policy);
+
+    auto try_add = [&rt, &local_node](uint8_t last_byte) {
+        auto node = std::make_shared<NodeInfo>();
+        node->node_id = local_node->id();
+        node->node_id[kNodeIdSize - 1] = (char)last_byte;
+        EXPECT_EQ(kKadSuccess, rt->SetNodeBucket(node));
+        if (!rt->NewNodeReplaceOldNode(node)) {
+            return false;
+        }
+        rt->InsertNode(node);
+        return true;
+    };
+
+    // 0x10 - 0x1f differ from self in bucket 5, a near bucket
+    for (int i = 0; i < 12; ++i) {
+        ASSERT_TRUE(try_add(0x10 + i));
+    }
+    ASSERT_FALSE(try_add(0x10 + 12));
+
+    // bucket 6 is a far bucket, a nearer bucket does not change that
+    ASSERT_TRUE(try_add(0x01));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(try_add(0x20 + i));
+    }
+    ASSERT_FALSE(try_add(0x20 + 4));
+    ASSERT_FALSE(try_add(0x10 + 12));
+
+    // bucket 5 becomes a far bucket, it is trimmed to far_k
+    policy.near_bucket_count = 4;
+    rt->set_bucket_capacity_policy(policy);
+    uint32_t bucket5_size = 0;
+    for (auto& node : rt->nodes_) {
+        if (node->bucket_index == 5) {
+            ++bucket5_size;
+        }
+    }
+    ASSERT_EQ(4u, bucket5_size);
+    ASSERT_EQ(9u, rt->nodes_.size());
+
+    // invalid policy is ignored
+    policy.far_k = 0;
+    rt->set_bucket_capacity_policy(policy);
+    ASSERT_EQ(4u, rt->bucket_capacity_policy().far_k);
+}
+
+TEST_F(TestRoutingTable3, AddNodes) {
+    auto rt = std::make_shared<RoutingTable>(nullptr, 0, nullptr);
+    auto kad_key = std::make_shared<MockKadKey>();
+    auto local_node = std::make_shared<LocalNodeInfo>();
+    local_node->set_kadmlia_key(kad_key);
+    rt->local_node_ptr_ = local_node;
+
+    std::vector<NodeInfoPtr> nodes;
+    for (int i = 0; i < kKadParamK + 2; ++i) {
+        auto node = std::make_shared<NodeInfo>();
+        node->node_id = local_node->id();
+        node->node_id[kNodeIdSize - 1] = (char)(0x10 + i);  // all in one bucket
+        node->nat_type = kNatTypePublic;
+        node->public_ip = "192.168.0.1";
+        node->public_port = 10000 + i;
+        node->xid = std::to_string(i);
+        nodes.push_back(node);
+    }
+    nodes.push_back(nodes[0]);  // duplicate in batch
+    auto self_node = std::make_shared<NodeInfo>(*nodes[1]);
+    self_node->node_id = local_node->id();
+    nodes.push_back(self_node);
+
+    const uint64_t generation = rt->generation();
+    ASSERT_EQ((uint32_t)kKadParamK, rt->AddNodes(nodes));
+    ASSERT_EQ(generation + 1, rt->generation());
+    ASSERT_EQ((size_t)kKadParamK, rt->nodes_.size());
+    ASSERT_EQ((size_t)kKadParamK, rt->node_id_map_.size());
+    ASSERT_EQ((size_t)kKadParamK, rt->endpoint_nodes_map_.size());
+    ASSERT_EQ((size_t)kKadParamK, rt->GetUnLockNodes()->size());
+    // bucket full, the rest waits in the replacement cache
+    ASSERT_EQ(2u, rt->replacement_cache_->size());
+
+    // nothing new
+    ASSERT_EQ(0u, rt->AddNodes(nodes));
+    ASSERT_EQ(generation + 1, rt->generation());
+}
+
 // TEST_F(TestRoutingTable3, NewNodeReplaceOldNode_1) {
 //     auto rt = std::make_shared<RoutingTable>(nullptr, 0, nullptr);
 //     auto kad_key = std::make_shared<MockKadKey>();
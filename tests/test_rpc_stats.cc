@@ -0,0 +1,107 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/routing_table/rpc_stats.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestRpcStats : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestRpcStats, Buckets) {
+    // exact below 32, then contiguous buckets with a bounded width
+    for (uint64_t value = 0; value < 32; ++value) {
+        ASSERT_EQ(value, RpcLatencyHistogram::BucketIndex(value));
+        ASSERT_EQ(value, RpcLatencyHistogram::BucketHighest(value));
+    }
+    for (uint32_t index = 32; index < kRpcHistogramBuckets; ++index) {
+        const uint64_t lowest = RpcLatencyHistogram::BucketHighest(index - 1) + 1;
+        const uint64_t highest = RpcLatencyHistogram::BucketHighest(index);
+        ASSERT_EQ(index, RpcLatencyHistogram::BucketIndex(lowest));
+        ASSERT_EQ(index, RpcLatencyHistogram::BucketIndex(highest));
+        ASSERT_LE(highest - lowest + 1, lowest / kRpcHistogramSubBuckets + 1);
+    }
+    ASSERT_EQ(0xffffffffull, RpcLatencyHistogram::BucketHighest(kRpcHistogramBuckets - 1));
+    ASSERT_EQ(kRpcHistogramBuckets - 1, RpcLatencyHistogram::BucketIndex(1ull << 40));
+}
+
+TEST_F(TestRpcStats, Percentile) {
+    RpcLatencyHistogram histogram;
+    ASSERT_EQ(0u, histogram.Percentile(50));
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value * 1000);  // 1ms .. 1s
+    }
+    ASSERT_EQ(1000u, histogram.count());
+    ASSERT_EQ(1000000u, histogram.max());
+    ASSERT_EQ(500500u, histogram.sum() / histogram.count());
+
+    // the reported value is at most one bucket (about 6%) above the true one
+    const uint64_t p50 = histogram.Percentile(50);
+    ASSERT_GE(p50, 500000u);
+    ASSERT_LE(p50, 500000u + 500000u / 16);
+    const uint64_t p99 = histogram.Percentile(99);
+    ASSERT_GE(p99, 990000u);
+    ASSERT_LE(p99, 990000u + 990000u / 16);
+    ASSERT_GE(histogram.Percentile(100), 1000000u);
+
+    histogram.Reset();
+    ASSERT_EQ(0u, histogram.count());
+    ASSERT_EQ(0u, histogram.Percentile(99));
+}
+
+TEST_F(TestRpcStats, Types) {
+    RpcStats stats;
+    stats.OnRequest(5);
+    stats.OnRequest(5);
+    stats.OnRequest(5);
+    stats.OnResponse(5, 2000);
+    stats.OnTimeout(5);
+    stats.OnLateResponse(5);
+    stats.OnCancel(5);
+    stats.OnResponse(100, 30);
+
+    RpcStatsInfo info;
+    ASSERT_TRUE(stats.Get(5, info));
+    ASSERT_EQ(3u, info.requests);
+    ASSERT_EQ(1u, info.responses);
+    ASSERT_EQ(1u, info.timeouts);
+    ASSERT_EQ(1u, info.late_responses);
+    ASSERT_EQ(1u, info.cancelled);
+    ASSERT_EQ(2000u, info.mean_us);
+    ASSERT_EQ(2000u, info.max_us);
+    ASSERT_FALSE(stats.Get(6, info));
+
+    std::vector<RpcStatsInfo> infos;
+    stats.Get(infos);
+    ASSERT_EQ(2u, infos.size());
+    ASSERT_EQ(5, infos[0].type);
+    ASSERT_EQ(100, infos[1].type);
+    ASSERT_EQ(30u, infos[1].p50_us);
+    ASSERT_NE(std::string::npos, stats.Dump().find("late"));
+
+    stats.Reset();
+    ASSERT_TRUE(stats.Get(5, info));
+    ASSERT_EQ(0u, info.requests);
+    ASSERT_EQ(0u, info.responses);
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top
@@ -0,0 +1,91 @@
+// Copyright (c) 2017-2019 Telos Foundation & contributors
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "xkad/sim/sim_scheduler.h"
+#include "xkad/sim/loopback_network.h"
+
+namespace top {
+
+namespace kadmlia {
+
+namespace test {
+
+class TestSimScheduler : public testing::Test {
+public:
+    static void SetUpTestCase() {}
+    static void TearDownTestCase() {}
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+};
+
+TEST_F(TestSimScheduler, Order) {
+    SimScheduler scheduler(1);
+    std::vector<std::string> trace;
+    scheduler.Schedule(20, [&]() { trace.push_back("b" + std::to_string(scheduler.now_ms())); });
+    scheduler.Schedule(10, [&]() { trace.push_back("a" + std::to_string(scheduler.now_ms())); });
+    // same time runs in schedule order
+    scheduler.Schedule(20, [&]() { trace.push_back("c" + std::to_string(scheduler.now_ms())); });
+    uint64_t cancelled = scheduler.Schedule(15, [&]() { trace.push_back("x"); });
+    scheduler.Cancel(cancelled);
+    uint64_t periodic = scheduler.SchedulePeriodic(5, 10, [&]() { trace.push_back("p"); });
+
+    ASSERT_EQ(6u, scheduler.RunUntil(25));
+    ASSERT_EQ(25u, scheduler.now_ms());
+    std::vector<std::string> expect = { "p", "a10", "p", "b20", "c20", "p" };
+    ASSERT_EQ(expect, trace);
+
+    scheduler.Cancel(periodic);
+    ASSERT_EQ(0u, scheduler.RunFor(100));
+    ASSERT_EQ(125u, scheduler.now_ms());
+    ASSERT_FALSE(scheduler.Step());
+}
+
+TEST_F(TestSimScheduler, Network) {
+    // ping pong over a lossy jittered network: same seed, same run
+    auto run = [](uint32_t seed) {
+        SimScheduler scheduler(seed);
+        LoopbackNetwork network(seed, [&scheduler]() { return scheduler.now_ms(); });
+        LoopbackLink link;
+        link.latency_ms = 20;
+        link.jitter_ms = 30;
+        link.loss = 0.1;
+        network.set_default_link(link);
+        scheduler.AddSource(
+                [&network](uint64_t& next_ms) { return network.NextDeliveryMs(next_ms); },
+                [&network]() { network.Deliver(); });
+
+        std::vector<uint64_t> trace;
+        network.Register("10.0.0.1", 1000, kNatTypePublic,
+                [&](const std::string&, uint16_t, const std::string&) {
+            trace.push_back(scheduler.now_ms());
+        });
+        network.Register("10.0.0.2", 1000, kNatTypePublic,
+                [&](const std::string& ip, uint16_t port, const std::string& data) {
+            network.Send("10.0.0.2", 1000, ip, port, data);
+        });
+        scheduler.SchedulePeriodic(0, 100, [&network]() {
+            network.Send("10.0.0.1", 1000, "10.0.0.2", 1000, "ping");
+        });
+        scheduler.RunFor(60 * 60 * 1000);  // an hour of virtual time
+        return trace;
+    };
+
+    auto first = run(3);
+    ASSERT_GT(first.size(), 25000u);
+    ASSERT_EQ(first, run(3));
+    ASSERT_NE(first, run(4));
+}
+
+}  // namespace test
+
+}  // namespace kadmlia
+
+}  // namespace top